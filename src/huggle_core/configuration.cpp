@@ -147,6 +147,16 @@ QString Configuration::GetURLProtocolPrefix(WikiSite *s)
     return "https://";
 }
 
+QString Configuration::GetWhitelistSnapshotPath(WikiSite *site)
+{
+    return Configuration::GetConfigurationPath() + "whitelist_" + site->Name + ".dat";
+}
+
+QString Configuration::GetQueueSnapshotPath()
+{
+    return Configuration::GetConfigurationPath() + "queue.dat";
+}
+
 QString Configuration::GetConfigurationPath()
 {
     QString path = Generic::SanitizePath(hcfg->HomePath + QDir::separator() + "Configuration" + QDir::separator());
@@ -268,6 +278,20 @@ void Configuration::LoadSystemConfig(const QString& fn)
         RCB(AskUserBeforeReport);
         RCN(HistorySize);
         RCN(RingLogMaxSize);
+        RCB(CompressReviewedEdits);
+        RCN(ReviewedEditsTextAge);
+        RCN(MemoryBudget);
+        RCN(ProblematicUsersMax);
+        RCN(IPv4RangePrefix);
+        RCN(IPv6RangePrefix);
+        RCN(ReputationStoreSize);
+        RCN(WhitelistSnapshotAge);
+        RCN(WhitelistSyncInterval);
+        RCB(FilterProfiling);
+        RCN(EditAggregationWindow);
+        RCN(QueueSnapshotInterval);
+        RCN(QueueSnapshotMaxAge);
+        RCN(PrefetchCount);
         RC(GlobalConfigYAML);
         RCB(DynamicColsInList);
         RCB(UnsafeExts);
@@ -389,6 +413,20 @@ void Configuration::SaveSystemConfig()
     INSERT_CONFIG_B(QueueNewEditsUp);
     INSERT_CONFIG_B(BotPassword);
     INSERT_CONFIG_N(RingLogMaxSize);
+    INSERT_CONFIG_B(CompressReviewedEdits);
+    INSERT_CONFIG_N(ReviewedEditsTextAge);
+    INSERT_CONFIG_N(MemoryBudget);
+    INSERT_CONFIG_N(ProblematicUsersMax);
+    INSERT_CONFIG_N(IPv4RangePrefix);
+    INSERT_CONFIG_N(IPv6RangePrefix);
+    INSERT_CONFIG_N(ReputationStoreSize);
+    INSERT_CONFIG_N(WhitelistSnapshotAge);
+    INSERT_CONFIG_N(WhitelistSyncInterval);
+    INSERT_CONFIG_B(FilterProfiling);
+    INSERT_CONFIG_N(EditAggregationWindow);
+    INSERT_CONFIG_N(QueueSnapshotInterval);
+    INSERT_CONFIG_N(QueueSnapshotMaxAge);
+    INSERT_CONFIG_N(PrefetchCount);
     INSERT_CONFIG_B(TrimOldWarnings);
     INSERT_CONFIG_B(EnableUpdates);
     INSERT_CONFIG_B(NotifyBeta);
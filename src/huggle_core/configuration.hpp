@@ -223,6 +223,10 @@ namespace Huggle
             static QString GetURLProtocolPrefix(WikiSite *s = nullptr);
             //! Returns full configuration path suffixed with slash
             static QString GetConfigurationPath();
+            //! Path to the local snapshot of whitelist of a site
+            static QString GetWhitelistSnapshotPath(WikiSite *site);
+            //! Path to the snapshot of edit queue
+            static QString GetQueueSnapshotPath();
             static QString ReplaceSpecialUserPage(QString PageName);
 
             //! Save the local configuration to file
@@ -292,6 +296,22 @@ namespace Huggle
             int             SystemConfig_ProviderCache = 200;
             //! Maximum size of ringlog
             int             SystemConfig_RingLogMaxSize = 2000;
+            //! If true the diff and page text of edits that were already displayed is kept compressed in memory
+            bool            SystemConfig_CompressReviewedEdits = true;
+            //! Number of minutes after which the compressed text of reviewed edits is dropped, it's
+            //! retrieved again from the wiki when needed, 0 means it's never dropped
+            int             SystemConfig_ReviewedEditsTextAge = 30;
+            //! Approximate amount of memory in MB that caches (feed, edits, queue, history, logs, HAN)
+            //! may use together, when exceeded they are evicted, 0 means there is no limit
+            int             SystemConfig_MemoryBudget = 512;
+            //! Maximum number of users kept in list of problematic users, 0 means there is no limit
+            int             SystemConfig_ProblematicUsersMax = 20000;
+            //! Length of prefix of IPv4 range that anonymous users are grouped by
+            int             SystemConfig_IPv4RangePrefix = 24;
+            //! Length of prefix of IPv6 range that anonymous users are grouped by
+            int             SystemConfig_IPv6RangePrefix = 64;
+            //! Maximal number of users in reputation store that is kept in between sessions, 0 disables it
+            int             SystemConfig_ReputationStoreSize = 200000;
             //! Path where huggle contains its data, known as $huggle_home in manual
             QString         HomePath;
             //! If true Huggle will collect debug info from internal and external scoring feeds
@@ -324,6 +344,22 @@ namespace Huggle
             int             SystemConfig_WriteTimeout = 200;
             //! Whitelist is not useable
             bool            SystemConfig_WhitelistDisabled = false;
+            //! Number of hours for which the local snapshot of whitelist is used instead of downloading it, 0 disables the snapshot
+            int             SystemConfig_WhitelistSnapshotAge = 24;
+            //! Number of minutes after which users that were whitelisted during session are sent to server, 0 sends them only on exit
+            int             SystemConfig_WhitelistSyncInterval = 10;
+            //! Count evaluations, rejections and time spent in every criterion of queue filters
+            bool            SystemConfig_FilterProfiling = false;
+            //! Number of seconds for which edits are held before post processing so that following edits of same user to same page can be merged into them.
+            //! It's 0 by default, which effectively turns the feature off: edits are not delayed and only edits delivered by provider at once are merged.
+            //! With non-zero window the held edits also stay in aggregator for as long as the queue is paused or full, instead of being post processed
+            int             SystemConfig_EditAggregationWindow = 0;
+            //! Number of minutes after which the queue is written to local snapshot, so that it can be restored after restart, 0 disables it
+            int             SystemConfig_QueueSnapshotInterval = 2;
+            //! Snapshots of queue that are older than this number of minutes are not restored
+            int             SystemConfig_QueueSnapshotMaxAge = 720;
+            //! Number of edits on top of queue for which history, contributions and diff are prepared before they are displayed, 0 disables it
+            int             SystemConfig_PrefetchCount = 3;
             //! List of characters that separate words from each other, like dot, space etc, used by score words
             QStringList     SystemConfig_WordSeparators;
             //! This is affecting if columns are auto-sized or not
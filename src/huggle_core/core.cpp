@@ -25,10 +25,12 @@
 #include "iextension.hpp"
 #include "localization.hpp"
 #include "hooks.hpp"
+#include "memorybudget.hpp"
 #include "sleeper.hpp"
 #include "resources.hpp"
 #include "query.hpp"
 #include "querypool.hpp"
+#include "reputationstore.hpp"
 #include "scripting/script.hpp"
 #include "syslog.hpp"
 #include "wikiedit.hpp"
@@ -41,6 +43,52 @@ using namespace Huggle;
 // definitions
 Core    *Core::HuggleCore = nullptr;
 
+static qint64 MemoryBudget_LogsSize(void *source)
+{
+    return ((Syslog*)source)->GetRingLogMemoryUsage();
+}
+
+static qint64 MemoryBudget_LogsEvict(void *source, qint64 bytes)
+{
+    return ((Syslog*)source)->TrimRingLog(bytes);
+}
+
+static qint64 MemoryBudget_EditCacheSize(void *source)
+{
+    Q_UNUSED(source);
+    // only compressed text can be dropped by this cache, active text is released together with its edit
+    // by queue, history or providers
+    return WikiEdit::GetMemoryUsage().CompressedBytes;
+}
+
+static qint64 MemoryBudget_EditCacheEvict(void *source, qint64 bytes)
+{
+    Q_UNUSED(source);
+    return WikiEdit::DropCompressedText(bytes);
+}
+
+static qint64 MemoryBudget_ProviderSize(void *source)
+{
+    Q_UNUSED(source);
+    qint64 size = 0;
+    foreach (HuggleFeed *provider, HuggleFeed::GetProviders())
+        size += provider->GetBufferMemoryUsage();
+    return size;
+}
+
+static qint64 MemoryBudget_ProviderEvict(void *source, qint64 bytes)
+{
+    Q_UNUSED(source);
+    qint64 released = 0;
+    foreach (HuggleFeed *provider, HuggleFeed::GetProviders())
+    {
+        if (released >= bytes)
+            break;
+        released += provider->TrimBuffer(bytes - released);
+    }
+    return released;
+}
+
 void Core::Init()
 {
     // This goes first otherwise we can't throw exceptions
@@ -70,6 +118,10 @@ void Core::Init()
     QueryPool::HugglePool = new QueryPool();
     this->HGQP = QueryPool::HugglePool;
     this->HuggleSyslog = Syslog::HuggleLogs;
+    MemoryBudget::HuggleMemoryBudget = new MemoryBudget();
+    MemoryBudget::HuggleMemoryBudget->Register("logs", HUGGLE_MEMORY_PRIORITY_LOGS, Syslog::HuggleLogs, MemoryBudget_LogsSize, MemoryBudget_LogsEvict);
+    MemoryBudget::HuggleMemoryBudget->Register("edit cache", HUGGLE_MEMORY_PRIORITY_EDITCACHE, nullptr, MemoryBudget_EditCacheSize, MemoryBudget_EditCacheEvict);
+    MemoryBudget::HuggleMemoryBudget->Register("provider buffers", HUGGLE_MEMORY_PRIORITY_PROVIDER, nullptr, MemoryBudget_ProviderSize, MemoryBudget_ProviderEvict);
     Core::VersionRead();
 #if QT_VERSION >= 0x050000
     QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
@@ -94,6 +146,9 @@ void Core::Init()
     HUGGLE_DEBUG1("UserAgent: " + QString(hcfg->WebRequest_UserAgent));
     // Create a global wiki, now that we loaded the configuration which is only place where it can be changed
     hcfg->GlobalWiki = new WikiSite("GlobalWiki", hcfg->SystemConfig_GlobalConfigurationWikiAddress);
+    ReputationStore::HuggleReputation = new ReputationStore();
+    if (hcfg->SystemConfig_ReputationStoreSize > 0)
+        ReputationStore::HuggleReputation->Open(Configuration::GetConfigurationPath() + "reputation.db", hcfg->SystemConfig_ReputationStoreSize);
     HUGGLE_PROFILER_PRINT_TIME("Core::Init()@conf");
     HUGGLE_DEBUG1("Loading wikis");
     this->LoadDB();
@@ -131,6 +186,9 @@ Core::~Core()
 {
     delete this->gc;
     delete this->processorThread;
+    // processor thread reads from the store, so it can be deleted only after the thread is gone
+    delete ReputationStore::HuggleReputation;
+    ReputationStore::HuggleReputation = nullptr;
     delete this->exceptionHandler;
 }
 
@@ -343,6 +401,10 @@ void Core::Shutdown()
     delete this->HGQP;
     this->HGQP = nullptr;
     QueryPool::HugglePool = nullptr;
+    delete MemoryBudget::HuggleMemoryBudget;
+    MemoryBudget::HuggleMemoryBudget = nullptr;
+    // processor thread may still be running, so the store is only closed here, it's safe to call it after that
+    ReputationStore::HuggleReputation->Close();
     // Now stop the garbage collector and wait for it to finish
     GC::gc->Stop();
     Syslog::HuggleLogs->Log("SHUTDOWN: waiting for garbage collector to finish");
@@ -353,6 +415,8 @@ void Core::Shutdown()
     this->WriteProfilerDataIntoSyslog();
     Syslog::HuggleLogs->DebugLog("GC: " + QString::number(GC::gc->list.count()) + " objects");
     delete GC::gc;
+    if (hcfg->SystemConfig_FilterProfiling)
+        HuggleQueueFilter::DumpStatistics(Configuration::GetConfigurationPath() + "filter_statistics.tsv");
     HuggleQueueFilter::Delete();
     GC::gc = nullptr;
     this->gc = nullptr;
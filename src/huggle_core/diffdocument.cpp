@@ -0,0 +1,234 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#include "diffdocument.hpp"
+#include <QHash>
+
+using namespace Huggle;
+
+DiffDocument_Segment::DiffDocument_Segment(const QString &text, bool changed)
+{
+    this->Text = text;
+    this->Changed = changed;
+}
+
+QString DiffDocument_Cell::GetText() const
+{
+    QString text;
+    foreach (DiffDocument_Segment segment, this->Segments)
+        text += segment.Text;
+    return text;
+}
+
+QString DiffDocument::DecodeEntities(const QString &text)
+{
+    if (!text.contains('&'))
+        return text;
+    static QHash<QString, QChar> entities;
+    if (entities.isEmpty())
+    {
+        entities.insert("amp", '&');
+        entities.insert("lt", '<');
+        entities.insert("gt", '>');
+        entities.insert("quot", '"');
+        entities.insert("apos", '\'');
+        entities.insert("nbsp", QChar(0xA0));
+        entities.insert("minus", QChar(0x2212));
+    }
+    QString result;
+    result.reserve(text.size());
+    int position = 0;
+    while (position < text.size())
+    {
+        int amp = text.indexOf('&', position);
+        int semicolon = amp < 0 ? -1 : text.indexOf(';', amp);
+        // entities are short, anything longer is just an ampersand in text
+        if (amp < 0 || semicolon < 0 || semicolon - amp > 10)
+        {
+            result += text.mid(position);
+            break;
+        }
+        result += text.mid(position, amp - position);
+        QString name = text.mid(amp + 1, semicolon - amp - 1);
+        bool ok = false;
+        uint code = 0;
+        if (name.startsWith("#x") || name.startsWith("#X"))
+            code = name.mid(2).toUInt(&ok, 16);
+        else if (name.startsWith("#"))
+            code = name.mid(1).toUInt(&ok, 10);
+        if (ok && code > 0)
+        {
+            if (code > 0xFFFF)
+                result += QString::fromUcs4(&code, 1);
+            else
+                result += QChar(code);
+        } else if (entities.contains(name))
+        {
+            result += entities[name];
+        } else
+        {
+            // unknown entity, keep it as it is
+            result += text.mid(amp, semicolon - amp + 1);
+        }
+        position = semicolon + 1;
+    }
+    return result;
+}
+
+DiffDocument::DiffDocument()
+{
+
+}
+
+static QString DiffDocument_GetClass(const QString &tag)
+{
+    int position = tag.indexOf("class=", 0, Qt::CaseInsensitive);
+    if (position < 0)
+        return QString();
+    position += 6;
+    if (position >= tag.size())
+        return QString();
+    QChar quote = tag[position];
+    if (quote != '"' && quote != '\'')
+    {
+        int end = tag.indexOf(QRegExp("[\\s>/]"), position);
+        return end < 0 ? tag.mid(position) : tag.mid(position, end - position);
+    }
+    int end = tag.indexOf(quote, position + 1);
+    if (end < 0)
+        return QString();
+    return tag.mid(position + 1, end - position - 1);
+}
+
+static void DiffDocument_AppendCell(DiffDocument_Row *row, DiffDocument_Cell *cell, int *sides)
+{
+    if (*sides == 0)
+        row->Left = *cell;
+    else if (*sides == 1)
+        row->Right = *cell;
+    (*sides)++;
+}
+
+bool DiffDocument::Parse(const QString &html)
+{
+    this->Clear();
+    DiffDocument_Row row;
+    DiffDocument_Cell cell;
+    // number of sides that were already filled in current row
+    int sides = 0;
+    bool in_cell = false;
+    // depth of ins / del tags that mark the changed text
+    int changed = 0;
+    int position = 0;
+    while (position < html.size())
+    {
+        int tag_start = html.indexOf('<', position);
+        int text_end = tag_start < 0 ? html.size() : tag_start;
+        if (in_cell && text_end > position)
+        {
+            QString text = DecodeEntities(html.mid(position, text_end - position));
+            // MediaWiki puts new lines between tags, they are not part of content
+            text.remove('\n');
+            if (!text.isEmpty())
+            {
+                if (!cell.Segments.isEmpty() && cell.Segments.last().Changed == (changed > 0))
+                    cell.Segments.last().Text += text;
+                else
+                    cell.Segments.append(DiffDocument_Segment(text, changed > 0));
+            }
+        }
+        if (tag_start < 0)
+            break;
+        int tag_end = html.indexOf('>', tag_start);
+        if (tag_end < 0)
+            break;
+        position = tag_end + 1;
+        QString tag = html.mid(tag_start + 1, tag_end - tag_start - 1).trimmed();
+        bool closing = tag.startsWith('/');
+        if (closing)
+            tag = tag.mid(1);
+        QString name = tag.section(QRegExp("[\\s/]"), 0, 0).toLower();
+        if (name == "tr")
+        {
+            if (in_cell)
+                DiffDocument_AppendCell(&row, &cell, &sides);
+            // row that wasn't closed ends where next one starts
+            if (sides > 0)
+                this->Rows.append(row);
+            row = DiffDocument_Row();
+            sides = 0;
+            in_cell = false;
+            changed = 0;
+        } else if (name == "td")
+        {
+            // cell that wasn't closed ends where next one starts
+            if (in_cell)
+                DiffDocument_AppendCell(&row, &cell, &sides);
+            in_cell = false;
+            changed = 0;
+            if (closing)
+                continue;
+            QString css = DiffDocument_GetClass(tag);
+            if (css.contains("diff-marker"))
+            {
+                // markers are just + and - signs in front of lines, widget paints them on its own
+                continue;
+            }
+            cell = DiffDocument_Cell();
+            in_cell = true;
+            if (css.contains("diff-lineno"))
+                cell.Type = DiffDocument_LineNumber;
+            else if (css.contains("diff-deletedline"))
+                cell.Type = DiffDocument_Deleted;
+            else if (css.contains("diff-addedline"))
+                cell.Type = DiffDocument_Added;
+            else if (css.contains("diff-context"))
+                cell.Type = DiffDocument_Context;
+            else if (css.contains("diff-multi"))
+                cell.Type = DiffDocument_Notice;
+            else
+                cell.Type = DiffDocument_Empty;
+        } else if (in_cell && (name == "ins" || name == "del"))
+        {
+            if (closing)
+            {
+                if (changed > 0)
+                    changed--;
+            } else
+            {
+                changed++;
+            }
+        } else if (in_cell && name == "br" && !closing)
+        {
+            cell.Segments.append(DiffDocument_Segment("\n", changed > 0));
+        }
+    }
+    if (in_cell)
+        DiffDocument_AppendCell(&row, &cell, &sides);
+    if (sides > 0)
+        this->Rows.append(row);
+    // cells of empty sides may contain only non breaking space
+    int i = 0;
+    while (i < this->Rows.count())
+    {
+        DiffDocument_Row &r = this->Rows[i++];
+        if (r.Left.Type == DiffDocument_Empty)
+            r.Left.Segments.clear();
+        if (r.Right.Type == DiffDocument_Empty)
+            r.Right.Segments.clear();
+    }
+    return !this->Rows.isEmpty();
+}
+
+void DiffDocument::Clear()
+{
+    this->Rows.clear();
+}
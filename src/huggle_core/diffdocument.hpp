@@ -0,0 +1,81 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#ifndef DIFFDOCUMENT_HPP
+#define DIFFDOCUMENT_HPP
+
+#include "definitions.hpp"
+
+#include <QList>
+#include <QString>
+
+namespace Huggle
+{
+    enum DiffDocument_CellType
+    {
+        //! Side of row that has no content, for example left side of added line
+        DiffDocument_Empty,
+        //! Header with line number
+        DiffDocument_LineNumber,
+        DiffDocument_Context,
+        DiffDocument_Deleted,
+        DiffDocument_Added,
+        //! Note across whole row, like number of intermediate revisions that are not shown
+        DiffDocument_Notice
+    };
+
+    //! Part of line, either unchanged or highlighted as changed
+    class HUGGLE_EX_CORE DiffDocument_Segment
+    {
+        public:
+            DiffDocument_Segment(const QString &text = "", bool changed = false);
+            QString Text;
+            //! Text that was inserted or deleted within otherwise same line
+            bool Changed;
+    };
+
+    class HUGGLE_EX_CORE DiffDocument_Cell
+    {
+        public:
+            //! Plain text of whole cell
+            QString GetText() const;
+            DiffDocument_CellType Type = DiffDocument_Empty;
+            QList<DiffDocument_Segment> Segments;
+    };
+
+    //! One line of diff, left side is old revision and right side is new revision
+    class HUGGLE_EX_CORE DiffDocument_Row
+    {
+        public:
+            DiffDocument_Cell Left;
+            DiffDocument_Cell Right;
+    };
+
+    /*!
+     * \brief The DiffDocument class is a model of diff table that is returned by MediaWiki compare api
+     *
+     * The api returns diff as rows of html table, this class parses them into plain text cells, so that the diff can
+     * be painted by a native widget without a html engine. Tags other than cells and inline changes are ignored.
+     */
+    class HUGGLE_EX_CORE DiffDocument
+    {
+        public:
+            //! Replace html entities in text with characters they represent
+            static QString DecodeEntities(const QString &text);
+            DiffDocument();
+            //! Parse rows of diff table, returns false if there is nothing that could be displayed
+            bool Parse(const QString &html);
+            void Clear();
+            QList<DiffDocument_Row> Rows;
+    };
+}
+
+#endif // DIFFDOCUMENT_HPP
@@ -0,0 +1,79 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#include "editaggregator.hpp"
+#include "configuration.hpp"
+#include "exception.hpp"
+#include "wikiedit.hpp"
+#include <QDateTime>
+
+using namespace Huggle;
+
+qint64 EditAggregator::MergedEdits = 0;
+qint64 EditAggregator::RequestsAvoided = 0;
+
+EditAggregator::EditAggregator()
+{
+
+}
+
+EditAggregator::~EditAggregator()
+{
+    this->Clear();
+}
+
+bool EditAggregator::Insert(WikiEdit *edit)
+{
+    if (edit == nullptr)
+        throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    // newest edits are at the end, the previous revision of page is most likely there
+    int index = this->items.count() - 1;
+    while (index >= 0)
+    {
+        WikiEdit *held = this->items.at(index).Edit;
+        if (held->RevID == edit->OldID && held->MergeRevision(edit))
+        {
+            EditAggregator::MergedEdits++;
+            EditAggregator::RequestsAvoided += edit->GetPostProcessQueryCount();
+            edit->DecRef();
+            return true;
+        }
+        index--;
+    }
+    EditAggregator_Item item;
+    item.Edit = edit;
+    item.ReleaseTime = now + static_cast<qint64>(hcfg->SystemConfig_EditAggregationWindow) * 1000;
+    this->items.append(item);
+    return false;
+}
+
+WikiEdit *EditAggregator::RetrieveEdit()
+{
+    if (this->items.isEmpty() || this->items.at(0).ReleaseTime > QDateTime::currentMSecsSinceEpoch())
+        return nullptr;
+    WikiEdit *edit = this->items.at(0).Edit;
+    this->items.removeAt(0);
+    return edit;
+}
+
+bool EditAggregator::ContainsEdit()
+{
+    return !this->items.isEmpty();
+}
+
+void EditAggregator::Clear()
+{
+    foreach (EditAggregator_Item item, this->items)
+        item.Edit->DecRef();
+    this->items.clear();
+}
@@ -0,0 +1,71 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#ifndef EDITAGGREGATOR_HPP
+#define EDITAGGREGATOR_HPP
+
+#include "definitions.hpp"
+
+#include <QList>
+
+namespace Huggle
+{
+    class WikiEdit;
+
+    class HUGGLE_EX_CORE EditAggregator_Item
+    {
+        public:
+            WikiEdit *Edit;
+            //! Time in msecs since epoch when the edit can be released for post processing
+            qint64 ReleaseTime;
+    };
+
+    /*!
+     * \brief The EditAggregator class merges runs of edits made by same user to same page before they are post processed
+     *
+     * Every edit retrieved from a feed provider is held here for SystemConfig_EditAggregationWindow seconds. If the
+     * same user saves the page again meanwhile, the new revision is merged into the held edit, so that whole run is
+     * post processed, scored and displayed as one item with a combined diff. The window is 0 by default, so that
+     * edits are not delayed, in which case only edits that provider delivered at once are merged. The aggregator owns the reference that
+     * was passed to Insert and hands it over back in RetrieveEdit.
+     */
+    class HUGGLE_EX_CORE EditAggregator
+    {
+        public:
+            //! Number of edits that were merged into another edit since startup
+            static qint64 MergedEdits;
+            //! Estimated number of API queries that were not needed thanks to merging
+            static qint64 RequestsAvoided;
+
+            EditAggregator();
+            ~EditAggregator();
+            /*!
+             * \brief Insert holds the edit or merges it into an edit that is already held
+             * \param edit Pre processed edit, the caller passes its reference to aggregator
+             * \return true if the edit was merged and the reference was released
+             */
+            bool Insert(WikiEdit *edit);
+            //! Return the oldest edit whose window has passed, or NULL, caller takes over its reference
+            WikiEdit *RetrieveEdit();
+            bool ContainsEdit();
+            int Count();
+            void Clear();
+        private:
+            QList<EditAggregator_Item> items;
+    };
+
+    inline int EditAggregator::Count()
+    {
+        return this->items.count();
+    }
+}
+
+#endif // EDITAGGREGATOR_HPP
@@ -12,13 +12,69 @@
 #include "apiquery.hpp"
 #include "apiqueryresult.hpp"
 #include "configuration.hpp"
+#include "editqueuemodel.hpp"
+#include "exception.hpp"
+#include "huggleprofiler.hpp"
+#include "hugglequeuefilter.hpp"
 #include "querypool.hpp"
 #include "syslog.hpp"
 #include "wikiutil.hpp"
 #include "wikiedit.hpp"
+#include "wikipage.hpp"
 #include "wikiuser.hpp"
 #include "wikisite.hpp"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QThread>
 #include <QUrl>
+#include <algorithm>
+
+// "HQS2" - version of queue snapshot format
+#define HUGGLE_QUEUE_SNAPSHOT_MAGIC 0x48515332
+// Version of QDataStream serialization, so that snapshot can be read by build linked to other version of Qt
+#define HUGGLE_QUEUE_SNAPSHOT_STREAM QDataStream::Qt_5_0
+// Edits that were validated less than this number of seconds ago are restored without asking the wiki
+#define HUGGLE_QUEUE_SNAPSHOT_FRESH 60
+// Maximal number of titles in one query, this is the limit of mediawiki for regular users
+#define HUGGLE_QUEUE_SNAPSHOT_BATCH 50
+
+namespace Huggle
+{
+    //! Edits restored from snapshot that wait for check of their revision
+    class EditQueue_SnapshotCheck
+    {
+        public:
+            EditQueue *Queue;
+            QList<WikiEdit*> Edits;
+    };
+
+    //! Record of one edit that is waiting to be written to snapshot
+    class EditQueue_SnapshotRecord
+    {
+        public:
+            QByteArray Record;
+            QByteArray Text;
+            bool TextIsCompressed;
+    };
+
+    /*!
+     * \brief Writes queue snapshot on background
+     *
+     * Edits are serialized on main thread, because they can't be touched anywhere else, but compression of their
+     * texts and writing of the file are the slow parts and these happen in this thread.
+     */
+    class EditQueue_SnapshotWriter : public QThread
+    {
+        public:
+            QString Path;
+            QDateTime Time;
+            QList<EditQueue_SnapshotRecord> Records;
+            bool Success = false;
+        protected:
+            void run();
+    };
+}
 
 using namespace Huggle;
 
@@ -31,33 +87,322 @@ EditQueue::EditQueue()
 
 EditQueue::~EditQueue()
 {
+    this->WaitForSnapshot();
+    delete this->snapshotWriter;
+    if (this->model)
+        this->model->queue = nullptr;
     qDeleteAll(this->newUnprocessedEditsByRevID);
     this->newUnprocessedEditsByRevID.clear();
+    // queries that are still running will release the edits once they finish
+    foreach (EditQueue_SnapshotCheck *check, this->snapshotChecks)
+        check->Queue = nullptr;
 }
 
 void EditQueue::AddItem(WikiEdit *page)
 {
+    if (page == nullptr)
+        throw new Huggle::NullPointerException("WikiEdit *page", BOOST_CURRENT_FUNCTION);
+
+    if (!page->IsPostProcessed())
+        throw new Huggle::Exception("Insert of non processed edit to queue", BOOST_CURRENT_FUNCTION);
 
+    if (!page->IsValid)
+    {
+        HUGGLE_DEBUG1("Not inserting edit " + page->Page->PageName + " because it's broken");
+        return;
+    }
+    this->Insert(page);
+}
+
+void EditQueue::Insert(WikiEdit *edit)
+{
+    if (this->entries.Contains(edit))
+        return;
+    edit->RegisterConsumer(HUGGLECONSUMER_QUEUE);
+    EditQueue_Entry entry;
+    entry.Score = qMax(edit->Score, static_cast<long>(MINIMAL_SCORE));
+    entry.Edit = edit;
+    int position = this->findPosition(edit->Score, hcfg->SystemConfig_QueueNewEditsUp);
+    int row = this->entries.Count() - position;
+    if (this->model)
+        this->model->beginInsertRows(QModelIndex(), row, row);
+    this->entries.Insert(position, entry);
+    this->revIDIndex.insert(edit->RevID, edit);
+    if (edit->Page)
+        this->pageIndex.insert(edit->Page->SanitizedName(), edit);
+    if (edit->User)
+        this->userIndex.insert(edit->User->Username, edit);
+    if (this->model)
+        this->model->endInsertRows();
 }
 
 int EditQueue::DeleteByScore(long Score)
 {
-    return -1;
+    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    int result = 0;
+    int position = this->entries.Count() - 1;
+    while (position >= 0)
+    {
+        WikiEdit *edit = this->entries.At(position).Edit;
+        if (edit->Score < Score && this->canRemove(edit))
+        {
+            this->removeAt(position, true);
+            result++;
+        }
+        position--;
+    }
+    return result;
 }
 
 bool EditQueue::DeleteByRevID(revid_ht RevID, WikiSite *site)
 {
-    return false;
+    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    WikiEdit *edit = this->GetWikiEditByRevID(RevID, site);
+    if (edit == nullptr || !this->canRemove(edit))
+        return false;
+    int position = this->findEntry(edit);
+    if (position < 0)
+        return false;
+    this->removeAt(position, true);
+    return true;
 }
 
 void EditQueue::DeleteOlder(WikiEdit *edit)
 {
-
+    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    if (edit->Page == nullptr)
+        return;
+    foreach (WikiEdit *older, this->pageIndex.values(edit->Page->SanitizedName()))
+    {
+        if (edit->RevID > older->RevID && this->canRemove(older))
+        {
+            HUGGLE_DEBUG("Deleting old edit to page " + older->Page->PageName, 3);
+            int position = this->findEntry(older);
+            if (position >= 0)
+                this->removeAt(position, true);
+        }
+    }
 }
 
 void EditQueue::UpdateUser(WikiUser *user)
 {
+    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    foreach (WikiEdit *edit, this->userIndex.values(user->Username))
+    {
+        // let's update the icon, but only if the levels are actually different for performance reasons
+        if (edit->User->EqualTo(user) && edit->User->GetWarningLevel() != user->GetWarningLevel())
+        {
+            edit->User->SetWarningLevel(user->GetWarningLevel());
+            if (this->model)
+                this->model->RefreshRow(this->IndexOf(edit));
+        }
+    }
+}
+
+WikiEdit *EditQueue::GetWikiEditByRevID(revid_ht RevID, WikiSite *site)
+{
+    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    foreach (WikiEdit *edit, this->revIDIndex.values(RevID))
+    {
+        if (edit->GetSite() == site)
+            return edit;
+    }
+    return nullptr;
+}
+
+bool EditQueue::Remove(WikiEdit *edit)
+{
+    int position = this->findEntry(edit);
+    if (position < 0)
+        return false;
+    this->removeAt(position);
+    return true;
+}
+
+Collectable_SmartPtr<WikiEdit> EditQueue::PopBest()
+{
+    Collectable_SmartPtr<WikiEdit> result;
+    if (this->entries.Count() == 0)
+        return result;
+    result = this->entries.At(this->entries.Count() - 1).Edit;
+    this->removeAt(this->entries.Count() - 1);
+    return result;
+}
+
+void EditQueue::Resort(WikiEdit *edit)
+{
+    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    int position = this->findEntry(edit);
+    if (position < 0)
+        return;
+    int count = this->entries.Count();
+    int row = count - 1 - position;
+    EditQueue_Entry entry = this->entries.RemoveAt(position);
+    entry.Score = qMax(edit->Score, static_cast<long>(MINIMAL_SCORE));
+    int new_position = this->findPosition(entry.Score, hcfg->SystemConfig_QueueNewEditsUp);
+    if (new_position == position || !this->model)
+    {
+        this->entries.Insert(new_position, entry);
+        if (this->model)
+            this->model->RefreshRow(row);
+        return;
+    }
+    int new_row = count - 1 - new_position;
+    // destination of beginMoveRows is index before the move happens
+    this->entries.Insert(position, entry);
+    this->model->beginMoveRows(QModelIndex(), row, row, QModelIndex(), new_row > row ? new_row + 1 : new_row);
+    this->entries.RemoveAt(position);
+    this->entries.Insert(new_position, entry);
+    this->model->endMoveRows();
+    this->model->RefreshRow(new_row);
+}
+
+static bool EditQueue_EntryLess(const EditQueue_Entry &a, const EditQueue_Entry &b)
+{
+    return a.Score < b.Score;
+}
+
+void EditQueue::Sort()
+{
+    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    QModelIndexList old_indexes;
+    QList<WikiEdit*> old_edits;
+    if (this->model)
+    {
+        emit this->model->layoutAboutToBeChanged();
+        old_indexes = this->model->persistentIndexList();
+        foreach (QModelIndex index, old_indexes)
+            old_edits.append(this->At(index.row()));
+    }
+    QVector<EditQueue_Entry> sorted = this->entries.ToVector();
+    int position = 0;
+    while (position < sorted.count())
+    {
+        EditQueue_Entry &entry = sorted[position];
+        entry.Score = qMax(entry.Edit->Score, static_cast<long>(MINIMAL_SCORE));
+        position++;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), EditQueue_EntryLess);
+    this->entries.Rebuild(sorted);
+    if (this->model)
+    {
+        QModelIndexList new_indexes;
+        foreach (WikiEdit *edit, old_edits)
+            new_indexes.append(this->model->index(this->IndexOf(edit)));
+        this->model->changePersistentIndexList(old_indexes, new_indexes);
+        emit this->model->layoutChanged();
+    }
+}
+
+void EditQueue::Trim(unsigned int i)
+{
+    while (i > 0)
+    {
+        this->Trim();
+        i--;
+    }
+}
+
+void EditQueue::Trim()
+{
+    if (this->entries.Count() == 0)
+        return;
+    this->removeAt(0, true);
+}
+
+void EditQueue::Clear()
+{
+    if (this->model)
+        this->model->beginResetModel();
+    foreach (EditQueue_Entry entry, this->entries.ToVector())
+        entry.Edit->UnregisterConsumer(HUGGLECONSUMER_QUEUE);
+    this->entries.Clear();
+    this->revIDIndex.clear();
+    this->pageIndex.clear();
+    this->userIndex.clear();
+    if (this->model)
+        this->model->endResetModel();
+}
+
+qint64 EditQueue::GetMemoryUsage()
+{
+    qint64 size = 0;
+    foreach (EditQueue_Entry entry, this->entries.ToVector())
+        size += sizeof(EditQueue_Entry) + entry.Edit->GetMemoryEstimate();
+    return size;
+}
+
+qint64 EditQueue::TrimMemory(qint64 bytes)
+{
+    qint64 released = 0;
+    while (released < bytes && this->entries.Count() > 0)
+    {
+        WikiEdit *edit = this->entries.At(0).Edit;
+        // text is only compressed here, so count what it shrank by, the reference keeps edit alive until it's measured
+        edit->IncRef();
+        qint64 text_size = edit->GetTextMemoryUsage();
+        this->Trim();
+        released += sizeof(EditQueue_Entry) + edit->GetMemoryEstimate() + text_size - edit->GetTextMemoryUsage();
+        edit->DecRef();
+    }
+    return released;
+}
+
+QList<WikiEdit*> EditQueue::GetEditsForPage(WikiPage *page)
+{
+    return this->pageIndex.values(page->SanitizedName());
+}
+
+QList<WikiEdit*> EditQueue::GetEditsForUser(WikiUser *user)
+{
+    return this->userIndex.values(user->Username);
+}
+
+int EditQueue::IndexOf(WikiEdit *edit) const
+{
+    int position = this->findEntry(edit);
+    if (position < 0)
+        return -1;
+    return this->entries.Count() - 1 - position;
+}
+
+bool EditQueue::canRemove(WikiEdit *edit)
+{
+    Q_UNUSED(edit);
+    return true;
+}
 
+int EditQueue::findPosition(long score, bool new_edits_up) const
+{
+    // edits with minimal score always go to the end of queue
+    if (score <= MINIMAL_SCORE)
+        return 0;
+    return this->entries.FindPosition(score, new_edits_up);
+}
+
+int EditQueue::findEntry(WikiEdit *edit) const
+{
+    return this->entries.IndexOf(edit);
+}
+
+void EditQueue::removeAt(int position, bool discarded)
+{
+    WikiEdit *edit = this->entries.At(position).Edit;
+    int row = this->entries.Count() - 1 - position;
+    if (this->model)
+        this->model->beginRemoveRows(QModelIndex(), row, row);
+    this->entries.RemoveAt(position);
+    this->revIDIndex.remove(edit->RevID, edit);
+    if (edit->Page)
+        this->pageIndex.remove(edit->Page->SanitizedName(), edit);
+    if (edit->User)
+        this->userIndex.remove(edit->User->Username, edit);
+    if (this->model)
+        this->model->endRemoveRows();
+    // nobody is going to review this edit, but it may still be referenced from history or by other consumers
+    if (discarded && hcfg->SystemConfig_CompressReviewedEdits)
+        edit->CompressText();
+    edit->UnregisterConsumer(HUGGLECONSUMER_QUEUE);
 }
 
 void EditQueue::newEditByRevID_Success(WikiEdit *edit, void *source, QString error)
@@ -147,3 +492,214 @@ bool EditQueue_UnprocessedEdit::IsPostProcessing()
         return false;
     return this->Edit->Status != WEStatus::StatusPostProcessed;
 }
+
+void EditQueue_SnapshotWriter::run()
+{
+    // the old snapshot is replaced only once the new one is complete
+    QSaveFile file(this->Path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        Syslog::HuggleLogs->WarningLog("Unable to write queue snapshot to " + this->Path);
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(HUGGLE_QUEUE_SNAPSHOT_STREAM);
+    stream << static_cast<quint32>(HUGGLE_QUEUE_SNAPSHOT_MAGIC) << this->Time << static_cast<qint32>(this->Records.count());
+    foreach (EditQueue_SnapshotRecord record, this->Records)
+    {
+        stream.writeRawData(record.Record.constData(), record.Record.size());
+        if (record.TextIsCompressed || record.Text.isEmpty())
+            stream << record.Text;
+        else
+            stream << qCompress(record.Text);
+    }
+    if (stream.status() != QDataStream::Ok || !file.commit())
+    {
+        Syslog::HuggleLogs->WarningLog("Unable to write queue snapshot to " + this->Path);
+        return;
+    }
+    this->Success = true;
+    HUGGLE_DEBUG("Stored " + QString::number(this->Records.count()) + " edits to " + this->Path, 2);
+}
+
+bool EditQueue::SaveSnapshot(const QString &path)
+{
+    if (this->snapshotWriter != nullptr)
+    {
+        if (this->snapshotWriter->isRunning())
+        {
+            HUGGLE_DEBUG("Previous queue snapshot is still being written, skipping this one", 2);
+            return false;
+        }
+        delete this->snapshotWriter;
+    }
+    this->snapshotWriter = new EditQueue_SnapshotWriter();
+    this->snapshotWriter->Path = path;
+    this->snapshotWriter->Time = QDateTime::currentDateTime();
+    // all edits in queue are current, because the feed would have removed them otherwise, except for those
+    // that were restored from previous snapshot and not checked yet, these are still waiting outside of queue
+    int position = this->entries.Count();
+    while (position-- > 0)
+    {
+        WikiEdit *edit = this->entries.At(position).Edit;
+        EditQueue_SnapshotRecord record;
+        QDataStream stream(&record.Record, QIODevice::WriteOnly);
+        stream.setVersion(HUGGLE_QUEUE_SNAPSHOT_STREAM);
+        edit->WriteSnapshot(stream);
+        record.Text = edit->GetSnapshotText(&record.TextIsCompressed);
+        this->snapshotWriter->Records.append(record);
+    }
+    this->snapshotWriter->start(QThread::LowPriority);
+    return true;
+}
+
+bool EditQueue::WaitForSnapshot()
+{
+    if (this->snapshotWriter == nullptr)
+        return false;
+    this->snapshotWriter->wait();
+    return this->snapshotWriter->Success;
+}
+
+void EditQueue::restoreEdit(WikiEdit *edit)
+{
+    // the filter might have changed since the snapshot was written, the rest of checks is done by AddItem
+    HuggleQueueFilter *filter = edit->GetSite()->CurrentFilter;
+    if (filter != nullptr && !filter->MatchesAfterPostProcessing(edit))
+        return;
+    this->AddItem(edit);
+}
+
+int EditQueue::LoadSnapshot(const QString &path, int max_age)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+    QDataStream stream(&file);
+    stream.setVersion(HUGGLE_QUEUE_SNAPSHOT_STREAM);
+    quint32 magic = 0;
+    QDateTime time;
+    qint32 count = 0;
+    stream >> magic >> time >> count;
+    if (stream.status() != QDataStream::Ok || magic != HUGGLE_QUEUE_SNAPSHOT_MAGIC || !time.isValid())
+    {
+        Syslog::HuggleLogs->WarningLog("Queue snapshot " + path + " is broken, ignoring it");
+        return 0;
+    }
+    if (time.addSecs(static_cast<qint64>(max_age) * 60) < QDateTime::currentDateTime())
+    {
+        HUGGLE_DEBUG("Queue snapshot " + path + " is too old", 2);
+        return 0;
+    }
+    bool fresh = time.secsTo(QDateTime::currentDateTime()) < HUGGLE_QUEUE_SNAPSHOT_FRESH;
+    QHash<WikiSite*, QList<WikiEdit*> > stale;
+    int restored = 0;
+    while (count-- > 0 && stream.status() == QDataStream::Ok)
+    {
+        WikiEdit *edit = WikiEdit::ReadSnapshot(stream);
+        if (edit == nullptr)
+            continue;
+        // the queue holds its own consumer, the reference keeps the edit alive until it gets there
+        edit->IncRef();
+        restored++;
+        if (fresh)
+        {
+            this->restoreEdit(edit);
+            edit->DecRef();
+        } else
+        {
+            stale[edit->GetSite()].append(edit);
+        }
+    }
+    file.close();
+    if (stream.status() != QDataStream::Ok)
+        Syslog::HuggleLogs->WarningLog("Queue snapshot " + path + " is truncated, only part of it was restored");
+    foreach (WikiSite *site, stale.keys())
+    {
+        QList<WikiEdit*> edits = stale[site];
+        while (!edits.isEmpty())
+        {
+            this->revalidateSnapshot(site, edits.mid(0, HUGGLE_QUEUE_SNAPSHOT_BATCH));
+            edits = edits.mid(HUGGLE_QUEUE_SNAPSHOT_BATCH);
+        }
+    }
+    HUGGLE_DEBUG("Restored " + QString::number(restored) + " edits from " + path, 2);
+    return restored;
+}
+
+int EditQueue::GetSnapshotPendingCount()
+{
+    int count = 0;
+    foreach (EditQueue_SnapshotCheck *check, this->snapshotChecks)
+        count += check->Edits.count();
+    return count;
+}
+
+void EditQueue::revalidateSnapshot(WikiSite *site, const QList<WikiEdit*> &edits)
+{
+    QStringList titles;
+    foreach (WikiEdit *edit, edits)
+    {
+        if (!titles.contains(edit->Page->PageName))
+            titles << edit->Page->PageName;
+    }
+    EditQueue_SnapshotCheck *check = new EditQueue_SnapshotCheck();
+    check->Queue = this;
+    check->Edits = edits;
+    this->snapshotChecks.append(check);
+    ApiQuery *query = new ApiQuery(ActionQuery, site);
+    query->Parameters = "prop=info&titles=" + QUrl::toPercentEncoding(titles.join("|"));
+    query->Target = "Checking " + QString::number(edits.count()) + " edits restored from snapshot";
+    query->CallbackOwner = check;
+    query->SuccessCallback = reinterpret_cast<Callback>(EditQueue::snapshotCheck_Finish);
+    query->FailureCallback = reinterpret_cast<Callback>(EditQueue::snapshotCheck_Fail);
+    HUGGLE_QP_APPEND(query);
+    query->Process();
+}
+
+void EditQueue::snapshotCheck_Finish(Query *query)
+{
+    ApiQuery *result = dynamic_cast<ApiQuery*>(query);
+    EditQueue_SnapshotCheck *check = reinterpret_cast<EditQueue_SnapshotCheck*>(query->CallbackOwner);
+    QHash<QString, revid_ht> last_revisions;
+    foreach (ApiQueryResultNode *page, result->GetApiQueryResult()->GetNodes("page"))
+    {
+        if (page->Attributes.contains("lastrevid"))
+            last_revisions.insert(page->GetAttribute("title"), page->GetAttribute("lastrevid").toLongLong());
+    }
+    // mediawiki lists pages under normalized titles, which may differ from titles we stored
+    QHash<QString, QString> normalized_titles;
+    foreach (ApiQueryResultNode *normalized, result->GetApiQueryResult()->GetNodes("n"))
+        normalized_titles.insert(normalized->GetAttribute("from").replace("_", " "), normalized->GetAttribute("to"));
+    int dropped = 0;
+    foreach (WikiEdit *edit, check->Edits)
+    {
+        QString title = edit->Page->PageName;
+        title.replace("_", " ");
+        title = normalized_titles.value(title, title);
+        // edits that are no longer the last revision were most likely reverted meanwhile
+        if (check->Queue != nullptr && last_revisions.value(title, WIKI_UNKNOWN_REVID) == edit->RevID)
+            check->Queue->restoreEdit(edit);
+        else
+            dropped++;
+        edit->DecRef();
+    }
+    HUGGLE_DEBUG("Snapshot check: " + QString::number(check->Edits.count() - dropped) + " edits restored, " +
+                 QString::number(dropped) + " were outdated", 2);
+    if (check->Queue != nullptr)
+        check->Queue->snapshotChecks.removeAll(check);
+    delete check;
+    query->UnregisterConsumer(HUGGLECONSUMER_CALLBACK);
+}
+
+void EditQueue::snapshotCheck_Fail(Query *query)
+{
+    EditQueue_SnapshotCheck *check = reinterpret_cast<EditQueue_SnapshotCheck*>(query->CallbackOwner);
+    HUGGLE_WARNING("Unable to check edits restored from snapshot, dropping them: " + query->GetFailureReason());
+    foreach (WikiEdit *edit, check->Edits)
+        edit->DecRef();
+    if (check->Queue != nullptr)
+        check->Queue->snapshotChecks.removeAll(check);
+    delete check;
+    query->UnregisterConsumer(HUGGLECONSUMER_CALLBACK);
+}
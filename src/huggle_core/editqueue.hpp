@@ -13,16 +13,23 @@
 
 #include "definitions.hpp"
 #include "collectable_smartptr.hpp"
+#include "editqueueindex.hpp"
 #include "mediawikiobject.hpp"
 #include <QHash>
+#include <QList>
 
 namespace Huggle
 {
     class ApiQuery;
+    class EditQueueModel;
+    class Query;
     class WikiEdit;
+    class WikiPage;
     class WikiUser;
     class WikiSite;
     class EditQueue;
+    class EditQueue_SnapshotCheck;
+    class EditQueue_SnapshotWriter;
 
     /*!
      * \brief The EditQueue_UnprocessedEdit class is used to process information about new edit that is supposed to be obtained only
@@ -45,6 +52,11 @@ namespace Huggle
 
     /*!
      * \brief The EditQueue class handles basic operations and logic of edit queue
+     *
+     * Edits are kept in EditQueueIndex ordered by score, edit with highest score is on its end. Inserting,
+     * removing and finding position of edit takes logarithmic time, edits can be also looked up by revision
+     * id, page or user using hash indexes. The queue doesn't need any GUI, in order to
+     * display it, create an EditQueueModel for it.
      */
     class HUGGLE_EX_CORE EditQueue
     {
@@ -60,6 +72,8 @@ namespace Huggle
              * \param page is a pointer to wiki edit you want to insert to queue
              */
             virtual void AddItem(WikiEdit *page);
+            //! Insert edit to position matching its score, without checking if it should be in queue at all
+            void Insert(WikiEdit *edit);
             //! This can be used to add new edit to queue by rev id
             //! edit will be processed on background and then inserted
             virtual void AddUnprocessedEditFromRevID(revid_ht rev_id, WikiSite *site);
@@ -73,8 +87,62 @@ namespace Huggle
             //! Delete all edits to the page that are older than this edit
             virtual void DeleteOlder(WikiEdit *edit);
             virtual void UpdateUser(WikiUser *user);
-            virtual WikiEdit *GetWikiEditByRevID(revid_ht RevID, WikiSite *site)=0;
+            virtual WikiEdit *GetWikiEditByRevID(revid_ht RevID, WikiSite *site);
+            //! Remove edit from queue, returns false if it wasn't there
+            bool Remove(WikiEdit *edit);
+            //! Remove edit with highest score from queue and return it
+            Collectable_SmartPtr<WikiEdit> PopBest();
+            //! Move the edit to position that matches its current score
+            void Resort(WikiEdit *edit);
+            //! Sort whole queue, needed only if scores of many edits changed
+            void Sort();
+            //! Remove given number of edits with lowest score
+            void Trim(unsigned int i);
+            //! Remove 1 edit with lowest score
+            void Trim();
+            void Clear();
+            //! Approximate number of bytes held by edits in this queue
+            qint64 GetMemoryUsage();
+            //! Remove edits with lowest score until at least given number of bytes is released
+            qint64 TrimMemory(qint64 bytes);
+            QList<WikiEdit*> GetEditsForPage(WikiPage *page);
+            QList<WikiEdit*> GetEditsForUser(WikiUser *user);
+            int Count() const;
+            //! Edit on given position in queue, 0 is the edit with highest score
+            WikiEdit *At(int index) const;
+            //! Position of edit in queue or -1 if it isn't there
+            int IndexOf(WikiEdit *edit) const;
+            /*!
+             * \brief SaveSnapshot writes all edits in queue to a file, so that they can be restored in next session
+             *  The file is written on background, use WaitForSnapshot if you need it to be finished
+             * \return false if previous snapshot is still being written
+             */
+            bool SaveSnapshot(const QString &path);
+            //! Wait until the snapshot is written, returns true if it was written successfully
+            bool WaitForSnapshot();
+            /*!
+             * \brief LoadSnapshot restores edits written by SaveSnapshot
+             *
+             * Edits that were validated recently are inserted right away, the others are inserted only after
+             * a batched query confirms that they are still the current revision of their page. Restored edits
+             * go through the queue filter and AddItem, like edits from feed.
+             * \param path Path to the file
+             * \param max_age Snapshots older than this number of minutes are ignored
+             * \return Number of restored edits, including those that wait for revalidation
+             */
+            int LoadSnapshot(const QString &path, int max_age);
+            //! Number of edits that were restored from snapshot but still wait for revalidation
+            int GetSnapshotPendingCount();
         protected:
+            //! Returns false if the edit must stay in queue when deleting edits by revision, score or page
+            virtual bool canRemove(WikiEdit *edit);
+            //! Find position in entries where edit with this score belongs to
+            int findPosition(long score, bool new_edits_up) const;
+            //! Find position of edit in entries
+            int findEntry(WikiEdit *edit) const;
+            //! Remove entry on given position in array, this also removes the consumer of edit
+            //! \param discarded edit was thrown away without being reviewed, so its text can be compressed
+            void removeAt(int position, bool discarded = false);
             // Callbacks
             static void newEditByRevID_Success(WikiEdit *edit, void *source, QString error);
             static void newEditByRevID_Fail(WikiEdit *edit, void *source, QString error);
@@ -82,11 +150,37 @@ namespace Huggle
             //! Returns true if this edit was already requested and is now being processed
             bool checkIfNewEditByRevIDExists(revid_ht rev_id, WikiSite *site);
             WikiSite *currentSite = nullptr;
+            //! Edits ordered by score, the one with highest score is last
+            EditQueueIndex entries;
+            QMultiHash<revid_ht, WikiEdit*> revIDIndex;
+            QMultiHash<QString, WikiEdit*> pageIndex;
+            QMultiHash<QString, WikiEdit*> userIndex;
+            //! Model that displays this queue, if there is some
+            EditQueueModel *model = nullptr;
+            friend class EditQueueModel;
             //! List of queries that are attached to unknown rev_id's to be added to queue
             QList<EditQueue_UnprocessedEdit*> newUnprocessedEditsByRevID;
             friend class EditQueue_UnprocessedEdit;
             void cleanupUnprocessedEdit(EditQueue_UnprocessedEdit *edit);
+            //! Request a check that restored edits are still current revisions of their pages
+            void revalidateSnapshot(WikiSite *site, const QList<WikiEdit*> &edits);
+            static void snapshotCheck_Finish(Query *query);
+            static void snapshotCheck_Fail(Query *query);
+            //! Insert edit restored from snapshot, unless filter or AddItem reject it
+            void restoreEdit(WikiEdit *edit);
+            QList<EditQueue_SnapshotCheck*> snapshotChecks;
+            EditQueue_SnapshotWriter *snapshotWriter = nullptr;
     };
+
+    inline int EditQueue::Count() const
+    {
+        return this->entries.Count();
+    }
+
+    inline WikiEdit *EditQueue::At(int index) const
+    {
+        return this->entries.At(this->entries.Count() - 1 - index).Edit;
+    }
 }
 
 #endif // EDITQUEUE_HPP
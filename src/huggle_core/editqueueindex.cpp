@@ -0,0 +1,225 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "editqueueindex.hpp"
+#include "exception.hpp"
+
+namespace Huggle
+{
+    class EditQueueIndex_Node
+    {
+        public:
+            EditQueue_Entry Entry;
+            //! Nodes with higher priority are closer to root, random priorities keep the tree balanced
+            quint32 Priority;
+            //! Number of nodes in subtree of this node including itself
+            int Size;
+            EditQueueIndex_Node *Left;
+            EditQueueIndex_Node *Right;
+            EditQueueIndex_Node *Parent;
+    };
+}
+
+using namespace Huggle;
+
+static int EditQueueIndex_Size(EditQueueIndex_Node *node)
+{
+    if (node == nullptr)
+        return 0;
+    return node->Size;
+}
+
+//! Fix size of node after its children changed, and make the children point to it
+static void EditQueueIndex_Update(EditQueueIndex_Node *node)
+{
+    node->Size = 1 + EditQueueIndex_Size(node->Left) + EditQueueIndex_Size(node->Right);
+    if (node->Left != nullptr)
+        node->Left->Parent = node;
+    if (node->Right != nullptr)
+        node->Right->Parent = node;
+}
+
+//! Join two trees, all nodes of first one go before nodes of second one
+static EditQueueIndex_Node *EditQueueIndex_Merge(EditQueueIndex_Node *first, EditQueueIndex_Node *second)
+{
+    if (first == nullptr)
+        return second;
+    if (second == nullptr)
+        return first;
+    if (first->Priority > second->Priority)
+    {
+        first->Right = EditQueueIndex_Merge(first->Right, second);
+        EditQueueIndex_Update(first);
+        return first;
+    }
+    second->Left = EditQueueIndex_Merge(first, second->Left);
+    EditQueueIndex_Update(second);
+    return second;
+}
+
+//! Split the tree so that first count nodes are in left tree and the rest in right one
+static void EditQueueIndex_Split(EditQueueIndex_Node *node, int count, EditQueueIndex_Node **left, EditQueueIndex_Node **right)
+{
+    if (node == nullptr)
+    {
+        *left = nullptr;
+        *right = nullptr;
+        return;
+    }
+    int left_size = EditQueueIndex_Size(node->Left);
+    if (left_size < count)
+    {
+        EditQueueIndex_Split(node->Right, count - left_size - 1, &node->Right, right);
+        EditQueueIndex_Update(node);
+        *left = node;
+    } else
+    {
+        EditQueueIndex_Split(node->Left, count, left, &node->Left);
+        EditQueueIndex_Update(node);
+        *right = node;
+    }
+}
+
+EditQueueIndex::EditQueueIndex()
+{
+
+}
+
+EditQueueIndex::~EditQueueIndex()
+{
+    this->Clear();
+}
+
+const EditQueue_Entry &EditQueueIndex::At(int position) const
+{
+    if (position < 0 || position >= this->Count())
+        throw new Huggle::Exception("Position " + QString::number(position) + " is out of range", BOOST_CURRENT_FUNCTION);
+    EditQueueIndex_Node *node = this->root;
+    while (true)
+    {
+        int left_size = EditQueueIndex_Size(node->Left);
+        if (position == left_size)
+            return node->Entry;
+        if (position < left_size)
+        {
+            node = node->Left;
+        } else
+        {
+            position -= left_size + 1;
+            node = node->Right;
+        }
+    }
+}
+
+int EditQueueIndex::IndexOf(WikiEdit *edit) const
+{
+    EditQueueIndex_Node *node = this->nodes.value(edit, nullptr);
+    if (node == nullptr)
+        return -1;
+    int position = EditQueueIndex_Size(node->Left);
+    while (node->Parent != nullptr)
+    {
+        if (node->Parent->Right == node)
+            position += EditQueueIndex_Size(node->Parent->Left) + 1;
+        node = node->Parent;
+    }
+    return position;
+}
+
+int EditQueueIndex::FindPosition(long score, bool after_equal) const
+{
+    int position = 0;
+    EditQueueIndex_Node *node = this->root;
+    while (node != nullptr)
+    {
+        if (node->Entry.Score < score || (after_equal && node->Entry.Score == score))
+        {
+            position += EditQueueIndex_Size(node->Left) + 1;
+            node = node->Right;
+        } else
+        {
+            node = node->Left;
+        }
+    }
+    return position;
+}
+
+void EditQueueIndex::Insert(int position, const EditQueue_Entry &entry)
+{
+    if (this->nodes.contains(entry.Edit))
+        throw new Huggle::Exception("Edit is already in index", BOOST_CURRENT_FUNCTION);
+    EditQueueIndex_Node *node = new EditQueueIndex_Node();
+    node->Entry = entry;
+    // xorshift, quality of the numbers doesn't matter much here
+    this->seed ^= this->seed << 13;
+    this->seed ^= this->seed >> 17;
+    this->seed ^= this->seed << 5;
+    node->Priority = this->seed;
+    node->Size = 1;
+    node->Left = nullptr;
+    node->Right = nullptr;
+    node->Parent = nullptr;
+    EditQueueIndex_Node *left, *right;
+    EditQueueIndex_Split(this->root, position, &left, &right);
+    this->root = EditQueueIndex_Merge(EditQueueIndex_Merge(left, node), right);
+    this->root->Parent = nullptr;
+    this->nodes.insert(entry.Edit, node);
+}
+
+EditQueue_Entry EditQueueIndex::RemoveAt(int position)
+{
+    if (position < 0 || position >= this->Count())
+        throw new Huggle::Exception("Position " + QString::number(position) + " is out of range", BOOST_CURRENT_FUNCTION);
+    EditQueueIndex_Node *left, *middle, *right;
+    EditQueueIndex_Split(this->root, position, &left, &right);
+    EditQueueIndex_Split(right, 1, &middle, &right);
+    this->root = EditQueueIndex_Merge(left, right);
+    if (this->root != nullptr)
+        this->root->Parent = nullptr;
+    EditQueue_Entry entry = middle->Entry;
+    this->nodes.remove(entry.Edit);
+    delete middle;
+    return entry;
+}
+
+void EditQueueIndex::Clear()
+{
+    qDeleteAll(this->nodes);
+    this->nodes.clear();
+    this->root = nullptr;
+}
+
+QVector<EditQueue_Entry> EditQueueIndex::ToVector() const
+{
+    QVector<EditQueue_Entry> result;
+    result.reserve(this->Count());
+    // in order walk, the stack holds nodes whose left subtree is being visited
+    QVector<EditQueueIndex_Node*> stack;
+    EditQueueIndex_Node *node = this->root;
+    while (node != nullptr || !stack.isEmpty())
+    {
+        while (node != nullptr)
+        {
+            stack.append(node);
+            node = node->Left;
+        }
+        node = stack.takeLast();
+        result.append(node->Entry);
+        node = node->Right;
+    }
+    return result;
+}
+
+void EditQueueIndex::Rebuild(const QVector<EditQueue_Entry> &entries)
+{
+    this->Clear();
+    foreach (EditQueue_Entry entry, entries)
+        this->Insert(this->Count(), entry);
+}
@@ -0,0 +1,85 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef EDITQUEUEINDEX_HPP
+#define EDITQUEUEINDEX_HPP
+
+#include "definitions.hpp"
+
+#include <QHash>
+#include <QVector>
+
+namespace Huggle
+{
+    class WikiEdit;
+    class EditQueueIndex_Node;
+
+    //! Item of edit queue, score is remembered so that edit can be found even after its score changed
+    class EditQueue_Entry
+    {
+        public:
+            long Score;
+            WikiEdit *Edit;
+    };
+
+    /*!
+     * \brief Ordered sequence of queue entries with access by position
+     *
+     * Entries are kept in a balanced binary tree (treap) where every node knows the size of its subtree,
+     * so that inserting, removing and looking up entry on some position as well as finding a position of
+     * an edit takes logarithmic time. The model of queue needs the positions, so a plain ordered map or a
+     * heap is not enough. Position 0 is the entry with lowest score.
+     */
+    class HUGGLE_EX_CORE EditQueueIndex
+    {
+        public:
+            EditQueueIndex();
+            ~EditQueueIndex();
+            int Count() const;
+            bool Contains(WikiEdit *edit) const;
+            const EditQueue_Entry &At(int position) const;
+            //! Position of edit or -1 if it isn't there
+            int IndexOf(WikiEdit *edit) const;
+            /*!
+             * \brief Find position where entry with given score belongs to
+             * \param score Score
+             * \param after_equal If true, the position is after all entries with same score, otherwise before them
+             */
+            int FindPosition(long score, bool after_equal) const;
+            //! Insert entry on given position, caller is responsible for keeping the entries ordered
+            void Insert(int position, const EditQueue_Entry &entry);
+            EditQueue_Entry RemoveAt(int position);
+            void Clear();
+            //! All entries in their order
+            QVector<EditQueue_Entry> ToVector() const;
+            //! Replace all entries with given ones, which must be already ordered
+            void Rebuild(const QVector<EditQueue_Entry> &entries);
+        private:
+            EditQueueIndex_Node *root = nullptr;
+            //! Node of every edit so that its position can be computed by walking to root
+            QHash<WikiEdit*, EditQueueIndex_Node*> nodes;
+            //! State of generator of priorities of nodes
+            quint32 seed = 2463534242u;
+    };
+
+    inline int EditQueueIndex::Count() const
+    {
+        return this->nodes.count();
+    }
+
+    inline bool EditQueueIndex::Contains(WikiEdit *edit) const
+    {
+        return this->nodes.contains(edit);
+    }
+}
+
+Q_DECLARE_TYPEINFO(Huggle::EditQueue_Entry, Q_PRIMITIVE_TYPE);
+
+#endif // EDITQUEUEINDEX_HPP
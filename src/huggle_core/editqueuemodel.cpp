@@ -0,0 +1,80 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#include "editqueuemodel.hpp"
+#include "editqueue.hpp"
+#include "exception.hpp"
+#include "wikiedit.hpp"
+#include "wikipage.hpp"
+#include "wikisite.hpp"
+#include "wikiuser.hpp"
+
+using namespace Huggle;
+
+EditQueueModel::EditQueueModel(EditQueue *edit_queue, QObject *parent) : QAbstractListModel(parent)
+{
+    if (edit_queue == nullptr)
+        throw new Huggle::NullPointerException("EditQueue *edit_queue", BOOST_CURRENT_FUNCTION);
+    if (edit_queue->model != nullptr)
+        throw new Huggle::Exception("This queue is already displayed by other model", BOOST_CURRENT_FUNCTION);
+    this->queue = edit_queue;
+    this->queue->model = this;
+}
+
+EditQueueModel::~EditQueueModel()
+{
+    if (this->queue)
+        this->queue->model = nullptr;
+}
+
+int EditQueueModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !this->queue)
+        return 0;
+    return this->queue->Count();
+}
+
+QVariant EditQueueModel::data(const QModelIndex &index, int role) const
+{
+    if (!this->queue || !index.isValid() || index.row() >= this->queue->Count())
+        return QVariant();
+    WikiEdit *edit = this->queue->At(index.row());
+    switch (role)
+    {
+        case Qt::DisplayRole:
+            return edit->Page->PageName;
+        case Qt::ToolTipRole:
+        {
+            QString tooltip = "<b>Wiki: </b>" + edit->GetSite()->Name + "<br><b>User: </b>" + edit->User->Username +
+                              "<b><br>Date: </b>" + edit->Time.toString() + "<br><b>Score: </b>" + QString::number(edit->Score);
+            foreach (QString label, edit->MetaLabels.keys())
+                tooltip += "<br><b>" + label + ": </b>" + edit->MetaLabels[label];
+            return tooltip;
+        }
+        case ScoreRole:
+            return static_cast<qlonglong>(edit->Score);
+        case PixmapRole:
+            return edit->GetPixmap();
+        case NamespaceRole:
+            return edit->Page->GetNS()->GetID();
+        case RevIDRole:
+            return static_cast<qlonglong>(edit->RevID);
+    }
+    return QVariant();
+}
+
+void EditQueueModel::RefreshRow(int row)
+{
+    if (row < 0)
+        return;
+    QModelIndex changed = this->index(row);
+    emit this->dataChanged(changed, changed);
+}
@@ -0,0 +1,62 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#ifndef EDITQUEUEMODEL_HPP
+#define EDITQUEUEMODEL_HPP
+
+#include "definitions.hpp"
+
+#include <QAbstractListModel>
+
+namespace Huggle
+{
+    class EditQueue;
+
+    /*!
+     * \brief The EditQueueModel class is a list model that displays an EditQueue
+     *
+     * Edits are ordered by score (highest first), the queue itself notifies the model whenever
+     * some edit is inserted, removed or moved.
+     */
+    class HUGGLE_EX_CORE EditQueueModel : public QAbstractListModel
+    {
+            Q_OBJECT
+        public:
+            enum Role
+            {
+                ScoreRole = Qt::UserRole + 1,
+                //! Path to icon of edit
+                PixmapRole,
+                //! ID of namespace of page
+                NamespaceRole,
+                RevIDRole
+            };
+
+            EditQueueModel(EditQueue *edit_queue, QObject *parent = nullptr);
+            ~EditQueueModel();
+            int rowCount(const QModelIndex &parent = QModelIndex()) const;
+            QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+            //! Let views know that information about edit changed
+            void RefreshRow(int row);
+            EditQueue *GetQueue();
+
+        private:
+            EditQueue *queue;
+            friend class EditQueue;
+    };
+
+    inline EditQueue *EditQueueModel::GetQueue()
+    {
+        return this->queue;
+    }
+}
+
+#endif // EDITQUEUEMODEL_HPP
@@ -11,6 +11,13 @@
 #include "generic.hpp"
 #include <QUrl>
 #include <QCryptographicHash>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#ifdef Q_OS_LINUX
+    #include <unistd.h>
+#endif
 #include "configuration.hpp"
 #include "exception.hpp"
 #include "hooks.hpp"
@@ -210,3 +217,54 @@ bool Generic::SecondsToTimeSpan(int time, int *days, int *hours, int *minutes, i
     *seconds = remaining_time;
     return true;
 }
+
+#ifdef Q_OS_LINUX
+static qint64 Generic_ReadResidentPages(qint64 pid)
+{
+    QFile statm("/proc/" + QString::number(pid) + "/statm");
+    if (!statm.open(QIODevice::ReadOnly))
+        return 0;
+    // second field is number of resident pages
+    return QString(statm.readAll()).section(' ', 1, 1).toLongLong();
+}
+#endif
+
+qint64 Generic::GetResidentMemory(bool include_children)
+{
+#ifdef Q_OS_LINUX
+    qint64 pid = QCoreApplication::applicationPid();
+    qint64 pages = Generic_ReadResidentPages(pid);
+    if (include_children)
+    {
+        // web engine renderers are not direct children, so we need to walk whole process tree
+        QHash<qint64, qint64> parents;
+        foreach (QString entry, QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+        {
+            bool ok;
+            qint64 process = entry.toLongLong(&ok);
+            if (!ok)
+                continue;
+            QFile stat("/proc/" + entry + "/stat");
+            if (!stat.open(QIODevice::ReadOnly))
+                continue;
+            // name of process is in parentheses and may contain spaces, parent id is second field after it
+            QString data = QString(stat.readAll());
+            parents.insert(process, data.mid(data.lastIndexOf(')') + 2).section(' ', 1, 1).toLongLong());
+        }
+        foreach (qint64 process, parents.keys())
+        {
+            qint64 parent = parents[process];
+            // processes may be reparented, so the depth is limited to avoid cycles
+            int depth = 0;
+            while (parent > 1 && parent != pid && depth++ < 32)
+                parent = parents.value(parent, 0);
+            if (parent == pid && process != pid)
+                pages += Generic_ReadResidentPages(process);
+        }
+    }
+    return pages * sysconf(_SC_PAGESIZE);
+#else
+    Q_UNUSED(include_children);
+    return -1;
+#endif
+}
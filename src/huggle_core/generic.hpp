@@ -60,6 +60,11 @@ namespace Huggle
          * \return new string
          */
         HUGGLE_EX_CORE QString ShrinkText(const QString &text, int size, bool html = true, int minimum = 2);
+        /*!
+         * \brief GetResidentMemory returns physical memory used by huggle in bytes, or -1 if it's not supported on this system
+         * \param include_children if true, memory of child processes (like the renderers of web engine) is included
+         */
+        HUGGLE_EX_CORE qint64 GetResidentMemory(bool include_children = false);
     }
 }
 
@@ -11,6 +11,7 @@
 #include "configuration.hpp"
 #include "hugglefeed.hpp"
 #include "exception.hpp"
+#include "wikiedit.hpp"
 #include "wikisite.hpp"
 
 using namespace Huggle;
@@ -168,6 +169,28 @@ qint64 HuggleFeed::GetUptime()
     return this->startupTime.secsTo(QDateTime::currentDateTime());
 }
 
+qint64 HuggleFeed::getBufferMemoryUsage(QList<WikiEdit*> *buffer)
+{
+    qint64 size = 0;
+    foreach (WikiEdit *edit, *buffer)
+        size += edit->GetMemoryEstimate();
+    return size;
+}
+
+qint64 HuggleFeed::trimBuffer(QList<WikiEdit*> *buffer, qint64 bytes)
+{
+    qint64 released = 0;
+    while (released < bytes && !buffer->isEmpty())
+    {
+        WikiEdit *edit = buffer->at(0);
+        buffer->removeAt(0);
+        // text isn't touched here, it's freed only once GC deletes the edit
+        released += edit->GetMemoryEstimate();
+        edit->DecRef();
+    }
+    return released;
+}
+
 void HuggleFeed::rotateStats()
 {
     if (this->statisticsBlocks.count() < 2)
@@ -87,8 +87,14 @@ namespace Huggle
             qint64 GetUptime();
             virtual unsigned long long GetBytesReceived()=0;
             virtual unsigned long long GetBytesSent()=0;
+            //! Approximate number of bytes held by edits that are waiting in buffer of this provider
+            virtual qint64 GetBufferMemoryUsage() { return 0; }
+            //! Remove oldest edits from buffer until at least given number of bytes is released
+            virtual qint64 TrimBuffer(qint64 bytes) { Q_UNUSED(bytes); return 0; }
             HuggleQueueFilter *Filter;
         protected:
+            static qint64 getBufferMemoryUsage(QList<WikiEdit*> *buffer);
+            static qint64 trimBuffer(QList<WikiEdit*> *buffer, qint64 bytes);
             static QList<HuggleFeed*> providerList;
             void rotateStats();
             StatisticsBlock *getLatestStatisticsBlock();
@@ -108,7 +108,7 @@ void HuggleFeedProviderIRC::InsertEdit(WikiEdit *edit)
     QueryPool::HugglePool->PreProcessEdit(edit);
     // We only insert it to buffer in case that current filter matches the edit, this is probably not needed
     // but it might be a performance improvement at some point
-    if (edit->GetSite()->CurrentFilter->Matches(edit) && Hooks::EditBeforePreProcess(edit))
+    if (edit->GetSite()->CurrentFilter->MatchesBeforePostProcessing(edit) && Hooks::EditBeforePreProcess(edit))
     {
         if (this->editBuffer.size() > Configuration::HuggleConfiguration->SystemConfig_ProviderCache)
         {
@@ -199,7 +199,7 @@ void HuggleFeedProviderIRC::ParseEdit(QString line)
             return;
         }
         edit->Diff = line.mid(0, line.indexOf("&")).toLongLong();
-        edit->RevID = line.mid(0, line.indexOf("&")).toLongLong();
+        edit->SetRevID(line.mid(0, line.indexOf("&")).toLongLong());
     }
     if (!line.contains("oldid="))
     {
@@ -234,7 +234,7 @@ void HuggleFeedProviderIRC::ParseEdit(QString line)
         edit->DecRef();
         return;
     }
-    edit->User = new WikiUser(name, this->GetSite());
+    edit->User = WikiUser::Acquire(name, this->GetSite());
     if (line.contains(QString(QChar(3)) + " ("))
     {
         line = line.mid(line.indexOf(QString(QChar(3)) + " (") + 3);
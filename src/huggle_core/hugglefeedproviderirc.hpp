@@ -55,6 +55,8 @@ namespace Huggle
             int GetID() override { return HUGGLE_FEED_PROVIDER_IRC; }
             bool ContainsEdit() override;
             WikiEdit *RetrieveEdit() override;
+            qint64 GetBufferMemoryUsage() override { return HuggleFeed::getBufferMemoryUsage(&this->editBuffer); }
+            qint64 TrimBuffer(qint64 bytes) override { return HuggleFeed::trimBuffer(&this->editBuffer, bytes); }
             bool IsPaused() override { return this->isPaused; }
             void Pause() override { this->isPaused = true; }
             void Resume() override { this->isPaused = false; }
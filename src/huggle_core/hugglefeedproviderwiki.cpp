@@ -205,7 +205,7 @@ void HuggleFeedProviderWiki::processEdit(const QDomElement& item)
         edit->SetSize(item.attribute("newlen").toLong() - item.attribute("oldlen").toLong());
     if (item.attributes().contains("user"))
     {
-        edit->User = new WikiUser(item.attribute("user"), this->GetSite());
+        edit->User = WikiUser::Acquire(item.attribute("user"), this->GetSite());
         if (item.attributes().contains("anon"))
             edit->User->ForceIP();
     }
@@ -215,11 +215,13 @@ void HuggleFeedProviderWiki::processEdit(const QDomElement& item)
         edit->Bot = true;
     if (item.attributes().contains("revid"))
     {
-        edit->RevID = QString(item.attribute("revid")).toInt();
-        if (!edit->RevID)
-            edit->RevID = WIKI_UNKNOWN_REVID;
-
+        revid_ht revid = QString(item.attribute("revid")).toLongLong();
+        if (!revid)
+            revid = WIKI_UNKNOWN_REVID;
+        edit->SetRevID(revid);
     }
+    if (item.attributes().contains("old_revid"))
+        edit->OldID = QString(item.attribute("old_revid")).toLongLong();
     if (item.attributes().contains("minor"))
         edit->IsMinor = true;
     edit->IncRef();
@@ -269,7 +271,7 @@ void HuggleFeedProviderWiki::insertEdit(WikiEdit *edit)
 {
     this->IncrementEdits();
     QueryPool::HugglePool->PreProcessEdit(edit);
-    if (edit->GetSite()->CurrentFilter->Matches(edit) && Hooks::EditBeforePreProcess(edit))
+    if (edit->GetSite()->CurrentFilter->MatchesBeforePostProcessing(edit) && Hooks::EditBeforePreProcess(edit))
     {
         if (this->editBuffer->size() > Configuration::HuggleConfiguration->SystemConfig_ProviderCache)
         {
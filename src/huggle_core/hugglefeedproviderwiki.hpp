@@ -48,6 +48,8 @@ namespace Huggle
             unsigned long long GetBytesReceived() override;
             unsigned long long GetBytesSent() override;
             WikiEdit *RetrieveEdit() override;
+            qint64 GetBufferMemoryUsage() override { return HuggleFeed::getBufferMemoryUsage(this->editBuffer); }
+            qint64 TrimBuffer(qint64 bytes) override { return HuggleFeed::trimBuffer(this->editBuffer, bytes); }
             QString ToString() override;
         private:
             void processData(const QString& data);
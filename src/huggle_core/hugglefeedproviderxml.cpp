@@ -231,7 +231,7 @@ void HuggleFeedProviderXml::insertEdit(WikiEdit *edit)
     QueryPool::HugglePool->PreProcessEdit(edit);
     // We only insert it to buffer in case that current filter matches the edit, this is probably not needed
     // but it might be a performance improvement at some point
-    if (edit->GetSite()->CurrentFilter->Matches(edit) && Hooks::EditBeforePreProcess(edit))
+    if (edit->GetSite()->CurrentFilter->MatchesBeforePostProcessing(edit) && Hooks::EditBeforePreProcess(edit))
     {
         if (this->buffer.size() > hcfg->SystemConfig_ProviderCache)
         {
@@ -340,8 +340,8 @@ void HuggleFeedProviderXml::processBufs()
         edit->Bot = Generic::SafeBool(element.attribute("bot"));
         edit->NewPage = (element.attribute("type") == "new");
         edit->IsMinor = Generic::SafeBool(element.attribute("minor"));
-        edit->RevID = element.attribute("revid").toLong();
-        edit->User = new WikiUser(element.attribute("user"), this->GetSite());
+        edit->SetRevID(element.attribute("revid").toLongLong());
+        edit->User = WikiUser::Acquire(element.attribute("user"), this->GetSite());
         edit->Summary = element.attribute("summary");
         if (element.attributes().contains("length_new")
                && element.attributes().contains("length_old"))
@@ -44,6 +44,8 @@ namespace Huggle
             unsigned long long GetBytesReceived() override;
             unsigned long long GetBytesSent() override;
             WikiEdit *RetrieveEdit() override;
+            qint64 GetBufferMemoryUsage() override { return HuggleFeed::getBufferMemoryUsage(&this->buffer); }
+            qint64 TrimBuffer(qint64 bytes) override { return HuggleFeed::trimBuffer(&this->buffer, bytes); }
             QString ToString() override;
         private slots:
             void OnError(QAbstractSocket::SocketError er);
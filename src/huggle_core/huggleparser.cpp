@@ -13,14 +13,55 @@
 #include "huggleprofiler.hpp"
 #include "configuration.hpp"
 #include "generic.hpp"
+#include "multipatternmatcher.hpp"
 #include "userconfiguration.hpp"
 #include "projectconfiguration.hpp"
 #include "syslog.hpp"
 #include "wikisite.hpp"
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
 #include <yaml-cpp/yaml.h>
 
 using namespace Huggle;
 
+// maximal number of talk pages that are remembered by GetLevel cache
+#define HUGGLE_PARSER_LEVEL_CACHE_SIZE 4000
+
+namespace Huggle
+{
+    //! Key of GetLevel cache, the talk page is identified by two hashes with different seeds and its length
+    class HuggleParser_LevelKey
+    {
+        public:
+            bool operator==(const HuggleParser_LevelKey &key) const
+            {
+                return this->Site == key.Site && this->Hash == key.Hash && this->Hash2 == key.Hash2 &&
+                        this->Length == key.Length && this->Day == key.Day && this->Config == key.Config;
+            }
+            WikiSite *Site;
+            uint Hash;
+            uint Hash2;
+            int Length;
+            qint64 Day;
+            //! Hash of configuration that affects result of parser
+            uint Config;
+    };
+
+    inline uint qHash(const HuggleParser_LevelKey &key, uint seed = 0)
+    {
+        return key.Hash ^ ::qHash(key.Site, seed) ^ ::qHash(key.Day, seed);
+    }
+}
+
+static QHash<HuggleParser_LevelKey, byte_ht> HuggleParser_LevelCache;
+static QMutex HuggleParser_LevelCacheLock(QMutex::Recursive);
+static qint64 HuggleParser_LevelCacheHits = 0;
+static qint64 HuggleParser_LevelCacheMisses = 0;
+//! Matchers are shared, so that parser which is using one doesn't need to hold the lock while another thread replaces it
+static QHash<WikiSite*, QSharedPointer<MultiPatternMatcher> > HuggleParser_WarningMatchers;
+static QHash<WikiSite*, uint> HuggleParser_WarningMatchersConfig;
+
 QString HuggleParser::UserConfig_NonEmpty(const QString& key, const QString& value, const QString& default_val)
 {
     // We have to copy the string here, because replace() in Qt alters the string itself
@@ -202,148 +243,248 @@ QString HuggleParser::GetKeyFromSSItem(QString item)
     return item;
 }
 
-static int DateMark(const QString& page, WikiSite *site)
+//! Position of last date suffix in part of page between start and end, relative to start, 0 if there is none
+static int HuggleParser_DateMark(const QString &page, int start, int end, WikiSite *site)
 {
-    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
-    int m = 0;
     int position = 0;
-    QString mark = "";
-    while (m < site->GetProjectConfig()->Parser_Date_Suffix.count())
+    foreach (QString suffix, site->GetProjectConfig()->Parser_Date_Suffix)
     {
-        QString m_ = site->GetProjectConfig()->Parser_Date_Suffix.at(m);
-        if (page.contains(m_))
+        int mp = end - start;
+        if (!suffix.isEmpty())
         {
-            int mp = page.lastIndexOf(m_);
-            if (mp > position)
-            {
-                mark = m_;
-                position = mp;
-            }
+            if (suffix.length() > end - start)
+                continue;
+            // search only inside of the section, otherwise every section would scan the page back to its beginning
+            mp = page.midRef(start, end - start).lastIndexOf(suffix);
+            if (mp < 0)
+                continue;
         }
-        m++;
+        if (mp > position)
+            position = mp;
     }
     return position;
 }
 
-byte_ht HuggleParser::GetLevel(QString page, QDate bt, WikiSite *site)
+//! Returns true if the section of page between start and end is signed with a date that is not too old
+static bool HuggleParser_SectionIsCurrent(const QString &page, int start, int end, QDate bt, WikiSite *site)
+{
+    int dp = HuggleParser_DateMark(page, start, end, site);
+    // we need to find a date in this section
+    if (!dp)
+        return false;
+    // the part of section that precedes the date suffix, without whitespace around
+    int date_start = start;
+    int date_end = start + dp;
+    while (date_start < date_end && page[date_start].isSpace())
+        date_start++;
+    while (date_end > date_start && page[date_end - 1].isSpace())
+        date_end--;
+    QString prefix = site->GetProjectConfig()->Parser_Date_Prefix;
+    int prefix_position = -1;
+    if (!prefix.isEmpty() && date_end - prefix.length() >= date_start)
+        prefix_position = page.midRef(date_start, date_end - date_start).lastIndexOf(prefix);
+    if (prefix_position < 0)
+    {
+        // this is some borked date let's remove it
+        return false;
+    }
+    prefix_position += date_start;
+    int time_start = prefix_position + prefix.length();
+    QString time = page.mid(time_start, date_end - time_start);
+    // now we need this uberhack so that we can get a month name from localized version
+    // let's hope that month is a word in a middle of string
+    time = time.trimmed();
+    QString month_name = "";
+    QStringList parts_time = time.split(' ');
+    if (parts_time.count() < 3)
+    {
+        // this is invalid string
+        HUGGLE_DEBUG("Unable to split month: " + time, 12);
+        return false;
+    }
+    QString day = parts_time.at(0);
+    // e.g. dewiki's days end with dot
+    if(day.endsWith('.'))
+        day = day.mid(0, day.length() - 1);
+    // on some wikis months have spaces in name
+    int i = 1;
+    while (i < parts_time.count() - 1)
+    {
+        month_name += parts_time.at(i) + " ";
+        i++;
+    }
+    month_name = month_name.trimmed();
+    byte_ht month = HuggleParser::GetIDOfMonth(month_name, site);
+
+     // let's create a new time string from converted one, just to make sure it will be parsed properly
+    if (month > 0)
+    {
+        time = day + " " + QString::number(month) + " " + parts_time.last();
+    } else
+    {
+        time = day + " " + parts_time.at(1) + " " + parts_time.last();
+    }
+    QDate date = QDate::fromString(time, "d M yyyy");
+    if (!date.isValid())
+    {
+        HUGGLE_DEBUG("Invalid date: " + time, 1);
+        return false;
+    }
+    // now check if it's at least 1 month old
+    return bt.addDays(site->ProjectConfig->TemplateAge) <= date;
+}
+
+//! Returns the matcher of warning templates for a site, it's rebuilt when the templates change
+static QSharedPointer<MultiPatternMatcher> HuggleParser_GetWarningMatcher(WikiSite *site)
+{
+    uint config = qHash(site->ProjectConfig->WarningDefs);
+    HuggleParser_LevelCacheLock.lock();
+    QSharedPointer<MultiPatternMatcher> matcher = HuggleParser_WarningMatchers.value(site);
+    if (!matcher.isNull() && HuggleParser_WarningMatchersConfig.value(site) == config)
+    {
+        HuggleParser_LevelCacheLock.unlock();
+        return matcher;
+    }
+    HuggleParser_LevelCacheLock.unlock();
+    // the matcher is built without the lock, in case more threads do this at once only one of them is kept
+    matcher = QSharedPointer<MultiPatternMatcher>(new MultiPatternMatcher());
+    foreach (QString df, site->ProjectConfig->WarningDefs)
+    {
+        int level = HuggleParser::GetKeyFromSSItem(df).toInt();
+        if (level >= 1 && level <= 4)
+            matcher->AddPattern(HuggleParser::GetValueFromSSItem(df), level);
+    }
+    matcher->Build();
+    HuggleParser_LevelCacheLock.lock();
+    HuggleParser_WarningMatchers.insert(site, matcher);
+    HuggleParser_WarningMatchersConfig.insert(site, config);
+    HuggleParser_LevelCacheLock.unlock();
+    return matcher;
+}
+
+byte_ht HuggleParser::ParseLevel(const QString &text, QDate bt, WikiSite *site)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
-    if (Configuration::HuggleConfiguration->SystemConfig_TrimOldWarnings)
+    // matcher is read only once it's built, so the parsing itself doesn't need any lock
+    QSharedPointer<MultiPatternMatcher> matcher = HuggleParser_GetWarningMatcher(site);
+    int level = -1;
+    if (!Configuration::HuggleConfiguration->SystemConfig_TrimOldWarnings)
+    {
+        level = matcher->MatchHighest(text.constData(), text.length(), 4);
+    } else if (matcher->Count() > 0)
     {
-        // we need to get rid of old warnings now
-        QStringList sections;
+        // we need to get rid of old warnings now, so only sections (separated by empty line) that are
+        // signed with current date are searched for warnings, the page is walked once without copying
+        // these sections
+        QString page = text;
         // windows fix
-        page.replace("\r", "");
-        while (page.length() > 1)
-        {
-            while (page[0] == '\n')
-            {
-                // remove all leading extra lines on page
-                page = page.mid(1);
-            }
-            if (!page.contains("\n\n"))
-            {
-                // no sections
-                sections.append(page);
-                break;
-            }
-            // get to bottom of it
-            int bottom = 0;
-            bottom = page.indexOf("\n\n");
-            QString section = page.mid(0, bottom);
-            page = page.mid(bottom + 2);
-            sections.append(section);
-        }
-
-        // now we browse all sections and remove these with no current date
-        int CurrentIndex = 0;
-        page = "";
-        while (CurrentIndex < sections.count())
+        if (page.contains('\r'))
+            page.remove('\r');
+        const QChar *data = page.constData();
+        int length = page.length();
+        // patterns that span more lines could match across sections, in that case we need to join them
+        QString current_sections;
+        int position = 0;
+        while (length - position > 1)
         {
-            int dp = DateMark(sections.at(CurrentIndex), site);
-            // we need to find a date in this section
-            if (!dp)
-            {
-                // there is none
-                CurrentIndex++;
-                continue;
-            }
-            QString section = sections.at(CurrentIndex);
-            section = section.mid(0, dp).trimmed();
-            if (!section.contains(site->GetProjectConfig()->Parser_Date_Prefix))
-            {
-                // this is some borked date let's remove it
-                CurrentIndex++;
-                continue;
-            }
-            QString time = section.mid(section.lastIndexOf(site->GetProjectConfig()->Parser_Date_Prefix) + site->GetProjectConfig()->Parser_Date_Prefix.length());
-            // now we need this uberhack so that we can get a month name from localized version
-            // let's hope that month is a word in a middle of string
-            time = time.trimmed();
-            QString month_name = "";
-            QStringList parts_time = time.split(' ');
-            if (parts_time.count() < 3)
-            {
-                // this is invalid string
-                HUGGLE_DEBUG("Unable to split month: " + time, 12);
-                CurrentIndex++;
-                continue;
-            }
-            QString day = parts_time.at(0);
-            // e.g. dewiki's days end with dot
-            if(day.endsWith('.'))
-                day = day.mid(0, day.length() - 1);
-            // on some wikis months have spaces in name
-            int i = 1;
-            while (i < parts_time.count() - 1)
+            // remove all leading extra lines on page
+            while (position < length && data[position] == '\n')
+                position++;
+            int end = page.indexOf("\n\n", position);
+            bool last = end < 0;
+            if (last)
+                end = length;
+            if (HuggleParser_SectionIsCurrent(page, position, end, bt, site))
             {
-                month_name += parts_time.at(i) + " ";
-                i++;
-            }
-            month_name = month_name.trimmed();
-            byte_ht month = HuggleParser::GetIDOfMonth(month_name, site);
-
-             // let's create a new time string from converted one, just to make sure it will be parsed properly
-            if (month > 0)
-            {
-                time = day + " " + QString::number(month) + " " + parts_time.last();
-            } else
-            {
-                time = day + " " + parts_time.at(1); + " " + parts_time.last();
-            }
-            QDate date = QDate::fromString(time, "d M yyyy");
-            if (!date.isValid())
-            {
-                HUGGLE_DEBUG("Invalid date: " + time, 1);
-                CurrentIndex++;
-                continue;
-            } else
-            {
-                // now check if it's at least 1 month old
-                if (bt.addDays(site->ProjectConfig->TemplateAge) > date)
+                if (matcher->HasMultilinePatterns())
                 {
-                    // we don't want to parse this thing
-                    CurrentIndex++;
-                    continue;
+                    current_sections.append(page.midRef(position, end - position));
+                    current_sections.append('\n');
+                } else
+                {
+                    int found = matcher->MatchHighest(data + position, end - position, 4);
+                    if (found > level)
+                        level = found;
+                    if (level >= 4)
+                        break;
                 }
             }
-            page += sections.at(CurrentIndex) + "\n";
-            CurrentIndex++;
+            if (last)
+                break;
+            position = end + 2;
         }
+        if (matcher->HasMultilinePatterns())
+            level = matcher->MatchHighest(current_sections.constData(), current_sections.length(), 4);
+    }
+    if (level < 0)
+        return 0;
+    return static_cast<byte_ht>(level);
+}
+
+byte_ht HuggleParser::GetLevel(const QString &page, QDate bt, WikiSite *site)
+{
+    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    HuggleParser_LevelKey key;
+    key.Site = site;
+    key.Hash = qHash(page);
+    key.Hash2 = qHash(page, 0x9e3779b9);
+    key.Length = page.length();
+    key.Day = bt.toJulianDay();
+    key.Config = qHash(site->ProjectConfig->WarningDefs) ^ static_cast<uint>(site->ProjectConfig->TemplateAge);
+    if (Configuration::HuggleConfiguration->SystemConfig_TrimOldWarnings)
+        key.Config = ~key.Config;
+    HuggleParser_LevelCacheLock.lock();
+    QHash<HuggleParser_LevelKey, byte_ht>::const_iterator cached = HuggleParser_LevelCache.constFind(key);
+    if (cached != HuggleParser_LevelCache.constEnd())
+    {
+        byte_ht level = cached.value();
+        HuggleParser_LevelCacheHits++;
+        HuggleParser_LevelCacheLock.unlock();
+        return level;
     }
-    byte_ht level = 4;
-    while (level > 0)
+    HuggleParser_LevelCacheMisses++;
+    HuggleParser_LevelCacheLock.unlock();
+    byte_ht level = HuggleParser::ParseLevel(page, bt, site);
+    HuggleParser_LevelCacheLock.lock();
+    // the key contains a date, so that old entries are never hit again once the day changes, we just flush them all
+    if (HuggleParser_LevelCache.count() >= HUGGLE_PARSER_LEVEL_CACHE_SIZE)
+        HuggleParser_LevelCache.clear();
+    HuggleParser_LevelCache.insert(key, level);
+    HuggleParser_LevelCacheLock.unlock();
+    return level;
+}
+
+void HuggleParser::ClearLevelCache()
+{
+    HuggleParser_LevelCacheLock.lock();
+    HuggleParser_LevelCache.clear();
+    HuggleParser_LevelCacheLock.unlock();
+}
+
+void HuggleParser::ReleaseSite(WikiSite *site)
+{
+    HuggleParser_LevelCacheLock.lock();
+    HuggleParser_WarningMatchers.remove(site);
+    HuggleParser_WarningMatchersConfig.remove(site);
+    QHash<HuggleParser_LevelKey, byte_ht>::iterator i = HuggleParser_LevelCache.begin();
+    while (i != HuggleParser_LevelCache.end())
     {
-        foreach (QString df, site->ProjectConfig->WarningDefs)
-        {
-            if (HuggleParser::GetKeyFromSSItem(df).toInt() == level && page.contains(HuggleParser::GetValueFromSSItem(df)))
-            {
-                return level;
-            }
-        }
-        level--;
+        if (i.key().Site == site)
+            i = HuggleParser_LevelCache.erase(i);
+        else
+            ++i;
     }
-    return 0;
+    HuggleParser_LevelCacheLock.unlock();
+}
+
+qint64 HuggleParser::GetLevelCacheHits()
+{
+    return HuggleParser_LevelCacheHits;
+}
+
+qint64 HuggleParser::GetLevelCacheMisses()
+{
+    return HuggleParser_LevelCacheMisses;
 }
 
 QStringList HuggleParser::ConfigurationParse_QL(const QString &key, const QString &content, bool CS)
@@ -528,6 +669,7 @@ QList<HuggleQueueFilter*> HuggleParser::ConfigurationParseQueueList(QString cont
             filter->setIgnoreSelf(HuggleQueueFilterMatchIgnore);
             filter->setIgnore_UserSpace(HuggleQueueFilterMatchIgnore);
             filter->setIgnoreWL(HuggleQueueFilterMatchIgnore);
+            filter->setIgnoreBadRange(HuggleQueueFilterMatchIgnore);
             ReturnValue.append(filter);
             filter->ProjectSpecific = locked;
             QString name = text.trimmed();
@@ -609,6 +751,11 @@ QList<HuggleQueueFilter*> HuggleParser::ConfigurationParseQueueList(QString cont
                 {
                     filter->setIgnoreWatched(F2B(val));
                 }
+                if (key == "filter-bad-range")
+                {
+                    filter->setIgnoreBadRange(F2B(val));
+                    continue;
+                }
                 if (key == "nsfilter-user")
                 {
                     filter->setIgnore_UserSpace(F2B(val));
@@ -1094,6 +1241,7 @@ QList<HuggleQueueFilter *> HuggleParser::ConfigurationParseQueueList_YAML(YAML::
         filter->setIgnoreSelf(HuggleQueueFilterMatchIgnore);
         filter->setIgnore_UserSpace(HuggleQueueFilterMatchIgnore);
         filter->setIgnoreWL(HuggleQueueFilterMatchIgnore);
+        filter->setIgnoreBadRange(HuggleQueueFilterMatchIgnore);
         ReturnValue.append(filter);
         foreach (QString key, queue_data.keys())
         {
@@ -1157,6 +1305,11 @@ QList<HuggleQueueFilter *> HuggleParser::ConfigurationParseQueueList_YAML(YAML::
             {
                 filter->setIgnoreWatched(F2B(val));
             }
+            if (key == "filter-bad-range")
+            {
+                filter->setIgnoreBadRange(F2B(val));
+                continue;
+            }
             if (key == "nsfilter-user")
             {
                 filter->setIgnore_UserSpace(F2B(val));
@@ -115,10 +115,25 @@ namespace Huggle
         HUGGLE_EX_CORE QString GetKeyFromSSItem(QString item);
         /*!
          * \brief Process content of talk page in order to figure which user level they have
+         *
+         * Results are cached by site, content of talk page and date, so that repeated calls for
+         * same talk page don't need to parse it again
          * \param page The content of talk page
          * \return Level
          */
-        HUGGLE_EX_CORE byte_ht GetLevel(QString page, QDate bt, Huggle::WikiSite *site);
+        HUGGLE_EX_CORE byte_ht GetLevel(const QString &page, QDate bt, Huggle::WikiSite *site);
+        /*!
+         * \brief Same as GetLevel but always parses the talk page and doesn't use the cache
+         *
+         * The page is read once, warning templates of site are searched by a precompiled multi pattern matcher
+         */
+        HUGGLE_EX_CORE byte_ht ParseLevel(const QString &text, QDate bt, Huggle::WikiSite *site);
+        //! Remove all cached results of GetLevel
+        HUGGLE_EX_CORE void ClearLevelCache();
+        //! Remove cached results and warning matcher of a site that is being deleted
+        HUGGLE_EX_CORE void ReleaseSite(Huggle::WikiSite *site);
+        HUGGLE_EX_CORE qint64 GetLevelCacheHits();
+        HUGGLE_EX_CORE qint64 GetLevelCacheMisses();
     }
 }
 
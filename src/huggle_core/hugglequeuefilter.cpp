@@ -12,16 +12,23 @@
 #include "hugglequeuefilter.hpp"
 #include "exception.hpp"
 #include "generic.hpp"
+#include "stringpool.hpp"
 #include "syslog.hpp"
 #include "wikiedit.hpp"
 #include "wikiuser.hpp"
 #include "wikisite.hpp"
 #include "wikipage.hpp"
+#include <QElapsedTimer>
+#include <QFile>
 
 using namespace Huggle;
 
 HuggleQueueFilter *HuggleQueueFilter::DefaultFilter = new HuggleQueueFilter();
 QHash<WikiSite*,QList<HuggleQueueFilter*>*> HuggleQueueFilter::Filters;
+QAtomicInteger<qint64> HuggleQueueFilter::EarlyRejections(0);
+QAtomicInteger<qint64> HuggleQueueFilter::LateRejections(0);
+QAtomicInteger<qint64> HuggleQueueFilter::RequestsAvoided(0);
+QAtomicInt HuggleQueueFilter::propertiesGeneration(0);
 
 void HuggleQueueFilter::Delete()
 {
@@ -57,7 +64,14 @@ HuggleQueueFilter *HuggleQueueFilter::GetFilter(const QString& filter_name, Wiki
 void HuggleQueueFilter::SetFilters()
 {
     foreach (WikiSite *site, hcfg->Projects)
+    {
         site->CurrentFilter = HuggleQueueFilter::GetFilter(site->GetUserConfig()->QueueID, site);
+        if (Filters.contains(site))
+        {
+            foreach (HuggleQueueFilter *filter, *Filters[site])
+                filter->Intern(site->Strings);
+        }
+    }
 }
 
 HuggleQueueFilter::HuggleQueueFilter()
@@ -75,6 +89,59 @@ HuggleQueueFilter::HuggleQueueFilter()
     this->TalkPage = HuggleQueueFilterMatchExclude;
     this->UserSpace = HuggleQueueFilterMatchIgnore;
     this->Watched = HuggleQueueFilterMatchIgnore;
+    this->BadRange = HuggleQueueFilterMatchIgnore;
+    this->compile();
+}
+
+bool HuggleQueueFilter::NeedsPageInfo() const
+{
+    if (!this->ignoreCategorySet.isEmpty() || !this->requireCategorySet.isEmpty())
+        return true;
+    return ((this->requireMask | this->excludeMask) & HuggleQueueFilterPropertyWatched) != 0;
+}
+
+void HuggleQueueFilter::InvalidateProperties()
+{
+    HuggleQueueFilter::propertiesGeneration.fetchAndAddRelaxed(1);
+}
+
+quint32 HuggleQueueFilter::GetProperties(WikiEdit *edit)
+{
+    // generation is read before the properties are computed, so that a change made in meantime invalidates them again
+    int generation = HuggleQueueFilter::propertiesGeneration.load();
+    if (edit->FilterPropertiesStatus == static_cast<int>(edit->Status) && edit->FilterPropertiesGeneration == generation)
+        return edit->FilterProperties;
+    quint32 properties = 0;
+    if (edit->IsMinor)
+        properties |= HuggleQueueFilterPropertyMinor;
+    if (edit->IsRevert)
+        properties |= HuggleQueueFilterPropertyReverts;
+    if (edit->Bot)
+        properties |= HuggleQueueFilterPropertyBots;
+    if (edit->NewPage)
+        properties |= HuggleQueueFilterPropertyNewPages;
+    if (edit->TrustworthEdit)
+        properties |= HuggleQueueFilterPropertyFriends;
+    if (edit->User->IsWhitelisted())
+        properties |= HuggleQueueFilterPropertyWL;
+    if (edit->User->IsIP())
+    {
+        properties |= HuggleQueueFilterPropertyIP;
+        if (edit->User->IsInBadRange())
+            properties |= HuggleQueueFilterPropertyBadRange;
+    }
+    if (QString::compare(edit->User->Username, hcfg->SystemConfig_UserName, Qt::CaseInsensitive) == 0)
+        properties |= HuggleQueueFilterPropertySelf;
+    if (edit->Page->GetNS()->GetCanonicalName() == "User")
+        properties |= HuggleQueueFilterPropertyUserSpace;
+    if (edit->Page->IsTalk())
+        properties |= HuggleQueueFilterPropertyTalkPage;
+    if (edit->IsPostProcessed() && edit->Page->IsWatched())
+        properties |= HuggleQueueFilterPropertyWatched;
+    edit->FilterProperties = properties;
+    edit->FilterPropertiesStatus = static_cast<int>(edit->Status);
+    edit->FilterPropertiesGeneration = generation;
+    return properties;
 }
 
 bool HuggleQueueFilter::Matches(WikiEdit *edit)
@@ -82,133 +149,280 @@ bool HuggleQueueFilter::Matches(WikiEdit *edit)
     if (edit == nullptr)
         throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
 
-    if (this->IgnoresNS(edit->Page->GetNS()->GetID()))
-        return false;
+    return this->match(edit, edit->IsPostProcessed());
+}
 
-    if (this->UserSpace != HuggleQueueFilterMatchIgnore)
-    {
-        if (this->UserSpace == HuggleQueueFilterMatchExclude && edit->Page->GetNS()->GetCanonicalName() == "User")
-            return false;
-        if (this->UserSpace == HuggleQueueFilterMatchRequire && edit->Page->GetNS()->GetCanonicalName() != "User")
-            return false;
-    }
-    if (this->TalkPage != HuggleQueueFilterMatchIgnore)
+bool HuggleQueueFilter::MatchesBeforePostProcessing(WikiEdit *edit)
+{
+    if (edit == nullptr)
+        throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
+
+    if (this->match(edit, false))
+        return true;
+    HuggleQueueFilter::EarlyRejections.fetchAndAddRelaxed(1);
+    HuggleQueueFilter::RequestsAvoided.fetchAndAddRelaxed(edit->GetPostProcessQueryCount());
+    return false;
+}
+
+bool HuggleQueueFilter::MatchesAfterPostProcessing(WikiEdit *edit)
+{
+    if (edit == nullptr)
+        throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
+
+    if (this->match(edit, edit->IsPostProcessed()))
+        return true;
+    HuggleQueueFilter::LateRejections.fetchAndAddRelaxed(1);
+    return false;
+}
+
+bool HuggleQueueFilter::match(WikiEdit *edit, bool post_processed)
+{
+    if (!hcfg->SystemConfig_FilterProfiling)
+        return this->evaluate(edit, post_processed, nullptr);
+
+    HuggleQueueFilter_Counter profile[HuggleQueueFilterCriterionCount];
+    bool result = this->evaluate(edit, post_processed, profile);
+    this->countersLock.lock();
+    int criterion = 0;
+    while (criterion < HuggleQueueFilterCriterionCount)
     {
-        if (this->TalkPage == HuggleQueueFilterMatchExclude && edit->Page->IsTalk())
-            return false;
-        if (this->TalkPage == HuggleQueueFilterMatchRequire && !edit->Page->IsTalk())
-            return false;
+        this->counters[criterion].Evaluations += profile[criterion].Evaluations;
+        this->counters[criterion].Rejections += profile[criterion].Rejections;
+        this->counters[criterion].RejectionsAfterPostProcessing += profile[criterion].RejectionsAfterPostProcessing;
+        this->counters[criterion].Nanoseconds += profile[criterion].Nanoseconds;
+        criterion++;
     }
-    int i = 0;
-    while (i < Configuration::HuggleConfiguration->ProjectConfig->IgnorePatterns.count())
+    this->countersLock.unlock();
+    return result;
+}
+
+//! Store the result of one criterion into profile, returns true if the edit was rejected
+static inline bool HuggleQueueFilter_Record(HuggleQueueFilter_Counter *profile, int criterion, QElapsedTimer &timer, bool rejected,
+                                            bool post_processed)
+{
+    if (profile == nullptr)
+        return rejected;
+    profile[criterion].Evaluations++;
+    profile[criterion].Nanoseconds += timer.nsecsElapsed();
+    if (rejected)
     {
-        if (edit->Page->PageName.contains(Configuration::HuggleConfiguration->ProjectConfig->IgnorePatterns.at(i)))
-            return false;
-        i++;
+        profile[criterion].Rejections++;
+        if (post_processed)
+            profile[criterion].RejectionsAfterPostProcessing++;
     }
-    if (Configuration::HuggleConfiguration->ProjectConfig->Ignores.contains(edit->Page->PageName))
+    timer.start();
+    return rejected;
+}
+
+bool HuggleQueueFilter::evaluate(WikiEdit *edit, bool post_processed, HuggleQueueFilter_Counter *profile)
+{
+    QElapsedTimer timer;
+    if (profile)
+        timer.start();
+
+    if (HuggleQueueFilter_Record(profile, HuggleQueueFilterCriterionNamespace, timer, this->IgnoresNS(edit->Page->GetNS()->GetID()),
+                                 post_processed))
         return false;
-    if (this->WL != HuggleQueueFilterMatchIgnore)
-    {
-        if (this->WL == HuggleQueueFilterMatchRequire && !edit->User->IsWhitelisted())
-            return false;
-        if (this->WL == HuggleQueueFilterMatchExclude && edit->User->IsWhitelisted())
-            return false;
-    }
-    if (this->Friends != HuggleQueueFilterMatchIgnore)
-    {
-        if (this->Friends == HuggleQueueFilterMatchExclude && edit->TrustworthEdit)
-            return false;
-        if (this->Friends == HuggleQueueFilterMatchRequire && !edit->TrustworthEdit)
-            return false;
-    }
-    if (this->IP != HuggleQueueFilterMatchIgnore)
-    {
-        if (this->IP == HuggleQueueFilterMatchExclude && edit->User->IsIP())
-            return false;
-        if (this->IP == HuggleQueueFilterMatchRequire && !edit->User->IsIP())
-            return false;
-    }
-    if (this->Minor != HuggleQueueFilterMatchIgnore)
+
+    quint32 properties = HuggleQueueFilter::GetProperties(edit);
+    quint32 require = this->requireMask;
+    quint32 exclude = this->excludeMask;
+    if (!post_processed || !hcfg->SystemConfig_CatScansAndWatched)
     {
-        if (this->Minor == HuggleQueueFilterMatchExclude && edit->IsMinor)
-            return false;
-        if (this->Minor == HuggleQueueFilterMatchRequire && !edit->IsMinor)
-            return false;
+        // we don't know yet if page is watched
+        require &= ~HuggleQueueFilterPropertyWatched;
+        exclude &= ~HuggleQueueFilterPropertyWatched;
     }
-    if (this->Reverts != HuggleQueueFilterMatchIgnore)
+    // properties that are required but missing, or present but excluded
+    quint32 failed = ((properties & require) ^ require) | (properties & exclude);
+    if (profile)
     {
-        if (this->Reverts == HuggleQueueFilterMatchExclude && edit->IsRevert)
-            return false;
-        if (this->Reverts == HuggleQueueFilterMatchRequire && !edit->IsRevert)
-            return false;
+        int bit = 0;
+        while ((1u << bit) <= HuggleQueueFilterPropertyBadRange)
+        {
+            quint32 property = 1u << bit;
+            if ((require | exclude) & property)
+            {
+                HuggleQueueFilter_Counter &counter = profile[HuggleQueueFilterCriterionMinor + bit];
+                counter.Evaluations++;
+                if (failed & property)
+                {
+                    counter.Rejections++;
+                    if (post_processed)
+                        counter.RejectionsAfterPostProcessing++;
+                }
+            }
+            bit++;
+        }
     }
-    if (this->NewPages != HuggleQueueFilterMatchIgnore)
+    if (HuggleQueueFilter_Record(profile, HuggleQueueFilterCriterionProperties, timer, failed != 0, post_processed))
+        return false;
+
+    ProjectConfiguration *project = Configuration::HuggleConfiguration->ProjectConfig;
+    if (HuggleQueueFilter_Record(profile, HuggleQueueFilterCriterionIgnoreList, timer, project->IgnoreSet.contains(edit->Page->PageName),
+                                 post_processed))
+        return false;
+    if (HuggleQueueFilter_Record(profile, HuggleQueueFilterCriterionIgnorePatterns, timer,
+                                 project->IgnorePatternMatcher.Contains(edit->Page->PageName), post_processed))
+        return false;
+
+    if (!post_processed)
+        return true;
+
+    if (hcfg->SystemConfig_CatScansAndWatched && (!this->ignoreCategorySet.isEmpty() || !this->requireCategorySet.isEmpty()))
     {
-        if (edit->NewPage && this->NewPages == HuggleQueueFilterMatchExclude)
-            return false;
-        if (this->NewPages == HuggleQueueFilterMatchRequire && !edit->NewPage)
+        bool rejected = false;
+        QSet<QString> categories = edit->Page->GetCategories().toSet();
+        foreach (QString cat, categories)
+        {
+            if (this->ignoreCategorySet.contains(cat))
+            {
+                rejected = true;
+                break;
+            }
+        }
+        // every required category must be present, page may list some category more than once
+        if (!rejected && categories.intersect(this->requireCategorySet).count() < this->requireCategorySet.count())
+            rejected = true;
+        if (HuggleQueueFilter_Record(profile, HuggleQueueFilterCriterionCategories, timer, rejected, post_processed))
             return false;
     }
-    if (this->Bots != HuggleQueueFilterMatchIgnore)
+
+    if (!this->ignoreTagSet.isEmpty() || !this->requireTagSet.isEmpty())
     {
-        if (edit->Bot && this->Bots == HuggleQueueFilterMatchExclude)
-            return false;
-        if (this->Bots == HuggleQueueFilterMatchRequire && !edit->Bot)
+        bool rejected = false;
+        QSet<QString> tags = edit->Tags.toSet();
+        foreach (QString tag, tags)
+        {
+            if (this->ignoreTagSet.contains(tag))
+            {
+                rejected = true;
+                break;
+            }
+        }
+        if (!rejected && tags.intersect(this->requireTagSet).count() < this->requireTagSet.count())
+            rejected = true;
+        if (HuggleQueueFilter_Record(profile, HuggleQueueFilterCriterionTags, timer, rejected, post_processed))
             return false;
     }
-    if (this->Self != HuggleQueueFilterMatchIgnore)
+    return true;
+}
+
+HuggleQueueFilter_Counter HuggleQueueFilter::GetCounter(int criterion)
+{
+    this->countersLock.lock();
+    HuggleQueueFilter_Counter counter = this->counters[criterion];
+    this->countersLock.unlock();
+    return counter;
+}
+
+void HuggleQueueFilter::ResetCounters()
+{
+    this->countersLock.lock();
+    int criterion = 0;
+    while (criterion < HuggleQueueFilterCriterionCount)
+        this->counters[criterion++] = HuggleQueueFilter_Counter();
+    this->countersLock.unlock();
+}
+
+QString HuggleQueueFilter::CriterionToString(int criterion)
+{
+    switch (criterion)
     {
-        if (this->Self == HuggleQueueFilterMatchExclude && edit->User->Username.toLower() == Configuration::HuggleConfiguration->SystemConfig_UserName.toLower())
-            return false;
-        if (this->Self == HuggleQueueFilterMatchRequire && edit->User->Username.toLower() == Configuration::HuggleConfiguration->SystemConfig_UserName.toLower())
-            return false;
+        case HuggleQueueFilterCriterionNamespace:
+            return "namespace";
+        case HuggleQueueFilterCriterionProperties:
+            return "properties";
+        case HuggleQueueFilterCriterionMinor:
+            return "minor";
+        case HuggleQueueFilterCriterionWL:
+            return "whitelisted";
+        case HuggleQueueFilterCriterionIP:
+            return "ip";
+        case HuggleQueueFilterCriterionReverts:
+            return "reverts";
+        case HuggleQueueFilterCriterionBots:
+            return "bots";
+        case HuggleQueueFilterCriterionNewPages:
+            return "new-pages";
+        case HuggleQueueFilterCriterionFriends:
+            return "friends";
+        case HuggleQueueFilterCriterionSelf:
+            return "self";
+        case HuggleQueueFilterCriterionUserSpace:
+            return "user-space";
+        case HuggleQueueFilterCriterionTalkPage:
+            return "talk";
+        case HuggleQueueFilterCriterionWatched:
+            return "watched";
+        case HuggleQueueFilterCriterionBadRange:
+            return "bad-range";
+        case HuggleQueueFilterCriterionIgnoreList:
+            return "ignore-list";
+        case HuggleQueueFilterCriterionIgnorePatterns:
+            return "ignore-patterns";
+        case HuggleQueueFilterCriterionCategories:
+            return "categories";
+        case HuggleQueueFilterCriterionTags:
+            return "tags";
     }
-    if (edit->IsPostProcessed())
+    return "unknown";
+}
+
+QStringList HuggleQueueFilter::GetStatistics()
+{
+    QStringList result;
+    foreach (WikiSite *site, HuggleQueueFilter::Filters.keys())
     {
-        if (hcfg->SystemConfig_CatScansAndWatched)
+        foreach (HuggleQueueFilter *filter, *HuggleQueueFilter::Filters[site])
         {
-            if (this->Watched != HuggleQueueFilterMatchIgnore)
-            {
-                if (this->Watched == HuggleQueueFilterMatchExclude && edit->Page->IsWatched())
-                    return false;
-                if (this->Watched == HuggleQueueFilterMatchRequire && !edit->Page->IsWatched())
-                    return false;
-            }
-
-            if (!edit->Page->GetCategories().isEmpty() && this->IgnoreCategories.count())
+            HuggleQueueFilter_Counter total = filter->GetCounter(HuggleQueueFilterCriterionNamespace);
+            if (total.Evaluations == 0)
+                continue;
+            result << site->Name + " / " + filter->QueueName + ": " + QString::number(total.Evaluations) + " edits";
+            int criterion = 0;
+            while (criterion < HuggleQueueFilterCriterionCount)
             {
-                foreach (QString cat, edit->Page->GetCategories())
+                HuggleQueueFilter_Counter counter = filter->GetCounter(criterion);
+                if (counter.Evaluations > 0)
                 {
-                    if (this->IgnoreCategories.contains(cat))
-                        return false;
+                    QString line = "  " + HuggleQueueFilter::CriterionToString(criterion) + ": " + QString::number(counter.Evaluations) +
+                                   " evaluations, " + QString::number(counter.Rejections) + " rejected (" +
+                                   QString::number(counter.RejectionsAfterPostProcessing) + " after post processing)";
+                    if (counter.Nanoseconds > 0)
+                        line += ", " + QString::number(counter.Nanoseconds / counter.Evaluations) + " ns per evaluation";
+                    result << line;
                 }
-            }
-
-            foreach (QString rc, this->RequireCategories)
-            {
-                if (!edit->Page->GetCategories().contains(rc))
-                    return false;
+                criterion++;
             }
         }
+    }
+    return result;
+}
 
-        if (!edit->Tags.isEmpty() && this->IgnoreTags.count())
-        {
-            foreach (QString tag, edit->Tags)
-            {
-                if (this->IgnoreTags.contains(tag))
-                    return false;
-            }
-        }
-        if (this->RequireTags.count())
+bool HuggleQueueFilter::DumpStatistics(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    file.write("site\tfilter\tcriterion\tevaluations\trejections\trejections_after_postprocessing\tnanoseconds\n");
+    foreach (WikiSite *site, HuggleQueueFilter::Filters.keys())
+    {
+        foreach (HuggleQueueFilter *filter, *HuggleQueueFilter::Filters[site])
         {
-            foreach (QString tx, this->RequireTags)
+            int criterion = 0;
+            while (criterion < HuggleQueueFilterCriterionCount)
             {
-                if (!edit->Tags.contains(tx))
-                    return false;
+                HuggleQueueFilter_Counter counter = filter->GetCounter(criterion);
+                QString line = site->Name + "\t" + filter->QueueName + "\t" + HuggleQueueFilter::CriterionToString(criterion) + "\t" +
+                               QString::number(counter.Evaluations) + "\t" + QString::number(counter.Rejections) + "\t" +
+                               QString::number(counter.RejectionsAfterPostProcessing) + "\t" + QString::number(counter.Nanoseconds) + "\n";
+                file.write(line.toUtf8());
+                criterion++;
             }
         }
     }
+    file.close();
     return true;
 }
 
@@ -235,11 +449,13 @@ QString HuggleQueueFilter::GetRequiredTags_CommaSeparated() const
 void HuggleQueueFilter::SetIgnoredTags_CommaSeparated(const QString &list)
 {
     this->IgnoreTags = Generic::CSV2QStringList(list);
+    this->ignoreTagSet = this->IgnoreTags.toSet();
 }
 
 void HuggleQueueFilter::SetRequiredTags_CommaSeparated(const QString &list)
 {
     this->RequireTags = Generic::CSV2QStringList(list);
+    this->requireTagSet = this->RequireTags.toSet();
 }
 
 QString HuggleQueueFilter::GetIgnoredCategories_CommaSeparated() const
@@ -265,11 +481,25 @@ QString HuggleQueueFilter::GetRequiredCategories_CommaSeparated() const
 void HuggleQueueFilter::SetIgnoredCategories_CommaSeparated(const QString &list)
 {
     this->IgnoreCategories = Generic::CSV2QStringList(list);
+    this->ignoreCategorySet = this->IgnoreCategories.toSet();
 }
 
 void HuggleQueueFilter::SetRequiredCategories_CommaSeparated(const QString &list)
 {
     this->RequireCategories = Generic::CSV2QStringList(list);
+    this->requireCategorySet = this->RequireCategories.toSet();
+}
+
+void HuggleQueueFilter::Intern(StringPool *pool)
+{
+    this->IgnoreTags = pool->Intern(this->IgnoreTags);
+    this->RequireTags = pool->Intern(this->RequireTags);
+    this->IgnoreCategories = pool->Intern(this->IgnoreCategories);
+    this->RequireCategories = pool->Intern(this->RequireCategories);
+    this->ignoreTagSet = this->IgnoreTags.toSet();
+    this->requireTagSet = this->RequireTags.toSet();
+    this->ignoreCategorySet = this->IgnoreCategories.toSet();
+    this->requireCategorySet = this->RequireCategories.toSet();
 }
 
 bool HuggleQueueFilter::IgnoresNS(int ns)
@@ -279,3 +509,21 @@ bool HuggleQueueFilter::IgnoresNS(int ns)
 
     return false;
 }
+
+void HuggleQueueFilter::compile()
+{
+    this->requireMask = 0;
+    this->excludeMask = 0;
+    this->setMask(HuggleQueueFilterPropertyMinor, this->Minor);
+    this->setMask(HuggleQueueFilterPropertyWL, this->WL);
+    this->setMask(HuggleQueueFilterPropertyIP, this->IP);
+    this->setMask(HuggleQueueFilterPropertyReverts, this->Reverts);
+    this->setMask(HuggleQueueFilterPropertyBots, this->Bots);
+    this->setMask(HuggleQueueFilterPropertyNewPages, this->NewPages);
+    this->setMask(HuggleQueueFilterPropertyFriends, this->Friends);
+    this->setMask(HuggleQueueFilterPropertySelf, this->Self);
+    this->setMask(HuggleQueueFilterPropertyUserSpace, this->UserSpace);
+    this->setMask(HuggleQueueFilterPropertyTalkPage, this->TalkPage);
+    this->setMask(HuggleQueueFilterPropertyWatched, this->Watched);
+    this->setMask(HuggleQueueFilterPropertyBadRange, this->BadRange);
+}
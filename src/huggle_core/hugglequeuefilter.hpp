@@ -15,8 +15,12 @@
 
 #include <QStringList>
 #include <QString>
+#include <QAtomicInt>
+#include <QAtomicInteger>
 #include <QHash>
 #include <QList>
+#include <QMutex>
+#include <QSet>
 //#include "mediawikiobject.hpp"
 
 namespace Huggle
@@ -31,6 +35,62 @@ namespace Huggle
         HuggleQueueFilterMatchExclude
     };
 
+    //! Properties of edit that are matched by filter, every property is a bit in mask
+    enum HuggleQueueFilterProperty
+    {
+        HuggleQueueFilterPropertyMinor = 1 << 0,
+        HuggleQueueFilterPropertyWL = 1 << 1,
+        HuggleQueueFilterPropertyIP = 1 << 2,
+        HuggleQueueFilterPropertyReverts = 1 << 3,
+        HuggleQueueFilterPropertyBots = 1 << 4,
+        HuggleQueueFilterPropertyNewPages = 1 << 5,
+        HuggleQueueFilterPropertyFriends = 1 << 6,
+        HuggleQueueFilterPropertySelf = 1 << 7,
+        HuggleQueueFilterPropertyUserSpace = 1 << 8,
+        HuggleQueueFilterPropertyTalkPage = 1 << 9,
+        //! Known only for post processed edits
+        HuggleQueueFilterPropertyWatched = 1 << 10,
+        HuggleQueueFilterPropertyBadRange = 1 << 11
+    };
+
+    //! Checks done by filter, used for profiling
+    enum HuggleQueueFilterCriterion
+    {
+        HuggleQueueFilterCriterionNamespace,
+        //! Computing and matching of all properties, the properties have their own counters but no time
+        HuggleQueueFilterCriterionProperties,
+        //! Properties in the same order as HuggleQueueFilterProperty
+        HuggleQueueFilterCriterionMinor,
+        HuggleQueueFilterCriterionWL,
+        HuggleQueueFilterCriterionIP,
+        HuggleQueueFilterCriterionReverts,
+        HuggleQueueFilterCriterionBots,
+        HuggleQueueFilterCriterionNewPages,
+        HuggleQueueFilterCriterionFriends,
+        HuggleQueueFilterCriterionSelf,
+        HuggleQueueFilterCriterionUserSpace,
+        HuggleQueueFilterCriterionTalkPage,
+        HuggleQueueFilterCriterionWatched,
+        HuggleQueueFilterCriterionBadRange,
+        HuggleQueueFilterCriterionIgnoreList,
+        HuggleQueueFilterCriterionIgnorePatterns,
+        HuggleQueueFilterCriterionCategories,
+        HuggleQueueFilterCriterionTags,
+        HuggleQueueFilterCriterionCount
+    };
+
+    //! Counters of one criterion of filter, they are only updated when SystemConfig_FilterProfiling is enabled
+    class HuggleQueueFilter_Counter
+    {
+        public:
+            qint64 Evaluations = 0;
+            qint64 Rejections = 0;
+            //! Rejections of edits that were already post processed, so the queries for them were not needed
+            qint64 RejectionsAfterPostProcessing = 0;
+            qint64 Nanoseconds = 0;
+    };
+
+    class StringPool;
     class WikiEdit;
     class WikiSite;
 
@@ -41,6 +101,25 @@ namespace Huggle
             static void Delete();
             static HuggleQueueFilter* GetFilter(const QString& filter_name, WikiSite *site);
             static void SetFilters();
+            /*!
+             * \brief Returns mask of HuggleQueueFilterProperty flags that are true for this edit
+             *  The mask is cached in edit and computed again only when the status of edit changes or
+             *  when InvalidateProperties was called since then
+             */
+            static quint32 GetProperties(WikiEdit *edit);
+            //! Make properties cached in all edits outdated, call this when whitelist, reputation of IP ranges or watched pages change
+            static void InvalidateProperties();
+            static QString CriterionToString(int criterion);
+            //! Counters of all filters in human readable form, one line per item
+            static QStringList GetStatistics();
+            //! Write counters of all filters to a tab separated file
+            static bool DumpStatistics(const QString &path);
+            //! Number of edits that were rejected before they were post processed, feed threads increment it too
+            static QAtomicInteger<qint64> EarlyRejections;
+            //! Number of edits that were rejected only after they were post processed
+            static QAtomicInteger<qint64> LateRejections;
+            //! Estimated number of API queries that were not needed thanks to early rejections
+            static QAtomicInteger<qint64> RequestsAvoided;
             static QHash<WikiSite*,QList<HuggleQueueFilter*>*> Filters;
             static HuggleQueueFilter* DefaultFilter;
 
@@ -50,6 +129,18 @@ namespace Huggle
             //! Returns true if edit is ok for this filter (that means it is not filtered out)
             //! if this is false the edit should not be processed later
             bool Matches(WikiEdit *edit);
+            /*!
+             * \brief MatchesBeforePostProcessing checks only criteria that are answerable from data provided by feed
+             *
+             * Watched status, categories and tags are deferred until the edit is post processed, so an edit
+             * that passes this check may still be rejected by Matches later. Rejected edits are counted in
+             * EarlyRejections and RequestsAvoided.
+             */
+            bool MatchesBeforePostProcessing(WikiEdit *edit);
+            //! Same as Matches, but rejections are counted in LateRejections, use this for edits that were post processed by feed
+            bool MatchesAfterPostProcessing(WikiEdit *edit);
+            HuggleQueueFilter_Counter GetCounter(int criterion);
+            void ResetCounters();
             //! Information if this filter is matching minor edits or not
             HuggleQueueFilterMatch getIgnoreMinor() const;
             //! Changes if this filter is matching minor edits or not
@@ -88,11 +179,17 @@ namespace Huggle
             void setIgnore_UserSpace(HuggleQueueFilterMatch value);
             HuggleQueueFilterMatch getIgnoreWatched() const;
             void setIgnoreWatched(HuggleQueueFilterMatch value);
+            //! Information if this filter is matching edits of anonymous users from IP ranges with bad reputation
+            HuggleQueueFilterMatch getIgnoreBadRange() const;
+            //! Changes if this filter is matching edits of anonymous users from IP ranges with bad reputation
+            void setIgnoreBadRange(HuggleQueueFilterMatch value);
             QString GetIgnoredTags_CommaSeparated() const;
             QString GetRequiredTags_CommaSeparated() const;
             void SetIgnoredTags_CommaSeparated(const QString &list);
             void SetRequiredTags_CommaSeparated(const QString &list);
             bool IgnoresNS(int ns);
+            //! Returns true if filter uses categories or watched status of page, which are only known after post processing
+            bool NeedsPageInfo() const;
             //! Name of this queue, must be unique
             QString QueueName;
             bool ProjectSpecific;
@@ -101,11 +198,32 @@ namespace Huggle
             QString GetRequiredCategories_CommaSeparated() const;
             void SetIgnoredCategories_CommaSeparated(const QString &list);
             void SetRequiredCategories_CommaSeparated(const QString &list);
+            //! Replace the tags and categories with copies that are shared through the string pool of a site
+            void Intern(StringPool *pool);
         private:
+            //! Matches the edit, if profile is not null counters of every criterion are stored in it
+            bool evaluate(WikiEdit *edit, bool post_processed, HuggleQueueFilter_Counter *profile);
+            bool match(WikiEdit *edit, bool post_processed);
+            //! Recreate the masks from all attributes of filter
+            void compile();
+            //! Update the masks when one attribute is changed
+            void setMask(quint32 property, HuggleQueueFilterMatch value);
+            //! Incremented by InvalidateProperties, properties cached in edit are valid only in generation they were computed in
+            static QAtomicInt propertiesGeneration;
             QStringList IgnoreTags;
             QStringList RequireTags;
             QStringList IgnoreCategories;
             QStringList RequireCategories;
+            QSet<QString> ignoreTagSet;
+            QSet<QString> requireTagSet;
+            QSet<QString> ignoreCategorySet;
+            QSet<QString> requireCategorySet;
+            //! Properties that edit must have
+            quint32 requireMask = 0;
+            //! Properties that edit must not have
+            quint32 excludeMask = 0;
+            HuggleQueueFilter_Counter counters[HuggleQueueFilterCriterionCount];
+            QMutex countersLock;
             HuggleQueueFilterMatch Minor;
             HuggleQueueFilterMatch WL;
             HuggleQueueFilterMatch IP;
@@ -117,6 +235,7 @@ namespace Huggle
             HuggleQueueFilterMatch UserSpace;
             HuggleQueueFilterMatch TalkPage;
             HuggleQueueFilterMatch Watched;
+            HuggleQueueFilterMatch BadRange;
     };
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreMinor() const
@@ -127,6 +246,7 @@ namespace Huggle
     inline void HuggleQueueFilter::setIgnoreMinor(HuggleQueueFilterMatch value)
     {
         this->Minor = value;
+        this->setMask(HuggleQueueFilterPropertyMinor, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreWL() const
@@ -137,6 +257,7 @@ namespace Huggle
     inline void HuggleQueueFilter::setIgnoreWL(HuggleQueueFilterMatch value)
     {
         this->WL = value;
+        this->setMask(HuggleQueueFilterPropertyWL, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreIP() const
@@ -147,6 +268,7 @@ namespace Huggle
     inline void HuggleQueueFilter::setIgnoreIP(HuggleQueueFilterMatch value)
     {
         this->IP = value;
+        this->setMask(HuggleQueueFilterPropertyIP, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreBots() const
@@ -157,6 +279,7 @@ namespace Huggle
     inline void HuggleQueueFilter::setIgnoreBots(HuggleQueueFilterMatch value)
     {
         this->Bots = value;
+        this->setMask(HuggleQueueFilterPropertyBots, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreNP() const
@@ -167,6 +290,7 @@ namespace Huggle
     inline void HuggleQueueFilter::setIgnoreNP(HuggleQueueFilterMatch value)
     {
         this->NewPages = value;
+        this->setMask(HuggleQueueFilterPropertyNewPages, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreFriends() const
@@ -182,6 +306,7 @@ namespace Huggle
     inline void HuggleQueueFilter::setIgnoreReverts(HuggleQueueFilterMatch value)
     {
         this->Reverts = value;
+        this->setMask(HuggleQueueFilterPropertyReverts, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnore_UserSpace() const
@@ -192,11 +317,13 @@ namespace Huggle
     inline void HuggleQueueFilter::setIgnore_UserSpace(HuggleQueueFilterMatch value)
     {
         this->UserSpace = value;
+        this->setMask(HuggleQueueFilterPropertyUserSpace, value);
     }
 
     inline void HuggleQueueFilter::setIgnoreFriends(HuggleQueueFilterMatch value)
     {
         this->Friends = value;
+        this->setMask(HuggleQueueFilterPropertyFriends, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreSelf() const
@@ -207,6 +334,7 @@ namespace Huggle
     inline void HuggleQueueFilter::setIgnoreTalk(HuggleQueueFilterMatch value)
     {
         this->TalkPage = value;
+        this->setMask(HuggleQueueFilterPropertyTalkPage, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreTalk() const
@@ -217,6 +345,7 @@ namespace Huggle
     inline void HuggleQueueFilter::setIgnoreSelf(HuggleQueueFilterMatch value)
     {
         this->Self = value;
+        this->setMask(HuggleQueueFilterPropertySelf, value);
     }
 
     inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreWatched() const
@@ -227,6 +356,28 @@ namespace Huggle
     inline void HuggleQueueFilter::setIgnoreWatched(HuggleQueueFilterMatch value)
     {
         this->Watched = value;
+        this->setMask(HuggleQueueFilterPropertyWatched, value);
+    }
+
+    inline HuggleQueueFilterMatch HuggleQueueFilter::getIgnoreBadRange() const
+    {
+        return this->BadRange;
+    }
+
+    inline void HuggleQueueFilter::setIgnoreBadRange(HuggleQueueFilterMatch value)
+    {
+        this->BadRange = value;
+        this->setMask(HuggleQueueFilterPropertyBadRange, value);
+    }
+
+    inline void HuggleQueueFilter::setMask(quint32 property, HuggleQueueFilterMatch value)
+    {
+        this->requireMask &= ~property;
+        this->excludeMask &= ~property;
+        if (value == HuggleQueueFilterMatchRequire)
+            this->requireMask |= property;
+        else if (value == HuggleQueueFilterMatchExclude)
+            this->excludeMask |= property;
     }
 
     inline bool HuggleQueueFilter::IsDefault() const
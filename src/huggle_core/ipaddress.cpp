@@ -0,0 +1,169 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#include "ipaddress.hpp"
+#include <cstring>
+using namespace Huggle;
+
+static inline int IPAddress_HexValue(ushort c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static bool IPAddress_ParseIPv4(const QChar *data, int length, quint8 *bytes)
+{
+    int octet = 0;
+    int digits = 0;
+    int value = 0;
+    int i = 0;
+    while (i < length)
+    {
+        ushort c = data[i++].unicode();
+        if (c >= '0' && c <= '9')
+        {
+            if (++digits > 3)
+                return false;
+            value = value * 10 + (c - '0');
+            if (value > 255)
+                return false;
+        } else if (c == '.')
+        {
+            if (digits == 0 || octet == 3)
+                return false;
+            bytes[octet++] = static_cast<quint8>(value);
+            value = 0;
+            digits = 0;
+        } else
+        {
+            return false;
+        }
+    }
+    if (digits == 0 || octet != 3)
+        return false;
+    bytes[3] = static_cast<quint8>(value);
+    return true;
+}
+
+static bool IPAddress_ParseIPv6(const QChar *data, int length, quint8 *bytes)
+{
+    quint16 groups[8];
+    int count = 0;
+    // index of group where :: was used, or -1
+    int compressed = -1;
+    int i = 0;
+    if (length < 2)
+        return false;
+    if (data[0] == ':')
+    {
+        // only :: may be on beginning
+        if (data[1] != ':')
+            return false;
+        compressed = 0;
+        i = 2;
+    }
+    while (i < length)
+    {
+        int start = i;
+        int value = 0;
+        int hex;
+        while (i < length && i - start < 5 && (hex = IPAddress_HexValue(data[i].unicode())) >= 0)
+        {
+            value = value * 16 + hex;
+            i++;
+        }
+        if (i < length && data[i] == '.')
+        {
+            // dotted IPv4 in last 32 bits, it must be the end of the address
+            quint8 ipv4[4];
+            if (count > 6 || !IPAddress_ParseIPv4(data + start, length - start, ipv4))
+                return false;
+            groups[count++] = static_cast<quint16>((ipv4[0] << 8) | ipv4[1]);
+            groups[count++] = static_cast<quint16>((ipv4[2] << 8) | ipv4[3]);
+            break;
+        }
+        int digits = i - start;
+        if (digits == 0 || digits > 4 || count == 8)
+            return false;
+        groups[count++] = static_cast<quint16>(value);
+        if (i == length)
+            break;
+        if (data[i++] != ':')
+            return false;
+        if (i == length)
+        {
+            // address must not end with single colon
+            return false;
+        }
+        if (data[i] == ':')
+        {
+            if (compressed >= 0)
+                return false;
+            compressed = count;
+            i++;
+        }
+    }
+    if (compressed < 0 && count != 8)
+        return false;
+    if (compressed >= 0 && count > 7)
+        return false;
+    int zeros = 8 - count;
+    int group = 0;
+    int source = 0;
+    while (group < 8)
+    {
+        quint16 value = 0;
+        if (compressed < 0 || group < compressed || group >= compressed + zeros)
+            value = groups[source++];
+        bytes[group * 2] = static_cast<quint8>(value >> 8);
+        bytes[group * 2 + 1] = static_cast<quint8>(value & 0xff);
+        group++;
+    }
+    return true;
+}
+
+IPAddressType IPAddress::Parse(const QString &text, IPAddress *address)
+{
+    const QChar *data = text.constData();
+    int length = text.length();
+    quint8 bytes[16];
+    IPAddressType type = IPAddressTypeNone;
+    // IPv6 is the only one that can contain colon, so we don't need to try both
+    if (text.contains(':'))
+    {
+        if (IPAddress_ParseIPv6(data, length, bytes))
+            type = IPAddressTypeIPv6;
+    } else if (IPAddress_ParseIPv4(data, length, bytes + 12))
+    {
+        std::memset(bytes, 0, 10);
+        bytes[10] = 0xff;
+        bytes[11] = 0xff;
+        type = IPAddressTypeIPv4;
+    }
+    if (address != nullptr)
+    {
+        address->Type = type;
+        if (type != IPAddressTypeNone)
+            std::memcpy(address->Bytes, bytes, 16);
+    }
+    return type;
+}
+
+IPAddress::IPAddress()
+{
+    this->Type = IPAddressTypeNone;
+    std::memset(this->Bytes, 0, 16);
+}
@@ -0,0 +1,70 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#ifndef IPADDRESS_HPP
+#define IPADDRESS_HPP
+
+#include "definitions.hpp"
+
+#include <QString>
+
+namespace Huggle
+{
+    enum IPAddressType
+    {
+        IPAddressTypeNone,
+        IPAddressTypeIPv4,
+        IPAddressTypeIPv6
+    };
+
+    //! IPv4 or IPv6 address in binary form
+
+    //! Usernames of anonymous users are addresses, these are checked for every user that
+    //! is created from the feed, so the parser works directly on the characters of the
+    //! string and doesn't allocate anything. IPv4 addresses are stored as IPv4 mapped
+    //! IPv6 addresses (::ffff:a.b.c.d) so that both types can be compared by bytes
+    class HUGGLE_EX_CORE IPAddress
+    {
+        public:
+            /*!
+             * \brief Parse converts text representation of address to binary form
+             * \param text Address, IPv6 may use :: and dotted IPv4 in last 32 bits, zone index is not supported
+             * \param address Pointer to address that is filled in, can be NULL if you just need to know if it's valid
+             * \return Type of address or IPAddressTypeNone if text is not an address
+             */
+            static IPAddressType Parse(const QString &text, IPAddress *address = nullptr);
+            static bool IsIPv4(const QString &text);
+            static bool IsIPv6(const QString &text);
+            IPAddress();
+            //! Returns the byte at given position, IPv4 addresses start on byte 12
+            quint8 GetByte(int index) const;
+            IPAddressType Type;
+            //! Address in network byte order
+            quint8 Bytes[16];
+    };
+
+    inline bool IPAddress::IsIPv4(const QString &text)
+    {
+        return IPAddress::Parse(text) == IPAddressTypeIPv4;
+    }
+
+    inline bool IPAddress::IsIPv6(const QString &text)
+    {
+        return IPAddress::Parse(text) == IPAddressTypeIPv6;
+    }
+
+    inline quint8 IPAddress::GetByte(int index) const
+    {
+        return this->Bytes[index];
+    }
+}
+
+#endif // IPADDRESS_HPP
@@ -0,0 +1,245 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "iprangetrie.hpp"
+#include "hugglequeuefilter.hpp"
+#include <QMutex>
+#include <cstring>
+
+using namespace Huggle;
+
+#define HUGGLE_IPRANGE_ROOT_IPV4 0
+#define HUGGLE_IPRANGE_ROOT_IPV6 1
+
+IPRangeTrie::Node::Node()
+{
+    this->Children[0] = 0;
+    this->Children[1] = 0;
+}
+
+IPRangeTrie::IPRangeTrie()
+{
+    this->lock = new QMutex(QMutex::Recursive);
+    this->Clear();
+}
+
+IPRangeTrie::~IPRangeTrie()
+{
+    delete this->lock;
+}
+
+bool IPRangeTrie::Update(const QString &address, qint64 badness, int warnings)
+{
+    IPAddress ip;
+    if (IPAddress::Parse(address, &ip) == IPAddressTypeNone)
+        return false;
+    return this->Update(ip, badness, warnings);
+}
+
+bool IPRangeTrie::Update(const IPAddress &address, qint64 badness, int warnings)
+{
+    if (address.Type == IPAddressTypeNone)
+        return false;
+    QByteArray key = IPRangeTrie::recordKey(address);
+    this->lock->lock();
+    if (!this->records.contains(key))
+    {
+        this->apply(address, badness, warnings, 1);
+    } else
+    {
+        Record &record = this->records[key];
+        if (record.Badness == badness && record.Warnings == warnings)
+        {
+            this->lock->unlock();
+            return true;
+        }
+        this->apply(address, badness - record.Badness, warnings - record.Warnings, 0);
+    }
+    Record &record = this->records[key];
+    record.Badness = badness;
+    record.Warnings = warnings;
+    this->lock->unlock();
+    // reputation of ranges changed, so edits may move in or out of bad range
+    HuggleQueueFilter::InvalidateProperties();
+    return true;
+}
+
+bool IPRangeTrie::Remove(const QString &address)
+{
+    IPAddress ip;
+    if (IPAddress::Parse(address, &ip) == IPAddressTypeNone)
+        return false;
+    return this->Remove(ip);
+}
+
+bool IPRangeTrie::Remove(const IPAddress &address)
+{
+    QByteArray key = IPRangeTrie::recordKey(address);
+    this->lock->lock();
+    if (!this->records.contains(key))
+    {
+        this->lock->unlock();
+        return false;
+    }
+    Record record = this->records.take(key);
+    this->apply(address, -record.Badness, -record.Warnings, -1);
+    if (this->unusedNodes > 64 && this->unusedNodes > this->nodes.count() / 2)
+        this->rebuild();
+    this->lock->unlock();
+    HuggleQueueFilter::InvalidateProperties();
+    return true;
+}
+
+IPRangeStats IPRangeTrie::GetRange(const QString &address, int prefix, bool exclude_address)
+{
+    IPAddress ip;
+    if (IPAddress::Parse(address, &ip) == IPAddressTypeNone)
+        return IPRangeStats();
+    return this->GetRange(ip, prefix, exclude_address);
+}
+
+IPRangeStats IPRangeTrie::GetRange(const IPAddress &address, int prefix, bool exclude_address)
+{
+    IPRangeStats result;
+    if (address.Type == IPAddressTypeNone)
+        return result;
+    int depth = HUGGLE_IPRANGE_IPV6_DEPTH;
+    int first_bit = 0;
+    int node = HUGGLE_IPRANGE_ROOT_IPV6;
+    if (address.Type == IPAddressTypeIPv4)
+    {
+        depth = HUGGLE_IPRANGE_IPV4_DEPTH;
+        first_bit = 96;
+        node = HUGGLE_IPRANGE_ROOT_IPV4;
+    }
+    if (prefix < 0)
+        prefix = 0;
+    if (prefix > depth)
+        prefix = depth;
+    this->lock->lock();
+    int bit = 0;
+    while (bit < prefix)
+    {
+        int n = first_bit + bit;
+        node = this->nodes.at(node).Children[(address.Bytes[n / 8] >> (7 - (n % 8))) & 1];
+        if (node == 0)
+        {
+            this->lock->unlock();
+            return result;
+        }
+        bit++;
+    }
+    result = this->nodes.at(node).Stats;
+    if (exclude_address)
+    {
+        QHash<QByteArray, Record>::const_iterator record = this->records.constFind(IPRangeTrie::recordKey(address));
+        if (record != this->records.constEnd())
+        {
+            result.Addresses--;
+            result.Badness -= record.value().Badness;
+            result.Warnings -= record.value().Warnings;
+        }
+    }
+    this->lock->unlock();
+    return result;
+}
+
+void IPRangeTrie::Clear()
+{
+    this->lock->lock();
+    this->records.clear();
+    this->nodes.clear();
+    // roots of IPv4 and IPv6 trie
+    this->nodes.append(Node());
+    this->nodes.append(Node());
+    this->unusedNodes = 0;
+    this->lock->unlock();
+    HuggleQueueFilter::InvalidateProperties();
+}
+
+int IPRangeTrie::GetAddressCount()
+{
+    this->lock->lock();
+    int count = this->records.count();
+    this->lock->unlock();
+    return count;
+}
+
+int IPRangeTrie::GetNodeCount()
+{
+    this->lock->lock();
+    int count = this->nodes.count();
+    this->lock->unlock();
+    return count;
+}
+
+QByteArray IPRangeTrie::recordKey(const IPAddress &address)
+{
+    QByteArray key(reinterpret_cast<const char*>(address.Bytes), 16);
+    key.append(static_cast<char>(address.Type));
+    return key;
+}
+
+void IPRangeTrie::apply(const IPAddress &address, qint64 badness, int warnings, int addresses)
+{
+    int depth = HUGGLE_IPRANGE_IPV6_DEPTH;
+    int first_bit = 0;
+    int node = HUGGLE_IPRANGE_ROOT_IPV6;
+    if (address.Type == IPAddressTypeIPv4)
+    {
+        depth = HUGGLE_IPRANGE_IPV4_DEPTH;
+        first_bit = 96;
+        node = HUGGLE_IPRANGE_ROOT_IPV4;
+    }
+    int bit = 0;
+    while (true)
+    {
+        IPRangeStats &stats = this->nodes[node].Stats;
+        if (addresses > 0 && stats.Addresses == 0 && node > HUGGLE_IPRANGE_ROOT_IPV6)
+            this->unusedNodes--;
+        stats.Addresses += addresses;
+        stats.Badness += badness;
+        stats.Warnings += warnings;
+        if (stats.Addresses == 0 && addresses < 0 && node > HUGGLE_IPRANGE_ROOT_IPV6)
+            this->unusedNodes++;
+        if (bit == depth)
+            break;
+        int n = first_bit + bit;
+        int direction = (address.Bytes[n / 8] >> (7 - (n % 8))) & 1;
+        int next = this->nodes.at(node).Children[direction];
+        if (next == 0)
+        {
+            // new node, this is never needed when address is removed because its path already exists
+            this->nodes.append(Node());
+            next = this->nodes.count() - 1;
+            this->nodes[node].Children[direction] = next;
+            // it's counted as unused here and used again right in next iteration
+            this->unusedNodes++;
+        }
+        node = next;
+        bit++;
+    }
+}
+
+void IPRangeTrie::rebuild()
+{
+    QHash<QByteArray, Record> old_records = this->records;
+    this->Clear();
+    QHash<QByteArray, Record>::const_iterator i = old_records.constBegin();
+    while (i != old_records.constEnd())
+    {
+        IPAddress address;
+        std::memcpy(address.Bytes, i.key().constData(), 16);
+        address.Type = static_cast<IPAddressType>(i.key().at(16));
+        this->apply(address, i.value().Badness, i.value().Warnings, 1);
+        this->records.insert(i.key(), i.value());
+        ++i;
+    }
+}
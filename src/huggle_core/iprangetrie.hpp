@@ -0,0 +1,115 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef IPRANGETRIE_HPP
+#define IPRANGETRIE_HPP
+
+#include "definitions.hpp"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "ipaddress.hpp"
+
+class QMutex;
+
+//! Number of bits of IPv4 address that are stored in trie
+#define HUGGLE_IPRANGE_IPV4_DEPTH 32
+//! Number of bits of IPv6 address that are stored in trie, hosts in same /64 are usually one subscriber
+#define HUGGLE_IPRANGE_IPV6_DEPTH 64
+
+namespace Huggle
+{
+    //! Aggregated information about all known addresses in some range
+    class HUGGLE_EX_CORE IPRangeStats
+    {
+        public:
+            IPRangeStats();
+            //! Number of addresses in range we have information about
+            int Addresses;
+            //! Sum of badness scores of these addresses
+            qint64 Badness;
+            //! Sum of warning levels of these addresses
+            int Warnings;
+    };
+
+    /*!
+     * \brief Binary trie of IPv4 and IPv6 prefixes that aggregates badness and warnings per range
+     *
+     * Every known address is stored as a path of nodes, one node per bit, and every node holds
+     * the sum of values of all addresses below it. Information about a range like /24 is therefore
+     * obtained by walking as many nodes as is the length of prefix, no matter how many addresses
+     * are in the trie. IPv6 addresses are stored only up to HUGGLE_IPRANGE_IPV6_DEPTH bits.
+     *
+     * Nodes of removed addresses are not freed one by one, instead the trie is rebuilt once
+     * more than half of the nodes is unused.
+     */
+    class HUGGLE_EX_CORE IPRangeTrie
+    {
+        public:
+            IPRangeTrie();
+            ~IPRangeTrie();
+            /*!
+             * \brief Update stores current values of address, replacing values stored for it before
+             * \param address IPv4 or IPv6 address
+             * \return false if address is not valid
+             */
+            bool Update(const QString &address, qint64 badness, int warnings);
+            bool Update(const IPAddress &address, qint64 badness, int warnings);
+            //! Remove the address from all ranges it belongs to
+            bool Remove(const QString &address);
+            bool Remove(const IPAddress &address);
+            /*!
+             * \brief GetRange returns aggregated values for range of given address
+             * \param address Any address from the range
+             * \param prefix Length of prefix in bits of given address type, like 24 for IPv4 /24
+             * \param exclude_address If true the values of address itself are not included
+             * \return Values of the range, empty if nothing is known about it
+             */
+            IPRangeStats GetRange(const QString &address, int prefix, bool exclude_address = false);
+            IPRangeStats GetRange(const IPAddress &address, int prefix, bool exclude_address = false);
+            void Clear();
+            int GetAddressCount();
+            int GetNodeCount();
+        private:
+            class Node
+            {
+                public:
+                    Node();
+                    //! Index of nodes for bit 0 and 1, 0 means there is no such node because root can't be a child
+                    qint32 Children[2];
+                    IPRangeStats Stats;
+            };
+            class Record
+            {
+                public:
+                    qint64 Badness;
+                    int Warnings;
+            };
+            static QByteArray recordKey(const IPAddress &address);
+            void apply(const IPAddress &address, qint64 badness, int warnings, int addresses);
+            void rebuild();
+            QVector<Node> nodes;
+            QHash<QByteArray, Record> records;
+            //! Number of nodes that don't hold any address
+            int unusedNodes = 0;
+            QMutex *lock;
+    };
+
+    inline IPRangeStats::IPRangeStats()
+    {
+        this->Addresses = 0;
+        this->Badness = 0;
+        this->Warnings = 0;
+    }
+}
+
+#endif // IPRANGETRIE_HPP
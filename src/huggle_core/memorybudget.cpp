@@ -0,0 +1,118 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#include "memorybudget.hpp"
+#include <QMutex>
+#include "configuration.hpp"
+#include "syslog.hpp"
+using namespace Huggle;
+
+MemoryBudget *MemoryBudget::HuggleMemoryBudget = nullptr;
+
+MemoryBudget::MemoryBudget()
+{
+    this->lock = new QMutex(QMutex::Recursive);
+}
+
+MemoryBudget::~MemoryBudget()
+{
+    delete this->lock;
+}
+
+void MemoryBudget::Register(const QString &name, int priority, void *source, MemoryBudget_SizeCallback size, MemoryBudget_EvictCallback evict)
+{
+    MemoryBudget_Subsystem subsystem;
+    subsystem.Name = name;
+    subsystem.Priority = priority;
+    subsystem.Source = source;
+    subsystem.SizeCallback = size;
+    subsystem.EvictCallback = evict;
+    this->lock->lock();
+    // keep the list sorted by priority so that we can evict in order
+    int index = 0;
+    while (index < this->subsystems.count() && this->subsystems.at(index).Priority <= priority)
+        index++;
+    this->subsystems.insert(index, subsystem);
+    this->lock->unlock();
+}
+
+void MemoryBudget::Unregister(void *source)
+{
+    this->lock->lock();
+    int index = 0;
+    while (index < this->subsystems.count())
+    {
+        if (this->subsystems.at(index).Source == source)
+        {
+            this->subsystems.removeAt(index);
+            continue;
+        }
+        index++;
+    }
+    this->lock->unlock();
+}
+
+qint64 MemoryBudget::Check()
+{
+    this->lock->lock();
+    this->totalSize = 0;
+    int index = 0;
+    while (index < this->subsystems.count())
+    {
+        MemoryBudget_Subsystem *subsystem = &this->subsystems[index++];
+        subsystem->Size = subsystem->SizeCallback(subsystem->Source);
+        this->totalSize += subsystem->Size;
+    }
+    qint64 budget = this->GetBudget();
+    if (budget <= 0 || this->totalSize <= budget)
+    {
+        this->lock->unlock();
+        return 0;
+    }
+    qint64 evicted = 0;
+    index = 0;
+    while (this->totalSize > budget && index < this->subsystems.count())
+    {
+        MemoryBudget_Subsystem *subsystem = &this->subsystems[index++];
+        if (subsystem->Size <= 0)
+            continue;
+        qint64 released = subsystem->EvictCallback(subsystem->Source, this->totalSize - budget);
+        if (released <= 0)
+            continue;
+        HUGGLE_DEBUG("Memory budget exceeded, evicted " + QString::number(released) + " bytes from " + subsystem->Name, 2);
+        subsystem->Evicted += released;
+        subsystem->Size -= released;
+        this->totalSize -= released;
+        evicted += released;
+    }
+    if (this->totalSize > budget)
+        HUGGLE_DEBUG1("Unable to fit the memory budget, " + QString::number(this->totalSize) + " bytes are still in use");
+    this->lock->unlock();
+    return evicted;
+}
+
+qint64 MemoryBudget::GetTotalSize()
+{
+    return this->totalSize;
+}
+
+qint64 MemoryBudget::GetBudget()
+{
+    return static_cast<qint64>(hcfg->SystemConfig_MemoryBudget) * 1024 * 1024;
+}
+
+QList<MemoryBudget_Subsystem> MemoryBudget::GetSubsystems()
+{
+    this->lock->lock();
+    QList<MemoryBudget_Subsystem> result = this->subsystems;
+    this->lock->unlock();
+    return result;
+}
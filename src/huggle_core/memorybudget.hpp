@@ -0,0 +1,82 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#ifndef MEMORYBUDGET_HPP
+#define MEMORYBUDGET_HPP
+
+#include "definitions.hpp"
+
+#include <QList>
+#include <QString>
+
+class QMutex;
+
+// Subsystems with lower priority are evicted first
+#define HUGGLE_MEMORY_PRIORITY_LOGS             0
+#define HUGGLE_MEMORY_PRIORITY_EDITCACHE        1
+#define HUGGLE_MEMORY_PRIORITY_HAN              2
+#define HUGGLE_MEMORY_PRIORITY_HISTORY          3
+#define HUGGLE_MEMORY_PRIORITY_PROVIDER         4
+#define HUGGLE_MEMORY_PRIORITY_QUEUE            5
+
+namespace Huggle
+{
+    //! Returns approximate number of bytes held by subsystem
+    typedef qint64 (*MemoryBudget_SizeCallback) (void *source);
+    //! Asks subsystem to release at least given number of bytes, returns number of bytes that were released
+    typedef qint64 (*MemoryBudget_EvictCallback) (void *source, qint64 bytes);
+
+    class HUGGLE_EX_CORE MemoryBudget_Subsystem
+    {
+        public:
+            QString Name;
+            int Priority;
+            void *Source;
+            MemoryBudget_SizeCallback SizeCallback;
+            MemoryBudget_EvictCallback EvictCallback;
+            //! Size that was measured during last check
+            qint64 Size = 0;
+            //! Total number of bytes that were evicted from this subsystem since startup
+            qint64 Evicted = 0;
+    };
+
+    //! Global memory budget
+
+    //! Huggle holds a number of caches (feed buffers, edits, queue, history, logs, HAN) each
+    //! of them has its own fixed limit, but none of them knows about the others. Every cache
+    //! registers here with a function that estimates its size and a function that evicts
+    //! the data, once the total size is over SystemConfig_MemoryBudget the subsystems are
+    //! evicted in order of their priority, until the total fits the budget again
+    class HUGGLE_EX_CORE MemoryBudget
+    {
+        public:
+            static MemoryBudget *HuggleMemoryBudget;
+
+            MemoryBudget();
+            ~MemoryBudget();
+            void Register(const QString &name, int priority, void *source, MemoryBudget_SizeCallback size, MemoryBudget_EvictCallback evict);
+            //! Remove all subsystems that were registered with this source
+            void Unregister(void *source);
+            //! Measure all subsystems and evict some data in case the budget is exceeded, returns number of evicted bytes
+            qint64 Check();
+            //! Total size of all subsystems as measured by last check
+            qint64 GetTotalSize();
+            //! Budget in bytes, 0 if there is none
+            qint64 GetBudget();
+            QList<MemoryBudget_Subsystem> GetSubsystems();
+        private:
+            QList<MemoryBudget_Subsystem> subsystems;
+            QMutex *lock;
+            qint64 totalSize = 0;
+    };
+}
+
+#endif // MEMORYBUDGET_HPP
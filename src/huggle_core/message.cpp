@@ -229,7 +229,7 @@ void Message::Finish()
                     }
                     Hooks::WikiEdit_OnNewHistoryItem(item);
                     // write something to talk page in case it was empty
-                    if (this->User->TalkPage_GetContents().isEmpty())
+                    if (!this->User->TalkPage_Exists())
                         this->User->TalkPage_SetContents(this->Text);
                     // update last message time
                     this->User->SetLastMessageTime(QDateTime::currentDateTime());
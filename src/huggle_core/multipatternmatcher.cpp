@@ -0,0 +1,126 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#include "multipatternmatcher.hpp"
+#include <QQueue>
+using namespace Huggle;
+
+MultiPatternMatcher::MultiPatternMatcher()
+{
+    // root
+    this->nodes.append(Node());
+}
+
+void MultiPatternMatcher::AddPattern(const QString &pattern, int value)
+{
+    if (pattern.isEmpty())
+        return;
+    int state = 0;
+    int i = 0;
+    while (i < pattern.length())
+    {
+        ushort c = pattern[i++].unicode();
+        if (c == '\n')
+            this->multiline = true;
+        int next = this->nodes[state].Next.value(c, -1);
+        if (next < 0)
+        {
+            next = this->nodes.count();
+            this->nodes.append(Node());
+            this->nodes[state].Next.insert(c, next);
+        }
+        state = next;
+    }
+    if (this->nodes[state].Value < value)
+        this->nodes[state].Value = value;
+    if (this->highest < value)
+        this->highest = value;
+    this->patterns++;
+    this->built = false;
+}
+
+void MultiPatternMatcher::Clear()
+{
+    this->nodes.clear();
+    this->nodes.append(Node());
+    this->patterns = 0;
+    this->highest = -1;
+    this->multiline = false;
+    this->built = true;
+}
+
+void MultiPatternMatcher::Build()
+{
+    if (this->built)
+        return;
+    // breadth first, so that failure node of every node is resolved before the node itself
+    QQueue<int> queue;
+    foreach (int child, this->nodes[0].Next)
+    {
+        this->nodes[child].Fail = 0;
+        queue.enqueue(child);
+    }
+    while (!queue.isEmpty())
+    {
+        int state = queue.dequeue();
+        QHash<ushort, int>::const_iterator i = this->nodes[state].Next.constBegin();
+        while (i != this->nodes[state].Next.constEnd())
+        {
+            int child = i.value();
+            int fail = this->nodes[state].Fail;
+            while (fail > 0 && !this->nodes[fail].Next.contains(i.key()))
+                fail = this->nodes[fail].Fail;
+            fail = this->nodes[fail].Next.value(i.key(), 0);
+            if (fail == child)
+                fail = 0;
+            this->nodes[child].Fail = fail;
+            if (this->nodes[child].Value < this->nodes[fail].Value)
+                this->nodes[child].Value = this->nodes[fail].Value;
+            queue.enqueue(child);
+            ++i;
+        }
+    }
+    this->built = true;
+}
+
+int MultiPatternMatcher::step(int state, ushort c) const
+{
+    while (true)
+    {
+        int next = this->nodes[state].Next.value(c, -1);
+        if (next >= 0)
+            return next;
+        if (state == 0)
+            return 0;
+        state = this->nodes[state].Fail;
+    }
+}
+
+int MultiPatternMatcher::MatchHighest(const QChar *text, int length, int stop_at)
+{
+    this->Build();
+    int result = -1;
+    if (this->patterns == 0)
+        return result;
+    int state = 0;
+    int i = 0;
+    while (i < length)
+    {
+        state = this->step(state, text[i++].unicode());
+        if (this->nodes[state].Value > result)
+        {
+            result = this->nodes[state].Value;
+            if (result >= stop_at)
+                break;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,94 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#ifndef MULTIPATTERNMATCHER_HPP
+#define MULTIPATTERNMATCHER_HPP
+
+#include "definitions.hpp"
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+namespace Huggle
+{
+    //! Finds many fixed strings in a text at once
+
+    //! This is an Aho-Corasick automaton, all patterns are compiled into one trie with failure
+    //! links so that the text is read only once no matter how many patterns there are. Every
+    //! pattern has a value, matching functions return highest value of patterns that were found.
+    //! Matching is read only, so it's safe to use same matcher from more threads once it was built,
+    //! the automaton is built on first match after patterns were changed.
+    class HUGGLE_EX_CORE MultiPatternMatcher
+    {
+        public:
+            MultiPatternMatcher();
+            //! Insert a pattern, empty patterns are ignored
+            void AddPattern(const QString &pattern, int value = 0);
+            void Clear();
+            //! Number of patterns
+            int Count() const;
+            //! Returns true if any pattern contains a new line
+            bool HasMultilinePatterns() const;
+            //! Build the automaton, this is called automatically by matching functions if needed
+            void Build();
+            //! Returns true if any pattern is in text
+            bool Contains(const QString &text);
+            /*!
+             * \brief MatchHighest scans the text and returns highest value of patterns that were found in it
+             * \param text Pointer to first character
+             * \param length Number of characters
+             * \param stop_at Scanning stops once a pattern with this value or higher was found
+             * \return Value or -1 if there was no match
+             */
+            int MatchHighest(const QChar *text, int length, int stop_at);
+            int MatchHighest(const QString &text);
+        private:
+            class Node
+            {
+                public:
+                    QHash<ushort, int> Next;
+                    //! Index of longest suffix of this node that is also in the trie
+                    int Fail = 0;
+                    //! Highest value of pattern that ends in this node or in any node on its failure chain
+                    int Value = -1;
+            };
+            int step(int state, ushort c) const;
+            QVector<Node> nodes;
+            int patterns = 0;
+            int highest = -1;
+            bool built = true;
+            bool multiline = false;
+    };
+
+    inline int MultiPatternMatcher::Count() const
+    {
+        return this->patterns;
+    }
+
+    inline bool MultiPatternMatcher::HasMultilinePatterns() const
+    {
+        return this->multiline;
+    }
+
+    inline int MultiPatternMatcher::MatchHighest(const QString &text)
+    {
+        return this->MatchHighest(text.constData(), text.length(), this->highest);
+    }
+
+    inline bool MultiPatternMatcher::Contains(const QString &text)
+    {
+        // any match is good enough, so we can stop on first one
+        return this->MatchHighest(text.constData(), text.length(), -1) >= 0;
+    }
+}
+
+#endif // MULTIPATTERNMATCHER_HPP
@@ -18,6 +18,9 @@
 #include "version.hpp"
 #include "wikipage.hpp"
 #include "wikisite.hpp"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
 
 // Nasty hack to get yaml-cpp to work on OSX
 #undef _l
@@ -202,8 +205,10 @@ bool ProjectConfiguration::Parse(const QString& config, QString *reason, WikiSit
     // Ignoring
     this->Ignores = HuggleParser::ConfigurationParse_QL("ignore", config, true);
     this->IgnorePatterns = HuggleParser::ConfigurationParse_QL("ignore-patterns", config, true);
+    this->RebuildIgnores();
     // Scoring
     this->IPScore = HuggleParser::ConfigurationParse(ProjectConfig_IPScore_Key, config, "800").toInt();
+    this->IPRangeScore = HuggleParser::ConfigurationParse("score-ip-range", config, "50").toInt();
     this->ScoreFlag = HuggleParser::ConfigurationParse("score-flag", config).toInt();
     this->ForeignUser = HuggleParser::ConfigurationParse("score-foreign-user", config, "200").toInt();
     this->BotScore = HuggleParser::ConfigurationParse("score-bot", config, "-200000").toInt();
@@ -580,6 +585,7 @@ bool ProjectConfiguration::ParseYAML(const QString& yaml_src, QString *reason, W
     this->IgnorePatterns = HuggleParser::YAML2QStringList("ignore-patterns", yaml);
     if (!this->IgnorePatterns.count())
         HUGGLE_DEBUG1(this->ProjectName + " conf: 0 records for ignore-patterns");
+    this->RebuildIgnores();
 
     /////////////////////////////////////////////
     // Prediction
@@ -588,6 +594,7 @@ bool ProjectConfiguration::ParseYAML(const QString& yaml_src, QString *reason, W
     // Scoring
     this->WhitelistScore = HuggleParser::YAML2Int("score-wl", yaml, -800);
     this->IPScore = HuggleParser::YAML2Int(ProjectConfig_IPScore_Key, yaml, 800);
+    this->IPRangeScore = HuggleParser::YAML2Int("score-ip-range", yaml, 50);
     this->ScoreFlag = HuggleParser::YAML2Int("score-flag", yaml);
     this->ForeignUser = HuggleParser::YAML2Int("score-foreign-user", yaml, 200);
     this->BotScore = HuggleParser::YAML2Int("score-bot", yaml, -200000);
@@ -888,6 +895,16 @@ QString ProjectConfiguration::GetConfig(QString key, QString dv)
     return value;
 }
 
+void ProjectConfiguration::RebuildIgnores()
+{
+    this->IgnoreSet = this->Ignores.toSet();
+    this->IgnorePatternMatcher.Clear();
+    foreach (QString pattern, this->IgnorePatterns)
+        this->IgnorePatternMatcher.AddPattern(pattern);
+    // build it now, because filters are used from more threads
+    this->IgnorePatternMatcher.Build();
+}
+
 void ProjectConfiguration::Sanitize()
 {
     if (this->ReportAIV.size() == 0)
@@ -904,6 +921,71 @@ void ProjectConfiguration::Sanitize()
     this->IsSane = true;
 }
 
+// "HWL2" - version of whitelist snapshot format
+#define HUGGLE_WL_SNAPSHOT_MAGIC 0x48574c32
+
+bool ProjectConfiguration::SaveWhitelistSnapshot(const QString &path)
+{
+    // the old snapshot is replaced only once the new one is complete, so a crash can't leave broken file behind
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        Syslog::HuggleLogs->WarningLog("Unable to write whitelist snapshot to " + path);
+        return false;
+    }
+    // usernames can't contain new line so we can use it as separator, utf-8 and compression keep the file small
+    QStringList users = this->WhiteList.toList();
+    QDataStream stream(&file);
+    stream << static_cast<quint32>(HUGGLE_WL_SNAPSHOT_MAGIC) << this->WhitelistSnapshotTime << this->WhitelistTime
+           << qCompress(users.join("\n").toUtf8());
+    if (stream.status() != QDataStream::Ok || !file.commit())
+    {
+        Syslog::HuggleLogs->WarningLog("Unable to write whitelist snapshot to " + path + ": " + file.errorString());
+        return false;
+    }
+    HUGGLE_DEBUG("Stored " + QString::number(users.count()) + " whitelisted users to " + path, 2);
+    return true;
+}
+
+bool ProjectConfiguration::LoadWhitelistSnapshot(const QString &path, int max_age)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    QDateTime snapshot_time;
+    QDateTime time;
+    QByteArray data;
+    stream >> magic;
+    if (magic != HUGGLE_WL_SNAPSHOT_MAGIC)
+    {
+        // snapshots of older format are just downloaded again
+        HUGGLE_DEBUG("Whitelist snapshot " + path + " has unknown format, ignoring it", 2);
+        return false;
+    }
+    stream >> snapshot_time >> time >> data;
+    file.close();
+    if (stream.status() != QDataStream::Ok || !snapshot_time.isValid() || !time.isValid())
+    {
+        Syslog::HuggleLogs->WarningLog("Whitelist snapshot " + path + " is broken, ignoring it");
+        return false;
+    }
+    if (snapshot_time.addSecs(static_cast<qint64>(max_age) * 3600) < QDateTime::currentDateTime())
+    {
+        HUGGLE_DEBUG("Whitelist snapshot " + path + " is too old", 2);
+        return false;
+    }
+    QByteArray users = qUncompress(data);
+    if (users.isEmpty() && !data.isEmpty())
+        return false;
+    this->WhiteList = QString::fromUtf8(users).split("\n", QString::SkipEmptyParts).toSet();
+    this->WhitelistTime = time;
+    this->WhitelistSnapshotTime = snapshot_time;
+    HUGGLE_DEBUG("Loaded " + QString::number(this->WhiteList.count()) + " whitelisted users from " + path, 2);
+    return true;
+}
+
 QDateTime ProjectConfiguration::ServerTime()
 {
     return QDateTime::currentDateTime().addSecs(this->ServerOffset);
@@ -14,10 +14,12 @@
 // Include file with all global defines
 #include "definitions.hpp"
 
+#include "multipatternmatcher.hpp"
 #include <QList>
 #include <QDateTime>
 #include <QStringList>
 #include <QHash>
+#include <QSet>
 #include <QString>
 
 // Private key names
@@ -101,6 +103,18 @@ namespace Huggle
             bool ParseYAML(const QString& yaml_src, QString *reason, WikiSite *site);
             void RequestLogin();
             QString GetConfig(QString key, QString dv = "");
+            //! Rebuild IgnoreSet and IgnorePatternMatcher, call this whenever Ignores or IgnorePatterns change
+            void RebuildIgnores();
+            //! Write whitelist to a compressed binary file, so that it doesn't need to be downloaded on next start
+            bool SaveWhitelistSnapshot(const QString &path);
+            /*!
+             * \brief Load whitelist from file created by SaveWhitelistSnapshot
+             * \param path Path to file
+             * \param max_age Maximal age of snapshot in hours, counted from last time whole whitelist was downloaded,
+             *                older snapshots are not loaded so that whole whitelist is downloaded again
+             * \return False if file doesn't exist, is broken or too old
+             */
+            bool LoadWhitelistSnapshot(const QString &path, int max_age);
             //! \todo This needs to be later used as a default value for user config, however it's not being ensured
             //!       this value is loaded before the user config right now
             bool AutomaticallyResolveConflicts = false;
@@ -184,6 +198,8 @@ namespace Huggle
             bool            PatrollingFlaggedRevs = false;
             score_ht        EditScore = -2;
             score_ht        IPScore = 20;
+            //! Percentage of average badness of other addresses in same IP range that is added to score of anonymous edit
+            score_ht        IPRangeScore = 50;
             // Reverting
             QString         MultipleRevertSummary = "Reverted,edit by,edits by,and,other users,to last revision by,to an older version by";
             bool            RevertingEnabled = true;
@@ -222,8 +238,14 @@ namespace Huggle
             bool            InstantWarnings = false;
             QStringList     WarningDefs;
             //! Data of wl (list of users)
-            QStringList     WhiteList;
+            QSet<QString>   WhiteList;
+            //! Users that were whitelisted in this session and need to be written to wl
             QStringList     NewWhitelist;
+            //! Server time of last retrieval of whitelist or its changes, next delta is requested since this time
+            QDateTime       WhitelistTime;
+            //! Server time of last retrieval of whole whitelist, merging of changes doesn't update it, so that snapshot
+            //! expires after SystemConfig_WhitelistSnapshotAge even if only changes were downloaded since then
+            QDateTime       WhitelistSnapshotTime;
 
             QString         ReportSummary;
             QString         RestoreSummary = "Restored revision $1 made by $2: $3";
@@ -265,10 +287,14 @@ namespace Huggle
             //! This is a number that can be used to get a current server time
             qint64                  ServerOffset = 0;
             QStringList             Ignores;
+            //! Same as Ignores, used by filters to look up the page quickly
+            QSet<QString>           IgnoreSet;
             QStringList             RevertPatterns;
             QStringList             Assisted;
             QStringList             Templates;
             QStringList             IgnorePatterns;
+            //! All IgnorePatterns compiled into one automaton, so that title is scanned only once
+            MultiPatternMatcher     IgnorePatternMatcher;
             QString                 Parser_Date_Prefix = ",";
             QStringList             Parser_Date_Suffix;
             score_ht                TalkPageWarningScore = -800;
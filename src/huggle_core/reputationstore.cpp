@@ -0,0 +1,350 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#include "reputationstore.hpp"
+#include <QFile>
+#include <QReadWriteLock>
+#include <QSaveFile>
+#include <QVector>
+#include <QDateTime>
+#include <algorithm>
+#include "syslog.hpp"
+#include "wikisite.hpp"
+
+using namespace Huggle;
+
+#define HUGGLE_REPUTATION_MAGIC     0x48525331
+#define HUGGLE_REPUTATION_VERSION   1
+#define HUGGLE_REPUTATION_MIN_SIZE  1024
+
+ReputationStore *ReputationStore::HuggleReputation = nullptr;
+
+namespace Huggle
+{
+    // Layout of the file, it's only used on the machine where it was created so native byte order is used
+    class ReputationStore_Header
+    {
+        public:
+            quint32 Magic;
+            quint32 Version;
+            quint32 Capacity;
+            quint32 Count;
+            quint8 Reserved[16];
+    };
+
+    class ReputationStore_Record
+    {
+        public:
+            //! Hash of site and username, 0 means that record is empty
+            quint64 Hash;
+            quint32 Check;
+            qint32 WarningLevel;
+            qint64 Badness;
+            qint64 WarningTime;
+            qint64 TalkPageRevID;
+            qint64 LastUpdate;
+    };
+}
+
+static ReputationStore_Header *ReputationStore_GetHeader(uchar *data)
+{
+    return reinterpret_cast<ReputationStore_Header*>(data);
+}
+
+static ReputationStore_Record *ReputationStore_GetRecords(uchar *data)
+{
+    return reinterpret_cast<ReputationStore_Record*>(data + sizeof(ReputationStore_Header));
+}
+
+static int ReputationStore_FindSlot(uchar *data, quint64 hash, uint check)
+{
+    ReputationStore_Record *records = ReputationStore_GetRecords(data);
+    quint32 mask = ReputationStore_GetHeader(data)->Capacity - 1;
+    quint32 slot = static_cast<quint32>(hash) & mask;
+    quint32 probes = 0;
+    while (probes <= mask)
+    {
+        if (records[slot].Hash == 0 || (records[slot].Hash == hash && records[slot].Check == check))
+            return static_cast<int>(slot);
+        slot = (slot + 1) & mask;
+        probes++;
+    }
+    return -1;
+}
+
+static bool ReputationStore_NewerThan(const ReputationStore_Record &a, const ReputationStore_Record &b)
+{
+    return a.LastUpdate > b.LastUpdate;
+}
+
+ReputationStore::ReputationStore()
+{
+    this->lock = new QReadWriteLock();
+}
+
+ReputationStore::~ReputationStore()
+{
+    this->Close();
+    delete this->lock;
+}
+
+bool ReputationStore::Open(const QString &path, int max_records)
+{
+    this->Close();
+    this->lock->lockForWrite();
+    this->maxRecords = max_records;
+    this->file = new QFile(path);
+    if (!this->file->open(QIODevice::ReadWrite))
+    {
+        Syslog::HuggleLogs->WarningLog("Unable to open reputation store " + path + ": " + this->file->errorString());
+        delete this->file;
+        this->file = nullptr;
+        this->lock->unlock();
+        return false;
+    }
+    ReputationStore_Header header;
+    bool valid = this->file->read(reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header) &&
+                 header.Magic == HUGGLE_REPUTATION_MAGIC && header.Version == HUGGLE_REPUTATION_VERSION &&
+                 header.Capacity >= HUGGLE_REPUTATION_MIN_SIZE && (header.Capacity & (header.Capacity - 1)) == 0 &&
+                 this->file->size() == static_cast<qint64>(sizeof(ReputationStore_Header) + header.Capacity * sizeof(ReputationStore_Record));
+    bool result;
+    if (valid)
+    {
+        result = this->map();
+    } else
+    {
+        if (this->file->size() > 0)
+            Syslog::HuggleLogs->WarningLog("Reputation store " + path + " is broken, creating a new one");
+        result = this->resize(HUGGLE_REPUTATION_MIN_SIZE, false);
+    }
+    this->lock->unlock();
+    if (!result)
+    {
+        this->Close();
+        return false;
+    }
+    HUGGLE_DEBUG("Opened reputation store " + path + " with " + QString::number(this->Count()) + " users", 2);
+    return true;
+}
+
+void ReputationStore::Close()
+{
+    this->lock->lockForWrite();
+    if (this->file != nullptr)
+    {
+        if (this->data != nullptr)
+            this->file->unmap(this->data);
+        this->file->close();
+        delete this->file;
+    }
+    this->data = nullptr;
+    this->file = nullptr;
+    this->lock->unlock();
+}
+
+bool ReputationStore::Get(WikiSite *site, const QString &user, ReputationStore_Entry *entry)
+{
+    // this is called from thread that is scoring edits, so if someone is writing we rather pretend we don't know the user
+    if (!this->lock->tryLockForRead())
+        return false;
+    if (this->data == nullptr)
+    {
+        this->lock->unlock();
+        return false;
+    }
+    uint check;
+    quint64 hash = ReputationStore::keyHash(site, user, &check);
+    int slot = this->findSlot(hash, check);
+    if (slot < 0 || ReputationStore_GetRecords(this->data)[slot].Hash == 0)
+    {
+        this->lock->unlock();
+        this->misses.fetchAndAddRelaxed(1);
+        return false;
+    }
+    const ReputationStore_Record &record = ReputationStore_GetRecords(this->data)[slot];
+    entry->Badness = record.Badness;
+    entry->WarningLevel = record.WarningLevel;
+    entry->WarningTime = record.WarningTime;
+    entry->TalkPageRevID = record.TalkPageRevID;
+    entry->LastUpdate = record.LastUpdate;
+    this->lock->unlock();
+    this->hits.fetchAndAddRelaxed(1);
+    return true;
+}
+
+bool ReputationStore::Put(WikiSite *site, const QString &user, const ReputationStore_Entry &entry)
+{
+    uint check;
+    quint64 hash = ReputationStore::keyHash(site, user, &check);
+    this->lock->lockForWrite();
+    if (this->data == nullptr)
+    {
+        this->lock->unlock();
+        return false;
+    }
+    ReputationStore_Header *header = ReputationStore_GetHeader(this->data);
+    int slot = this->findSlot(hash, check);
+    if (slot < 0 || ReputationStore_GetRecords(this->data)[slot].Hash == 0)
+    {
+        // new user, make sure there is a space for them
+        int capacity = static_cast<int>(header->Capacity);
+        bool resized = true;
+        if (this->maxRecords > 0 && static_cast<int>(header->Count) >= this->maxRecords)
+            resized = this->resize(capacity, true);
+        else if ((header->Count + 1) * 10 > header->Capacity * 7)
+            resized = this->resize(capacity * 2, false);
+        if (!resized)
+        {
+            this->lock->unlock();
+            return false;
+        }
+        header = ReputationStore_GetHeader(this->data);
+        slot = this->findSlot(hash, check);
+        header->Count++;
+    }
+    ReputationStore_Record &record = ReputationStore_GetRecords(this->data)[slot];
+    record.Hash = hash;
+    record.Check = check;
+    record.Badness = entry.Badness;
+    record.WarningLevel = entry.WarningLevel;
+    record.WarningTime = entry.WarningTime;
+    record.TalkPageRevID = entry.TalkPageRevID;
+    record.LastUpdate = entry.LastUpdate;
+    if (record.LastUpdate == 0)
+        record.LastUpdate = QDateTime::currentMSecsSinceEpoch();
+    this->lock->unlock();
+    return true;
+}
+
+int ReputationStore::Count()
+{
+    this->lock->lockForRead();
+    int count = 0;
+    if (this->data != nullptr)
+        count = static_cast<int>(ReputationStore_GetHeader(this->data)->Count);
+    this->lock->unlock();
+    return count;
+}
+
+int ReputationStore::GetCapacity()
+{
+    this->lock->lockForRead();
+    int capacity = 0;
+    if (this->data != nullptr)
+        capacity = static_cast<int>(ReputationStore_GetHeader(this->data)->Capacity);
+    this->lock->unlock();
+    return capacity;
+}
+
+qint64 ReputationStore::GetHits()
+{
+    return this->hits.load();
+}
+
+qint64 ReputationStore::GetMisses()
+{
+    return this->misses.load();
+}
+
+quint64 ReputationStore::keyHash(WikiSite *site, const QString &user, uint *check)
+{
+    QString name = user;
+    name.replace(" ", "_");
+    QString key = site->Name + QChar('\n') + name;
+    // FNV-1a
+    quint64 hash = Q_UINT64_C(14695981039346656037);
+    const ushort *c = key.utf16();
+    int i = 0;
+    while (i < key.length())
+    {
+        hash ^= c[i++];
+        hash *= Q_UINT64_C(1099511628211);
+    }
+    if (hash == 0)
+        hash = 1;
+    *check = qHash(key);
+    return hash;
+}
+
+bool ReputationStore::map()
+{
+    this->data = this->file->map(0, this->file->size());
+    if (this->data == nullptr)
+    {
+        Syslog::HuggleLogs->WarningLog("Unable to map reputation store: " + this->file->errorString());
+        return false;
+    }
+    return true;
+}
+
+bool ReputationStore::resize(int capacity, bool drop_old)
+{
+    QVector<ReputationStore_Record> records;
+    if (this->data != nullptr)
+    {
+        ReputationStore_Header *header = ReputationStore_GetHeader(this->data);
+        ReputationStore_Record *old = ReputationStore_GetRecords(this->data);
+        records.reserve(static_cast<int>(header->Count));
+        quint32 i = 0;
+        while (i < header->Capacity)
+        {
+            if (old[i].Hash != 0)
+                records.append(old[i]);
+            i++;
+        }
+        this->file->unmap(this->data);
+        this->data = nullptr;
+    }
+    if (drop_old)
+    {
+        // keep only the half of users that were updated most recently
+        std::sort(records.begin(), records.end(), ReputationStore_NewerThan);
+        records.resize(qMin(records.count(), this->maxRecords / 2));
+    }
+    // new table is built in memory and then replaces the old file at once, so that if huggle
+    // crashes in the middle of resize the store on disk is either the old one or the new one
+    qint64 size = static_cast<qint64>(sizeof(ReputationStore_Header)) + static_cast<qint64>(capacity) * sizeof(ReputationStore_Record);
+    QByteArray table(static_cast<int>(size), 0);
+    uchar *table_data = reinterpret_cast<uchar*>(table.data());
+    ReputationStore_Header *header = ReputationStore_GetHeader(table_data);
+    header->Magic = HUGGLE_REPUTATION_MAGIC;
+    header->Version = HUGGLE_REPUTATION_VERSION;
+    header->Capacity = static_cast<quint32>(capacity);
+    header->Count = 0;
+    foreach (ReputationStore_Record record, records)
+    {
+        int slot = ReputationStore_FindSlot(table_data, record.Hash, record.Check);
+        ReputationStore_GetRecords(table_data)[slot] = record;
+        header->Count++;
+    }
+    QSaveFile temp(this->file->fileName());
+    bool written = temp.open(QIODevice::WriteOnly) && temp.write(table) == size;
+    // the old file needs to be closed before it's replaced, some systems don't allow replacing of open files
+    this->file->close();
+    if (!written || !temp.commit())
+    {
+        Syslog::HuggleLogs->WarningLog("Unable to resize reputation store: " + temp.errorString());
+        temp.cancelWriting();
+        if (this->file->open(QIODevice::ReadWrite))
+            this->map();
+        return false;
+    }
+    if (!this->file->open(QIODevice::ReadWrite))
+    {
+        Syslog::HuggleLogs->WarningLog("Unable to open reputation store: " + this->file->errorString());
+        return false;
+    }
+    return this->map();
+}
+
+int ReputationStore::findSlot(quint64 hash, uint check)
+{
+    return ReputationStore_FindSlot(this->data, hash, check);
+}
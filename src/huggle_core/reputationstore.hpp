@@ -0,0 +1,96 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+#ifndef REPUTATIONSTORE_HPP
+#define REPUTATIONSTORE_HPP
+
+#include "definitions.hpp"
+
+#include <QAtomicInt>
+#include <QString>
+
+class QFile;
+class QReadWriteLock;
+
+namespace Huggle
+{
+    class WikiSite;
+
+    //! Information about user that is kept in between sessions
+    class HUGGLE_EX_CORE ReputationStore_Entry
+    {
+        public:
+            qint64 Badness = 0;
+            int WarningLevel = 0;
+            //! Time in ms since epoch of last warning, 0 if not known
+            qint64 WarningTime = 0;
+            //! Revision of user talk page the warning level was parsed from
+            revid_ht TalkPageRevID = WIKI_UNKNOWN_REVID;
+            //! Time in ms since epoch when this entry was written
+            qint64 LastUpdate = 0;
+    };
+
+    /*!
+     * \brief Persistent store of user reputation, keyed by site and username
+     *
+     * The store is a hash table with fixed size records and open addressing that lives in a file
+     * which is memory mapped, so nothing needs to be loaded on startup and the data written
+     * during session are on disk even if huggle crashes. Records contain only a 64 bit hash of
+     * the key and a second independent check hash, usernames themselves are not stored.
+     *
+     * Readers never wait: if the table is being written or resized, Get just returns false as
+     * if the user wasn't known, so that it can be used from the thread that scores edits.
+     */
+    class HUGGLE_EX_CORE ReputationStore
+    {
+        public:
+            static ReputationStore *HuggleReputation;
+
+            ReputationStore();
+            ~ReputationStore();
+            /*!
+             * \brief Open the store, creating the file if it doesn't exist
+             * \param path Path to the file
+             * \param max_records Maximal number of users, once reached the users that were updated longest ago are dropped
+             * \return false if file couldn't be opened or mapped
+             */
+            bool Open(const QString &path, int max_records);
+            void Close();
+            bool IsOpen() const;
+            //! Retrieve an entry, returns false if user is not known or the store is busy
+            bool Get(WikiSite *site, const QString &user, ReputationStore_Entry *entry);
+            //! Insert or replace the entry for given user
+            bool Put(WikiSite *site, const QString &user, const ReputationStore_Entry &entry);
+            int Count();
+            int GetCapacity();
+            qint64 GetHits();
+            qint64 GetMisses();
+        private:
+            static quint64 keyHash(WikiSite *site, const QString &user, uint *check);
+            bool map();
+            bool resize(int capacity, bool drop_old);
+            //! Return index of slot with this key or of empty slot where it belongs, -1 if the table is full
+            int findSlot(quint64 hash, uint check);
+            QFile *file = nullptr;
+            uchar *data = nullptr;
+            QReadWriteLock *lock;
+            int maxRecords = 0;
+            //! Counters are updated by readers that share the lock, so they need to be atomic
+            QAtomicInt hits;
+            QAtomicInt misses;
+    };
+
+    inline bool ReputationStore::IsOpen() const
+    {
+        return this->data != nullptr;
+    }
+}
+
+#endif // REPUTATIONSTORE_HPP
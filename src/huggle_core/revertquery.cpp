@@ -248,22 +248,18 @@ QString RevertQuery::GetCustomRevertStatus(QueryResult *result_data, WikiSite *s
 void RevertQuery::preflightCheck()
 {
     // check if there is more edits in queue
-    int index=0;
     bool failed = false;
     bool made_by_same_user = true;
     // we only need to check this in case we aren't to revert last edit only
     if (!this->oneEditOnly)
     {
         WikiEdit::Lock_EditList->lock();
-        while (index < WikiEdit::EditList.count())
+        foreach (WikiEdit *w, WikiEdit::GetCachedEditsForPage(this->editToBeReverted->Page))
         {
-            WikiEdit *w = WikiEdit::EditList.at(index++);
             if (!w->IsPostProcessed())
                 continue;
             if (w != this->editToBeReverted)
             {
-                if (!w->Page->EqualTo(this->editToBeReverted->Page))
-                    continue;
                 if (w->Time > this->editToBeReverted->Time)
                 {
                     if (!w->User->EqualTo(this->editToBeReverted->User))
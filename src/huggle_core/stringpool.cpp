@@ -0,0 +1,102 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#include "stringpool.hpp"
+#include <QMutex>
+using namespace Huggle;
+
+QAtomicInteger<qint64> StringPool::totalBytesSaved(0);
+QAtomicInteger<qint64> StringPool::totalHits(0);
+
+StringPool::StringPool()
+{
+    this->lock = new QMutex(QMutex::Recursive);
+}
+
+StringPool::~StringPool()
+{
+    delete this->lock;
+}
+
+QString StringPool::Intern(const QString &string)
+{
+    if (string.isEmpty())
+        return string;
+    this->lock->lock();
+    QSet<QString>::const_iterator i = this->strings.constFind(string);
+    if (i != this->strings.constEnd())
+    {
+        QString shared = *i;
+        this->hits++;
+        StringPool::totalHits.fetchAndAddRelaxed(1);
+        // the copy that was passed to us can be released by caller now, unless it was already shared
+        if (shared.constData() != string.constData())
+        {
+            qint64 saved = string.size() * sizeof(QChar);
+            this->bytesSaved += saved;
+            StringPool::totalBytesSaved.fetchAndAddRelaxed(saved);
+        }
+        this->lock->unlock();
+        return shared;
+    }
+    this->misses++;
+    this->size += string.size() * sizeof(QChar);
+    this->strings.insert(string);
+    this->lock->unlock();
+    return string;
+}
+
+QStringList StringPool::Intern(const QStringList &list)
+{
+    QStringList result;
+    result.reserve(list.count());
+    foreach (QString item, list)
+        result.append(this->Intern(item));
+    return result;
+}
+
+void StringPool::Clear()
+{
+    this->lock->lock();
+    this->strings.clear();
+    this->size = 0;
+    this->lock->unlock();
+}
+
+qint64 StringPool::Trim()
+{
+    qint64 released = 0;
+    this->lock->lock();
+    QSet<QString>::iterator i = this->strings.begin();
+    while (i != this->strings.end())
+    {
+        // if the string is detached, the only reference to its data is the one held by pool
+        if (i->isDetached())
+        {
+            released += i->size() * sizeof(QChar);
+            i = this->strings.erase(i);
+        } else
+        {
+            ++i;
+        }
+    }
+    this->size -= released;
+    this->lock->unlock();
+    return released;
+}
+
+int StringPool::Count()
+{
+    this->lock->lock();
+    int result = this->strings.count();
+    this->lock->unlock();
+    return result;
+}
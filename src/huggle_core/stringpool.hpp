@@ -0,0 +1,107 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#ifndef STRINGPOOL_HPP
+#define STRINGPOOL_HPP
+
+#include "definitions.hpp"
+
+#include <QAtomicInteger>
+#include <QString>
+#include <QStringList>
+#include <QSet>
+
+class QMutex;
+
+namespace Huggle
+{
+    //! Table of interned strings
+
+    //! Titles, usernames, tags and namespace prefixes repeat a lot in the feed, every site
+    //! holds one of these pools so that equal strings share a single immutable buffer
+    //! instead of each edit holding its own copy. Strings returned by Intern() are
+    //! implicitly shared, so two interned strings with same value point to same data
+    //! and can be compared by pointer, see StringPool::Equal
+    class HUGGLE_EX_CORE StringPool
+    {
+        public:
+            //! Compare two strings, this is cheap for strings that were interned in same pool
+            static bool Equal(const QString &a, const QString &b);
+            //! Total number of bytes that were not allocated thanks to all pools
+            static qint64 GetTotalBytesSaved();
+            static qint64 GetTotalHits();
+            StringPool();
+            ~StringPool();
+            //! Returns a shared copy of string, if it's not in a pool yet, it's inserted
+            QString Intern(const QString &string);
+            QStringList Intern(const QStringList &list);
+            //! Removes all strings from the pool, this doesn't invalidate strings that were
+            //! already returned, they just stop being shared with future ones
+            void Clear();
+            //! Removes strings that are not used by anything but the pool itself, returns number of released bytes
+            qint64 Trim();
+            int Count();
+            //! Approximate size of all strings held by pool in bytes
+            qint64 GetSize();
+            qint64 GetHits();
+            qint64 GetMisses();
+            qint64 GetBytesSaved();
+        private:
+            // pools of all sites update these from feed and processor threads
+            static QAtomicInteger<qint64> totalBytesSaved;
+            static QAtomicInteger<qint64> totalHits;
+            QSet<QString> strings;
+            QMutex *lock;
+            qint64 size = 0;
+            qint64 hits = 0;
+            qint64 misses = 0;
+            qint64 bytesSaved = 0;
+    };
+
+    inline bool StringPool::Equal(const QString &a, const QString &b)
+    {
+        if (a.constData() == b.constData() && a.size() == b.size())
+            return true;
+        return a == b;
+    }
+
+    inline qint64 StringPool::GetTotalBytesSaved()
+    {
+        return StringPool::totalBytesSaved.load();
+    }
+
+    inline qint64 StringPool::GetTotalHits()
+    {
+        return StringPool::totalHits.load();
+    }
+
+    inline qint64 StringPool::GetSize()
+    {
+        return this->size;
+    }
+
+    inline qint64 StringPool::GetHits()
+    {
+        return this->hits;
+    }
+
+    inline qint64 StringPool::GetMisses()
+    {
+        return this->misses;
+    }
+
+    inline qint64 StringPool::GetBytesSaved()
+    {
+        return this->bytesSaved;
+    }
+}
+
+#endif // STRINGPOOL_HPP
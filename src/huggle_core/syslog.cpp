@@ -117,6 +117,30 @@ void Syslog::InsertToRingLog(const HuggleLog_Line& line)
     this->RingLog.append(line);
 }
 
+static qint64 GetLineMemoryUsage(const HuggleLog_Line &line)
+{
+    return sizeof(HuggleLog_Line) + (line.Text.size() + line.Date.size()) * sizeof(QChar);
+}
+
+qint64 Syslog::GetRingLogMemoryUsage()
+{
+    qint64 size = 0;
+    foreach (HuggleLog_Line line, this->RingLog)
+        size += GetLineMemoryUsage(line);
+    return size;
+}
+
+qint64 Syslog::TrimRingLog(qint64 bytes)
+{
+    qint64 released = 0;
+    while (released < bytes && !this->RingLog.isEmpty())
+    {
+        released += GetLineMemoryUsage(this->RingLog.at(0));
+        this->RingLog.removeAt(0);
+    }
+    return released;
+}
+
 QList<HuggleLog_Line> Syslog::RingLogToList()
 {
     QList<HuggleLog_Line> list;
@@ -110,6 +110,10 @@ namespace Huggle
             QStringList RingLogToQStringList();
             void InsertToRingLog(const HuggleLog_Line& line);
             QList<HuggleLog_Line> RingLogToList();
+            //! Approximate number of bytes held by ring log
+            qint64 GetRingLogMemoryUsage();
+            //! Remove oldest lines from ring log until at least given number of bytes is released
+            qint64 TrimRingLog(qint64 bytes);
             //! This is a list of logs that needs to be written, it exist so that logs can be written from
             //! other threads as well, writing to syslog from other thread would crash huggle
             QList<HuggleLog_Line> UnwrittenLogs;
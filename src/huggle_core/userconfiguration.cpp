@@ -237,6 +237,8 @@ QString UserConfiguration::MakeLocalUserConfig(ProjectConfiguration *Project)
     AppendComment(&configuration, "Get original creator of every page so that you can G7 instead of reverting the page");
     AppendConf(&configuration, "retrieve-founder", this->RetrieveFounder);
     AppendConf(&configuration, "display-title", this->DisplayTitle);
+    AppendComment(&configuration, "Display diffs using a native widget instead of the web browser, it's faster and needs less memory");
+    AppendConf(&configuration, "native-diff-view", this->NativeDiffView);
     AppendComment(&configuration, "Periodically check if you received new messages and display a notification box if you get them");
     AppendConf(&configuration, "check-tp", this->CheckTP);
     AppendConf(&configuration, "manual-warning", this->ManualWarning);
@@ -349,6 +351,7 @@ QString UserConfiguration::MakeLocalUserConfig(ProjectConfiguration *Project)
             configuration += "        nsfilter-user: \"" + Bool2ExcludeRequire(fltr->getIgnore_UserSpace()) + "\"\n";
             configuration += "        filter-talk: \"" + Bool2ExcludeRequire(fltr->getIgnoreTalk()) + "\"\n";
             configuration += "        filter-watched: \"" + Bool2ExcludeRequire(fltr->getIgnoreWatched()) + "\"\n";
+            configuration += "        filter-bad-range: \"" + Bool2ExcludeRequire(fltr->getIgnoreBadRange()) + "\"\n";
             configuration += "        filter-reverts: \"" + Bool2ExcludeRequire(fltr->getIgnoreReverts()) + "\"\n";
             configuration += "        ignored-tags: \"" + SanitizeString(fltr->GetIgnoredTags_CommaSeparated()) + "\"\n";
             configuration += "        required-tags: \"" + SanitizeString(fltr->GetRequiredTags_CommaSeparated()) + "\"\n";
@@ -406,6 +409,7 @@ bool UserConfiguration::Parse(const QString& config, ProjectConfiguration *Proje
     this->RevertOnMultipleEdits = SafeBool(ConfigurationParse("RevertOnMultipleEdits", config));
     ProjectConfig->EnableAll = SafeBool(ConfigurationParse("enable", config));
     ProjectConfig->Ignores = HuggleParser::ConfigurationParse_QL("ignore", config, ProjectConfig->Ignores);
+    ProjectConfig->RebuildIgnores();
     // this is a hack so that we can access this value more directly, it can't be changed in huggle
     // so there is no point in using a hash for it
     ProjectConfig->IPScore = this->SetOption(ProjectConfig_IPScore_Key, config, ProjectConfig->IPScore).toLongLong();
@@ -551,6 +555,7 @@ bool UserConfiguration::ParseYAML(const QString &config, ProjectConfiguration *P
     if (!YAML2Bool("enable", yaml, true))
         ProjectConfig->EnableAll = false;
     ProjectConfig->Ignores = YAML2QStringList("ignore", yaml, ProjectConfig->Ignores);
+    ProjectConfig->RebuildIgnores();
     // SetOption functions allow us to preserve information whether the value was changed or is default, this is there because some options
     // which are in project config can be overloaded by user config, but we only want to store them in user config if they were modified
     // by user, so that by default we are always using the project config version (unless user wanted to modify them)
@@ -586,6 +591,7 @@ bool UserConfiguration::ParseYAML(const QString &config, ProjectConfiguration *P
     ProjectConfig->ConfirmOnSelfRevs = YAML2Bool("confirm-self-revert", yaml, ProjectConfig->ConfirmOnSelfRevs);
     ProjectConfig->ConfirmWL = YAML2Bool("confirm-whitelist", yaml, ProjectConfig->ConfirmWL);
     this->DisplayTitle = YAML2Bool("display-title", yaml, this->DisplayTitle);
+    this->NativeDiffView = YAML2Bool("native-diff-view", yaml, this->NativeDiffView);
     this->TruncateEdits = YAML2Bool("truncate-edits", yaml, this->TruncateEdits);
     this->EnforceMonthsAsHeaders = YAML2Bool("enforce-months-as-headers", yaml, this->EnforceMonthsAsHeaders);
     this->HistoryLoad = YAML2Bool("history-load", yaml, this->HistoryLoad);
@@ -146,6 +146,8 @@ namespace Huggle
             bool                    ManualWarning = false;
             //! Large title of every page in top of diff
             bool                    DisplayTitle = false;
+            //! Diffs are painted by a lightweight native widget instead of the web browser
+            bool                    NativeDiffView = false;
             //! Result of "Stop feed, Remove old edits" in main form
             bool                    RemoveOldQueueEdits = false;
             //! Check for new messages on your talk page
@@ -178,7 +178,7 @@ PendingWarning *Warnings::WarnUser(const QString& warning_type, RevertQuery *dep
     message_text = Warnings::UpdateSharedIPTemplate(edit->User, message_text, edit->GetSite());
 
     // Create only - safety check for API in case that user didn't have a user talk page, we use this parameter for API so that is fails in case someone creates a talk page meanwhile
-    bool create_only = edit->User->TalkPage_GetContents().isEmpty();
+    bool create_only = !edit->User->TalkPage_Exists();
     if (hcfg->UserConfig->AutomaticallyWatchlistWarnedUsers)
         WikiUtil::Watchlist(edit->User->GetTalkPage());
     PendingWarning *pw = new PendingWarning(WikiUtil::MessageUser(edit->User, message_text, message_head, message_summary, true, dependency, false, hcfg->UserConfig->SectionKeep, false,
@@ -9,6 +9,7 @@
 //GNU General Public License for more details.
 
 #include "wikiedit.hpp"
+#include <QDataStream>
 #include <QMutex>
 #include <QUrl>
 #include "apiqueryresult.hpp"
@@ -17,6 +18,7 @@
 #include "core.hpp"
 #include "querypool.hpp"
 #include "exception.hpp"
+#include "hugglequeuefilter.hpp"
 #include "syslog.hpp"
 #include "mediawiki.hpp"
 #include "wikipage.hpp"
@@ -26,13 +28,26 @@
 #include "localization.hpp"
 
 using namespace Huggle;
+
+//! Maximal number of titles API accepts in one query for normal users
+#define HUGGLE_TP_BATCH_SIZE 50
 QList<WikiEdit*> WikiEdit::EditList;
 QMutex *WikiEdit::Lock_EditList = new QMutex(QMutex::Recursive);
+QMutex *WikiEdit::Lock_Text = new QMutex(QMutex::Recursive);
+qint64 WikiEdit::TalkPageDownloads = 0;
+qint64 WikiEdit::TalkPageRevisionChecks = 0;
+qint64 WikiEdit::TalkPageDownloadsAvoided = 0;
+qint64 WikiEdit::TalkPageBytes = 0;
+QMultiHash<revid_ht, WikiEdit*> WikiEdit::editsByRevID;
+QHash<WikiSite*, QHash<QString, QList<WikiEdit*> > > WikiEdit::editsByPage;
+QHash<WikiSite*, QList<WikiEdit*> > WikiEdit::pendingTalkPageChecks;
+QHash<WikiSite*, QList<WikiEdit*> > WikiEdit::pendingTalkPageDownloads;
 
 WikiEdit::WikiEdit()
 {
     this->Bot = false;
     this->User = nullptr;
+    this->Page = nullptr;
     this->IsMinor = false;
     this->NewPage = false;
     this->diffSize = 0;
@@ -68,6 +83,24 @@ WikiEdit::~WikiEdit()
 {
     WikiEdit::Lock_EditList->lock();
     WikiEdit::EditList.removeAll(this);
+    if (this->indexedRevID != WIKI_UNKNOWN_REVID)
+        WikiEdit::editsByRevID.remove(this->indexedRevID, this);
+    if (this->indexedSite != nullptr)
+    {
+        QHash<QString, QList<WikiEdit*> > &pages = WikiEdit::editsByPage[this->indexedSite];
+        QList<WikiEdit*> &edits = pages[this->indexedPage];
+        edits.removeOne(this);
+        if (edits.isEmpty())
+            pages.remove(this->indexedPage);
+        if (pages.isEmpty())
+            WikiEdit::editsByPage.remove(this->indexedSite);
+    }
+    // edit may be released while it's still waiting for its talk page to be requested
+    QHash<WikiSite*, QList<WikiEdit*> >::iterator pending;
+    for (pending = WikiEdit::pendingTalkPageChecks.begin(); pending != WikiEdit::pendingTalkPageChecks.end(); ++pending)
+        pending.value().removeAll(this);
+    for (pending = WikiEdit::pendingTalkPageDownloads.begin(); pending != WikiEdit::pendingTalkPageDownloads.end(); ++pending)
+        pending.value().removeAll(this);
     WikiEdit::Lock_EditList->unlock();
     if (this->Previous != nullptr && this->Next != nullptr)
     {
@@ -84,10 +117,43 @@ WikiEdit::~WikiEdit()
             this->Next->Previous = nullptr;
         }
     }
-    delete this->User;
+    WikiUser::Release(this->User);
     delete this->Page;
 }
 
+//! Find the page with given title in result of a query for multiple pages
+static ApiQueryResultNode *WikiEdit_FindPage(ApiQuery *query, QString title)
+{
+    title.replace("_", " ");
+    // mediawiki may normalize the title we requested in which case the page is listed under normalized title
+    foreach (ApiQueryResultNode *normalized, query->GetApiQueryResult()->GetNodes("n"))
+    {
+        if (normalized->GetAttribute("from").replace("_", " ") == title)
+        {
+            title = normalized->GetAttribute("to");
+            break;
+        }
+    }
+    foreach (ApiQueryResultNode *page, query->GetApiQueryResult()->GetNodes("page"))
+    {
+        if (page->GetAttribute("title") == title)
+            return page;
+    }
+    return nullptr;
+}
+
+static ApiQueryResultNode *WikiEdit_FindRevision(ApiQueryResultNode *page)
+{
+    if (page == nullptr)
+        return nullptr;
+    foreach (ApiQueryResultNode *revisions, page->ChildNodes)
+    {
+        if (revisions->Name == "revisions" && !revisions->ChildNodes.isEmpty())
+            return revisions->ChildNodes.at(0);
+    }
+    return nullptr;
+}
+
 bool WikiEdit::finalizePostProcessing()
 {
     if (this->processedByWorkerThread || !this->postProcessing)
@@ -170,14 +236,17 @@ bool WikiEdit::finalizePostProcessing()
             // we fetch the number of edits, registration and groups of user
             QList<ApiQueryResultNode*> user_data = this->qUser->GetApiQueryResult()->GetNodes("user");
             QList<ApiQueryResultNode*> group_data = this->qUser->GetApiQueryResult()->GetNodes("g");
+            long edit_count = -1;
+            QString registration;
+            QStringList groups;
             if (user_data.count() > 0)
             {
                 ApiQueryResultNode *user_info_ = user_data.at(0);
                 if (user_info_->Attributes.contains("editcount"))
                 {
-                    this->User->EditCount = user_info_->GetAttribute("editcount").toLong();
+                    edit_count = user_info_->GetAttribute("editcount").toLong();
                     // users with high number of edits aren't vandals
-                    this->RecordScore("EditScore", this->User->EditCount * this->GetSite()->ProjectConfig->EditScore);
+                    this->RecordScore("EditScore", edit_count * this->GetSite()->ProjectConfig->EditScore);
                 }
                 else
                 {
@@ -185,7 +254,7 @@ bool WikiEdit::finalizePostProcessing()
                 }
                 if (user_info_->Attributes.contains("registration"))
                 {
-                    this->User->RegistrationDate = user_info_->GetAttribute("registration");
+                    registration = user_info_->GetAttribute("registration");
                 }
                 else
                 {
@@ -198,13 +267,15 @@ bool WikiEdit::finalizePostProcessing()
                 ApiQueryResultNode *group = group_data.at(x);
                 QString gn = group->Value;
                 if (gn != "*" && gn != "user")
-                this->User->Groups.append(gn);
+                    groups.append(gn);
                 ++x;
             }
-            this->RecordScore("ScoreFlag", this->GetSite()->ProjectConfig->ScoreFlag * this->User->Groups.count());
+            // user is shared with other edits, so its groups are replaced rather than appended to
+            this->User->SetUserInfo(edit_count, registration, groups);
+            this->RecordScore("ScoreFlag", this->GetSite()->ProjectConfig->ScoreFlag * groups.count());
             // This check is already in post processing but we do it again, now against user group instead of edit flags
             // some bots like ClueBot, are in group but don't flag their edits as "bots"
-            if (this->User->Groups.contains("bot"))
+            if (groups.contains("bot"))
             {
                 // If it's a flagged bot we likely don't need to watch them
                 this->RecordScore("BotScore_flag", this->GetSite()->ProjectConfig->BotScore);
@@ -214,6 +285,27 @@ bool WikiEdit::finalizePostProcessing()
         }
     }
 
+    if (this->processingRevs && this->qTalkpage == nullptr)
+    {
+        // talk pages of all edits that are post processed in this moment are sent together
+        WikiEdit::sendTalkPageQueries(this->GetSite());
+    }
+
+    if (this->processingRevs && this->checkingTalkPageRevision)
+    {
+        if (!this->qTalkpage->IsProcessed())
+            return false;
+        this->checkingTalkPageRevision = false;
+        if (!this->talkPageIsCurrent())
+        {
+            // talk page changed, so we need to download it, that is batched with other downloads again
+            this->retrieveTalkPage();
+            return false;
+        }
+        WikiEdit::TalkPageDownloadsAvoided++;
+        this->processingRevs = false;
+    }
+
     if (this->processingRevs)
     {
         // check if api was processed
@@ -225,22 +317,13 @@ bool WikiEdit::finalizePostProcessing()
             Huggle::Syslog::HuggleLogs->Log(_l("wikiedit-tp-fail", this->User->GetTalk()));
         } else
         {
-            // parse the talk page now
-            QList<ApiQueryResultNode*> rev_ = this->qTalkpage->GetApiQueryResult()->GetNodes("rev");
-            QList<ApiQueryResultNode*> pages_ = this->qTalkpage->GetApiQueryResult()->GetNodes("page");
-            bool missing = false;
-            if (pages_.count() > 0)
-            {
-                ApiQueryResultNode *node = pages_.at(0);
-                if (node->Attributes.contains("missing"))
-                {
-                    missing = true;
-                }
-            }
+            // parse the talk page now, the query contains talk pages of other users as well
+            ApiQueryResultNode *page = WikiEdit_FindPage(this->qTalkpage, this->User->GetTalk());
+            ApiQueryResultNode *rv = WikiEdit_FindRevision(page);
+            bool missing = page != nullptr && page->Attributes.contains("missing");
             // get last id
-            if (!missing && rev_.count() > 0)
+            if (!missing && rv != nullptr)
             {
-                ApiQueryResultNode *rv = rev_.at(0);
                 if (!rv->Attributes.contains("timestamp"))
                 {
                     Huggle::Syslog::HuggleLogs->ErrorLog("Talk page timestamp of " + this->User->Username + " couldn't be retrieved, mediawiki returned no data for it");
@@ -252,12 +335,15 @@ bool WikiEdit::finalizePostProcessing()
                     // completely accurate but better than nothing
                     this->User->SetLastMessageTime(MediaWiki::FromMWTimestamp(this->TPRevBaseTime));
                 }
+                if (rv->Attributes.contains("revid"))
+                    this->User->TalkPageRevID = rv->GetAttribute("revid").toLongLong();
                 this->User->TalkPage_SetContents(rv->Value);
             } else
             {
                 if (missing)
                 {
                     // we set an empty talk page so that we know we do have the contents of this page
+                    this->User->TalkPageRevID = 0;
                     this->User->TalkPage_SetContents("");
                 } else
                 {
@@ -307,7 +393,7 @@ bool WikiEdit::finalizePostProcessing()
                 this->IsValid = false;
             }
             if (revision->Attributes.contains("revid"))
-                this->RevID = revision->GetAttribute("revid").toInt();
+                this->SetRevID(revision->GetAttribute("revid").toLongLong());
             if (revision->Attributes.contains("timestamp"))
                 this->Time = MediaWiki::FromMWTimestamp(revision->GetAttribute("timestamp"));
             if (revision->Attributes.contains("comment"))
@@ -318,7 +404,7 @@ bool WikiEdit::finalizePostProcessing()
                 if (tags->Name == "tags" && tags->ChildNodes.count())
                 {
                     foreach (ApiQueryResultNode *t, tags->ChildNodes)
-                        this->Tags.append(t->Value);
+                        this->Tags.append(this->GetSite()->Intern(t->Value));
                 }
             }
         }
@@ -513,6 +599,7 @@ static long ProcessWordsInWikiText(QStringList *list, const QString& text, QList
 void WikiEdit::ProcessWords()
 {
     QString text;
+    WikiEdit::Lock_Text->lock();
     if (this->DiffText_IsSplit)
         text = this->DiffText_New.toLower();
     else
@@ -521,6 +608,7 @@ void WikiEdit::ProcessWords()
     {
         text = this->Page->Contents.toLower();
     }
+    WikiEdit::Lock_Text->unlock();
     // we cache the project config pointer
     ProjectConfiguration *conf = this->GetSite()->GetProjectConfig();
     if (!this->Page->IsTalk())
@@ -556,6 +644,129 @@ void WikiEdit::RemoveFromHistoryChain()
     }
 }
 
+void WikiEdit::SetRevID(revid_ht revid)
+{
+    WikiEdit::Lock_EditList->lock();
+    if (this->indexedRevID != WIKI_UNKNOWN_REVID)
+        WikiEdit::editsByRevID.remove(this->indexedRevID, this);
+    this->RevID = revid;
+    this->indexedRevID = revid;
+    if (revid != WIKI_UNKNOWN_REVID)
+        WikiEdit::editsByRevID.insert(revid, this);
+    WikiEdit::Lock_EditList->unlock();
+}
+
+void WikiEdit::indexPage()
+{
+    if (this->Page == nullptr)
+        return;
+    WikiEdit::Lock_EditList->lock();
+    if (this->indexedSite != nullptr)
+    {
+        // already indexed
+        WikiEdit::Lock_EditList->unlock();
+        return;
+    }
+    this->indexedSite = this->Page->Site;
+    this->indexedPage = this->Page->SanitizedName();
+    QList<WikiEdit*> &edits = WikiEdit::editsByPage[this->indexedSite][this->indexedPage];
+    // keep the list ordered by revision so that newer edits are always in the end
+    int index = edits.count();
+    while (index > 0 && edits.at(index - 1)->RevID > this->RevID)
+        index--;
+    edits.insert(index, this);
+    WikiEdit::Lock_EditList->unlock();
+}
+
+void WikiEdit::CompressText()
+{
+    WikiEdit::Lock_Text->lock();
+    // edits that are still being processed need their text for scoring
+    if (this->memoryTier != MemoryTierActive || !this->IsPostProcessed())
+    {
+        WikiEdit::Lock_Text->unlock();
+        return;
+    }
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << this->DiffText << this->DiffText_New << this->DiffText_Old;
+    if (this->Page)
+        stream << this->Page->Contents;
+    else
+        stream << QString();
+    this->compressedText = qCompress(data);
+    this->DiffText.clear();
+    this->DiffText_New.clear();
+    this->DiffText_Old.clear();
+    if (this->Page)
+        this->Page->Contents.clear();
+    if (this->User)
+        this->User->TalkPage_Compress();
+    this->compressionTime = QDateTime::currentDateTime();
+    this->memoryTier = MemoryTierCompressed;
+    WikiEdit::Lock_Text->unlock();
+}
+
+bool WikiEdit::DecompressText()
+{
+    WikiEdit::Lock_Text->lock();
+    if (this->memoryTier != MemoryTierCompressed)
+    {
+        bool active = this->memoryTier == MemoryTierActive;
+        WikiEdit::Lock_Text->unlock();
+        return active;
+    }
+    QByteArray data = qUncompress(this->compressedText);
+    QDataStream stream(&data, QIODevice::ReadOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    QString contents;
+    stream >> this->DiffText >> this->DiffText_New >> this->DiffText_Old >> contents;
+    if (this->Page)
+        this->Page->Contents = contents;
+    this->compressedText.clear();
+    this->memoryTier = MemoryTierActive;
+    WikiEdit::Lock_Text->unlock();
+    return true;
+}
+
+void WikiEdit::DropText()
+{
+    WikiEdit::Lock_Text->lock();
+    this->DiffText.clear();
+    this->DiffText_New.clear();
+    this->DiffText_Old.clear();
+    if (this->Page)
+        this->Page->Contents.clear();
+    this->compressedText.clear();
+    // talk page of user stays compressed, because warnings depend on it and it's tiny compared to diffs
+    this->memoryTier = MemoryTierDropped;
+    WikiEdit::Lock_Text->unlock();
+}
+
+qint64 WikiEdit::GetTextMemoryUsage()
+{
+    WikiEdit::Lock_Text->lock();
+    qint64 size = (this->DiffText.size() + this->DiffText_New.size() + this->DiffText_Old.size()) * sizeof(QChar);
+    size += this->compressedText.size();
+    if (this->Page)
+        size += this->Page->Contents.size() * sizeof(QChar);
+    WikiEdit::Lock_Text->unlock();
+    if (this->User)
+        size += this->User->TalkPage_MemoryUsage();
+    return size;
+}
+
+qint64 WikiEdit::GetMemoryEstimate()
+{
+    qint64 size = sizeof(WikiEdit) + this->Summary.size() * sizeof(QChar);
+    if (this->Page)
+        size += sizeof(WikiPage) + this->Page->PageName.size() * sizeof(QChar);
+    if (this->User)
+        size += sizeof(WikiUser);
+    return size;
+}
+
 void WikiEdit::processCallback()
 {
     if (this->PostprocessCallback)
@@ -579,6 +790,88 @@ void WikiEdit::RecordScore(const QString& name, score_ht score)
      }
 }
 
+void WikiEdit::retrieveTalkPage()
+{
+    this->qTalkpage = nullptr;
+    WikiEdit::Lock_EditList->lock();
+    WikiEdit::pendingTalkPageDownloads[this->GetSite()].append(this);
+    WikiEdit::Lock_EditList->unlock();
+    WikiEdit::TalkPageDownloads++;
+}
+
+static void *WikiEdit_TalkPagesFinished(Query *query)
+{
+    // query is shared by many edits, so its size is counted here rather than by each of them
+    if (query->Result != nullptr)
+        WikiEdit::TalkPageBytes += query->Result->Data.size();
+    query->UnregisterConsumer(HUGGLECONSUMER_CALLBACK);
+    return nullptr;
+}
+
+void WikiEdit::sendTalkPageQueries(WikiSite *site)
+{
+    static QString check_options = QUrl::toPercentEncoding("ids|timestamp");
+    static QString download_options = QUrl::toPercentEncoding("ids|timestamp|user|comment|content");
+    QList<Collectable_SmartPtr<ApiQuery>> queries;
+    // edits in pending lists may be deleted by GC, so they are only touched while the lists are locked
+    WikiEdit::Lock_EditList->lock();
+    int type = 0;
+    while (type < 2)
+    {
+        QList<WikiEdit*> &pending = (type == 0) ? WikiEdit::pendingTalkPageChecks[site] : WikiEdit::pendingTalkPageDownloads[site];
+        while (!pending.isEmpty())
+        {
+            QList<WikiEdit*> batch = pending.mid(0, HUGGLE_TP_BATCH_SIZE);
+            pending = pending.mid(batch.count());
+            QStringList titles;
+            foreach (WikiEdit *edit, batch)
+                titles.append(edit->User->GetTalk());
+            titles.removeDuplicates();
+            Collectable_SmartPtr<ApiQuery> query = new ApiQuery(ActionQuery, site);
+            query->Parameters = "prop=revisions&rvprop=" + ((type == 0) ? check_options : download_options) + "&titles=" +
+                                QUrl::toPercentEncoding(titles.join("|"));
+            if (type == 0)
+                query->Target = "Checking revisions of " + QString::number(titles.count()) + " talk pages";
+            else
+                query->Target = "Retrieving " + QString::number(titles.count()) + " talk pages";
+            query->SuccessCallback = reinterpret_cast<Callback>(WikiEdit_TalkPagesFinished);
+            query->FailureCallback = reinterpret_cast<Callback>(WikiEdit_TalkPagesFinished);
+            foreach (WikiEdit *edit, batch)
+                edit->qTalkpage = query;
+            queries.append(query);
+        }
+        type++;
+    }
+    WikiEdit::Lock_EditList->unlock();
+    foreach (Collectable_SmartPtr<ApiQuery> query, queries)
+    {
+        HUGGLE_QP_APPEND(query);
+        query->Process();
+    }
+}
+
+bool WikiEdit::talkPageIsCurrent()
+{
+    if (this->qTalkpage->IsFailed())
+        return false;
+    ApiQueryResultNode *page = WikiEdit_FindPage(this->qTalkpage, this->User->GetTalk());
+    if (page == nullptr)
+        return false;
+    if (page->Attributes.contains("missing"))
+    {
+        // we know the page doesn't exist if we remembered revision 0
+        return this->User->TalkPageRevID == 0;
+    }
+    ApiQueryResultNode *rv = WikiEdit_FindRevision(page);
+    if (rv == nullptr || !rv->Attributes.contains("revid"))
+        return false;
+    if (rv->GetAttribute("revid").toLongLong() != this->User->TalkPageRevID)
+        return false;
+    if (rv->Attributes.contains("timestamp"))
+        this->TPRevBaseTime = rv->GetAttribute("timestamp");
+    return true;
+}
+
 void WikiEdit::PostProcess()
 {
     if (this->postProcessing)
@@ -601,10 +894,20 @@ void WikiEdit::PostProcess()
     // Send info to other functions
     Hooks::EditBeforePostProcess(this);
 #endif
-    this->qTalkpage = WikiUtil::RetrieveWikiPageContents(this->User->GetTalk(), this->GetSite());
-    HUGGLE_QP_APPEND(this->qTalkpage);
-    this->qTalkpage->Target = "Retrieving tp " + this->User->GetTalk();
-    this->qTalkpage->Process();
+    if (this->User->TalkPageRevID != WIKI_UNKNOWN_REVID)
+    {
+        // we already parsed the talk page of this user, either in this session or in previous one in which case the warning
+        // level was loaded from reputation store, so we only check if it changed since then
+        this->qTalkpage = nullptr;
+        WikiEdit::Lock_EditList->lock();
+        WikiEdit::pendingTalkPageChecks[this->GetSite()].append(this);
+        WikiEdit::Lock_EditList->unlock();
+        this->checkingTalkPageRevision = true;
+        WikiEdit::TalkPageRevisionChecks++;
+    } else
+    {
+        this->retrieveTalkPage();
+    }
     if (!this->NewPage)
     {
         // This query will fetch information about the revision(s) but not the diff itself
@@ -628,7 +931,11 @@ void WikiEdit::PostProcess()
         this->processingEditInfo = true;
 
         // This query will download the actual diff of edit
-        if (this->RevID != WIKI_UNKNOWN_REVID)
+        if (!this->Revisions.isEmpty() && this->OldID > 0)
+        {
+            // merged revisions are displayed as one diff from parent of first revision to the last one
+            this->qDifference = WikiUtil::APIRequest(ActionCompare, this->GetSite(), "fromrev=" + QString::number(this->OldID) + "&torev=" + QString::number(this->RevID), false, "Diff of " + this->Page->PageName);
+        } else if (this->RevID != WIKI_UNKNOWN_REVID)
         {
             if (!this->IsRangeOfEdits())
                 this->qDifference = WikiUtil::APIRequest(ActionCompare, this->GetSite(), "fromrev=" + QString::number(this->RevID) + "&torelative=" + this->DiffTo, false, "Diff of " + this->Page->PageName);
@@ -646,7 +953,9 @@ void WikiEdit::PostProcess()
         HUGGLE_QP_APPEND(this->qText);
         this->qText->Process();
     }
-    if (hcfg->UserConfig->RetrieveFounder)
+    // anonymous users from ranges with good reputation are unlikely to be vandals, so we don't spend queries on
+    // information about page that is not needed for scoring
+    if (hcfg->UserConfig->RetrieveFounder && !this->skipsFounder())
     {
         this->qFounder = new ApiQuery(ActionQuery, this->GetSite());
         this->qFounder->Parameters = "prop=revisions&titles=" + QUrl::toPercentEncoding(this->Page->PageName) + "&rvdir=newer&rvlimit=1&rvprop=" +
@@ -656,7 +965,7 @@ void WikiEdit::PostProcess()
         this->qFounder->Process();
     }
 
-    if (hcfg->SystemConfig_CatScansAndWatched)
+    if (hcfg->SystemConfig_CatScansAndWatched && !this->skipsCategoriesAndWatched())
     {
         this->qCategoriesAndWatched = new ApiQuery(ActionQuery, this->GetSite());
         this->qCategoriesAndWatched->Parameters = "prop=" + QUrl::toPercentEncoding("categories|info") + "&titles=" + QUrl::toPercentEncoding(this->Page->PageName) + "&inprop=watched";
@@ -674,7 +983,230 @@ void WikiEdit::PostProcess()
     this->qUser->Process();
 }
 
-Collectable_SmartPtr<WikiEdit> WikiEdit::FromCacheByRevID(revid_ht revid, const QString& prev)
+bool WikiEdit::skipsFounder()
+{
+    return this->User != nullptr && this->User->IsIP() && this->User->IsInGoodRange();
+}
+
+bool WikiEdit::skipsCategoriesAndWatched()
+{
+    if (this->Page == nullptr)
+        return false;
+    HuggleQueueFilter *filter = this->GetSite()->CurrentFilter;
+    if (filter != nullptr && filter->NeedsPageInfo())
+        return false;
+    return this->skipsFounder();
+}
+
+int WikiEdit::GetPostProcessQueryCount()
+{
+    // talk page, or check of its revision when it was retrieved before
+    int queries = 1;
+    if (!this->NewPage)
+        queries += 2;
+    else if (this->Page == nullptr || this->Page->Contents.isEmpty())
+        queries++;
+    if (hcfg->UserConfig->RetrieveFounder && !this->skipsFounder())
+        queries++;
+    if (hcfg->SystemConfig_CatScansAndWatched && !this->skipsCategoriesAndWatched())
+        queries++;
+    if (this->User != nullptr && !this->User->IsIP())
+        queries++;
+    return queries;
+}
+
+bool WikiEdit::MergeRevision(WikiEdit *edit)
+{
+    if (edit == nullptr)
+        throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
+    if (this->Status == StatusPostProcessed || this->postProcessing || edit->IsPostProcessed())
+        return false;
+    if (this->Page == nullptr || edit->Page == nullptr || this->User == nullptr || edit->User == nullptr)
+        return false;
+    if (this->GetSite() != edit->GetSite() || this->RevID == WIKI_UNKNOWN_REVID || edit->OldID != this->RevID)
+        return false;
+    if (this->Page->SanitizedName() != edit->Page->SanitizedName() || this->User->Username != edit->User->Username)
+        return false;
+
+    if (this->Revisions.isEmpty())
+    {
+        WikiEdit_Revision first;
+        first.RevID = this->RevID;
+        first.Summary = this->Summary;
+        first.Size = this->diffSize;
+        first.SizeIsKnown = this->SizeIsKnown;
+        first.IsMinor = this->IsMinor;
+        first.IsRevert = this->IsRevert;
+        first.Time = this->Time;
+        first.Tags = this->Tags;
+        this->Revisions.append(first);
+    }
+    WikiEdit_Revision revision;
+    revision.RevID = edit->RevID;
+    revision.Summary = edit->Summary;
+    revision.Size = edit->diffSize;
+    revision.SizeIsKnown = edit->SizeIsKnown;
+    revision.IsMinor = edit->IsMinor;
+    revision.IsRevert = edit->IsRevert;
+    revision.Time = edit->Time;
+    revision.Tags = edit->Tags;
+    this->Revisions.append(revision);
+
+    // OldID keeps the parent of first revision, so that diff covers all of them
+    this->SetRevID(edit->RevID);
+    this->Diff = edit->Diff;
+    this->Summary = edit->Summary;
+    this->Time = edit->Time;
+    this->SizeIsKnown = this->SizeIsKnown && edit->SizeIsKnown;
+    this->diffSize += edit->diffSize;
+    this->IsMinor = this->IsMinor && edit->IsMinor;
+    this->IsRevert = this->IsRevert || edit->IsRevert;
+    this->TrustworthEdit = this->TrustworthEdit && edit->TrustworthEdit;
+    this->EditMadeByHuggle = this->EditMadeByHuggle && edit->EditMadeByHuggle;
+    foreach (QString tag, edit->Tags)
+    {
+        if (!this->Tags.contains(tag))
+            this->Tags.append(tag);
+    }
+    this->FilterPropertiesStatus = -1;
+    return true;
+}
+
+void WikiEdit::WriteSnapshot(QDataStream &stream)
+{
+    if (this->Page == nullptr || this->User == nullptr)
+        throw new Huggle::NullPointerException("WikiEdit::Page or User", BOOST_CURRENT_FUNCTION);
+
+    stream << this->GetSite()->Name << this->Page->PageName << this->User->Username;
+    stream << this->RevID << this->OldID << this->Diff << this->DiffTo;
+    stream << static_cast<qint64>(this->Score) << static_cast<qint64>(this->GoodfaithScore);
+    stream << this->Summary << this->Time << static_cast<qint64>(this->diffSize) << this->SizeIsKnown;
+    stream << this->IsMinor << this->Bot << this->NewPage << this->IsRevert << this->TrustworthEdit << this->EditMadeByHuggle << this->OwnEdit;
+    stream << this->DiffText_IsSplit << this->ContentModel << this->Tags << this->ScoreWords << this->MetaLabels << this->PropertyBag;
+    stream << static_cast<qint32>(this->Revisions.count());
+    foreach (WikiEdit_Revision revision, this->Revisions)
+    {
+        stream << revision.RevID << revision.Summary << static_cast<qint64>(revision.Size) << revision.SizeIsKnown << revision.IsMinor
+               << revision.IsRevert << revision.Time << revision.Tags;
+    }
+    stream << static_cast<qint64>(this->User->GetBadnessScore(false)) << static_cast<qint32>(this->User->GetWarningLevel());
+    stream << static_cast<qint64>(this->User->EditCount) << this->User->RegistrationDate << this->User->Groups << this->User->IsBlocked;
+}
+
+QByteArray WikiEdit::GetSnapshotText(bool *compressed)
+{
+    QByteArray text;
+    *compressed = true;
+    WikiEdit::Lock_Text->lock();
+    if (this->memoryTier == MemoryTierCompressed)
+    {
+        text = this->compressedText;
+    } else if (this->memoryTier == MemoryTierActive)
+    {
+        // same layout as used by CompressText, so that DecompressText can read it
+        QDataStream text_stream(&text, QIODevice::WriteOnly);
+        text_stream.setVersion(QDataStream::Qt_5_0);
+        text_stream << this->DiffText << this->DiffText_New << this->DiffText_Old;
+        if (this->Page)
+            text_stream << this->Page->Contents;
+        else
+            text_stream << QString();
+        *compressed = false;
+    }
+    WikiEdit::Lock_Text->unlock();
+    return text;
+}
+
+WikiEdit *WikiEdit::ReadSnapshot(QDataStream &stream)
+{
+    QString site_name, page_name, user_name;
+    stream >> site_name >> page_name >> user_name;
+    WikiSite *site = nullptr;
+    foreach (WikiSite *project, hcfg->Projects)
+    {
+        if (project->Name == site_name)
+        {
+            site = project;
+            break;
+        }
+    }
+    // when the site isn't known the record still needs to be read in order to get to the next one
+    WikiEdit *edit = new WikiEdit();
+    revid_ht rev_id;
+    qint64 score, goodfaith, size, badness, edit_count;
+    qint32 revisions, warning_level;
+    stream >> rev_id >> edit->OldID >> edit->Diff >> edit->DiffTo;
+    stream >> score >> goodfaith;
+    stream >> edit->Summary >> edit->Time >> size >> edit->SizeIsKnown;
+    stream >> edit->IsMinor >> edit->Bot >> edit->NewPage >> edit->IsRevert >> edit->TrustworthEdit >> edit->EditMadeByHuggle >> edit->OwnEdit;
+    stream >> edit->DiffText_IsSplit >> edit->ContentModel >> edit->Tags >> edit->ScoreWords >> edit->MetaLabels >> edit->PropertyBag;
+    stream >> revisions;
+    while (revisions-- > 0 && stream.status() == QDataStream::Ok)
+    {
+        WikiEdit_Revision revision;
+        qint64 revision_size;
+        stream >> revision.RevID >> revision.Summary >> revision_size >> revision.SizeIsKnown >> revision.IsMinor >> revision.IsRevert
+               >> revision.Time >> revision.Tags;
+        revision.Size = static_cast<long>(revision_size);
+        edit->Revisions.append(revision);
+    }
+    QString registration;
+    QStringList groups;
+    bool blocked;
+    QByteArray text;
+    stream >> badness >> warning_level >> edit_count >> registration >> groups >> blocked >> text;
+    if (site == nullptr || stream.status() != QDataStream::Ok)
+    {
+        delete edit;
+        return nullptr;
+    }
+    edit->Page = new WikiPage(page_name, site);
+    edit->User = WikiUser::Acquire(user_name, site);
+    edit->SetRevID(rev_id);
+    edit->Score = static_cast<long>(score);
+    edit->GoodfaithScore = static_cast<long>(goodfaith);
+    edit->diffSize = static_cast<long>(size);
+    // reputation store may already know the user better than the snapshot, so we only raise the values
+    if (badness > edit->User->GetBadnessScore(false))
+        edit->User->SetBadnessScore(static_cast<long>(badness));
+    if (warning_level > edit->User->GetWarningLevel())
+        edit->User->SetWarningLevel(static_cast<byte_ht>(warning_level));
+    edit->User->RestoreUserInfo(static_cast<long>(edit_count), registration, groups, blocked);
+    switch (edit->User->GetWarningLevel())
+    {
+        case 0:
+            edit->CurrentUserWarningLevel = WarningLevelNone;
+            break;
+        case 1:
+            edit->CurrentUserWarningLevel = WarningLevel1;
+            break;
+        case 2:
+            edit->CurrentUserWarningLevel = WarningLevel2;
+            break;
+        case 3:
+            edit->CurrentUserWarningLevel = WarningLevel3;
+            break;
+        default:
+            edit->CurrentUserWarningLevel = WarningLevel4;
+            break;
+    }
+    if (text.isEmpty())
+    {
+        edit->memoryTier = MemoryTierDropped;
+    } else
+    {
+        // text stays compressed until the edit is displayed, most restored edits are never looked at
+        edit->compressedText = text;
+        edit->compressionTime = QDateTime::currentDateTime();
+        edit->memoryTier = MemoryTierCompressed;
+    }
+    edit->Status = StatusPostProcessed;
+    edit->processedByWorkerThread = true;
+    edit->indexPage();
+    return edit;
+}
+
+Collectable_SmartPtr<WikiEdit> WikiEdit::FromCacheByRevID(revid_ht revid, const QString& prev, WikiSite *site)
 {
     Collectable_SmartPtr<WikiEdit> e;
     if (revid == WIKI_UNKNOWN_REVID)
@@ -683,20 +1215,100 @@ Collectable_SmartPtr<WikiEdit> WikiEdit::FromCacheByRevID(revid_ht revid, const
         return e;
     }
     WikiEdit::Lock_EditList->lock();
-    int x = 0;
-    while (x < WikiEdit::EditList.count())
+    QMultiHash<revid_ht, WikiEdit*>::const_iterator i = WikiEdit::editsByRevID.constFind(revid);
+    while (i != WikiEdit::editsByRevID.constEnd() && i.key() == revid)
+    {
+        WikiEdit *edit = i.value();
+        ++i;
+        if (edit->RevID != revid || edit->DiffTo != prev)
+            continue;
+        if (site != nullptr && (edit->Page == nullptr || edit->Page->Site != site))
+            continue;
+        e = edit;
+        break;
+    }
+    WikiEdit::Lock_EditList->unlock();
+    return e;
+}
+
+QList<WikiEdit*> WikiEdit::GetCachedEditsForPage(WikiPage *page)
+{
+    QList<WikiEdit*> edits;
+    WikiEdit::Lock_EditList->lock();
+    QHash<WikiSite*, QHash<QString, QList<WikiEdit*> > >::const_iterator site = WikiEdit::editsByPage.constFind(page->Site);
+    if (site != WikiEdit::editsByPage.constEnd())
+        edits = site.value().value(page->SanitizedName());
+    WikiEdit::Lock_EditList->unlock();
+    return edits;
+}
+
+WikiEdit_MemoryUsage WikiEdit::GetMemoryUsage()
+{
+    WikiEdit_MemoryUsage usage;
+    WikiEdit::Lock_EditList->lock();
+    foreach (WikiEdit *edit, WikiEdit::EditList)
+    {
+        switch (edit->memoryTier)
+        {
+            case MemoryTierActive:
+                usage.ActiveEdits++;
+                usage.ActiveBytes += edit->GetTextMemoryUsage();
+                break;
+            case MemoryTierCompressed:
+                usage.CompressedEdits++;
+                usage.CompressedBytes += edit->GetTextMemoryUsage();
+                break;
+            case MemoryTierDropped:
+                usage.DroppedEdits++;
+                break;
+        }
+    }
+    WikiEdit::Lock_EditList->unlock();
+    return usage;
+}
+
+int WikiEdit::DropOldText(int max_age)
+{
+    if (max_age <= 0)
+        return 0;
+    int dropped = 0;
+    QDateTime limit = QDateTime::currentDateTime().addSecs(max_age * -60);
+    WikiEdit::Lock_EditList->lock();
+    foreach (WikiEdit *edit, WikiEdit::EditList)
     {
-        WikiEdit *edit = WikiEdit::EditList.at(x);
-        ++x;
-        if (edit->RevID == revid && edit->DiffTo == prev)
+        if (edit->memoryTier == MemoryTierCompressed && edit->compressionTime < limit)
         {
-            e = edit;
-            // let's return it
-            break;
+            edit->DropText();
+            dropped++;
         }
     }
     WikiEdit::Lock_EditList->unlock();
-    return e;
+    if (dropped)
+        HUGGLE_DEBUG("Dropped text of " + QString::number(dropped) + " old edits", 2);
+    return dropped;
+}
+
+qint64 WikiEdit::DropCompressedText(qint64 bytes)
+{
+    qint64 released = 0;
+    WikiEdit::Lock_EditList->lock();
+    QList<WikiEdit*> compressed;
+    foreach (WikiEdit *edit, WikiEdit::EditList)
+    {
+        if (edit->memoryTier == MemoryTierCompressed)
+            compressed.append(edit);
+    }
+    // oldest first
+    qSort(compressed.begin(), compressed.end(), [](WikiEdit *a, WikiEdit *b) { return a->compressionTime < b->compressionTime; });
+    foreach (WikiEdit *edit, compressed)
+    {
+        if (released >= bytes)
+            break;
+        released += edit->compressedText.size();
+        edit->DropText();
+    }
+    WikiEdit::Lock_EditList->unlock();
+    return released;
 }
 
 QString WikiEdit::GetPixmapFromEditType(EditType edit_type)
@@ -761,6 +1373,25 @@ bool WikiEdit::IsReady()
     return Hooks::EditCheckIfReady(this);
 }
 
+//! Score parts of edit that belong to single revision, suffix tells merged revisions apart from the last one
+static void WikiEdit_ScoreRevision(WikiEdit *edit, ProjectConfiguration *conf, const WikiEdit_Revision &revision, const QString &suffix)
+{
+    // reverts made by anons are very likely reverts to vandalism
+    if (revision.IsRevert && edit->User->IsIP())
+        edit->RecordScore("IPScore_talk" + suffix, conf->IPScore * 10);
+    if (revision.Size > 1200 || revision.Size < -1200)
+        edit->RecordScore("ScoreChange" + suffix, conf->ScoreChange);
+    foreach (QString tx, revision.Tags)
+    {
+        if (conf->ScoreTags.contains(tx))
+            edit->RecordScore("tag_" + tx + suffix, conf->ScoreTags[tx]);
+    }
+    if (revision.SizeIsKnown && revision.Size < (-1 * conf->LargeRemoval))
+        edit->RecordScore("ScoreRemoval" + suffix, conf->ScoreRemoval);
+    if (revision.Summary.isEmpty())
+        edit->RecordScore("NoSummary" + suffix, 10);
+}
+
 QMutex WikiEdit_ProcessorThread::EditLock(QMutex::Recursive);
 QList<WikiEdit*> WikiEdit_ProcessorThread::PendingEdits;
 
@@ -788,25 +1419,19 @@ void WikiEdit_ProcessorThread::Process(WikiEdit *edit)
     {
         bool IgnoreWords = false;
         ProjectConfiguration *conf = edit->GetSite()->GetProjectConfig();
-        if (edit->IsRevert)
+        if (edit->IsRevert && !edit->User->IsIP() && !edit->DiffText_IsSplit)
         {
-            if (edit->User->IsIP())
-            {
-                // Reverts made by anons are very likely reverts to vandalism
-                edit->RecordScore("IPScore_talk", conf->IPScore * 10);
-            } else
-            {
-                if (!edit->DiffText_IsSplit)
-                {
-                    // we have to ignore the score words here because there is always lot of them in revert text
-                    IgnoreWords = true;
-                }
-            }
+            // we have to ignore the score words here because there is always lot of them in revert text
+            IgnoreWords = true;
         }
         // score
         if (edit->User->IsIP())
         {
             edit->RecordScore("IPScore", conf->IPScore);
+            // other users from same range, this catches vandals who get new address with every edit
+            IPRangeStats range = edit->User->GetRangeStats();
+            if (range.Addresses > 0 && conf->IPRangeScore != 0)
+                edit->RecordScore("IPRangeScore", (range.Badness / range.Addresses) * conf->IPRangeScore / 100);
         }
         if (edit->Bot)
             edit->RecordScore("BotScore", conf->BotScore);
@@ -816,8 +1441,6 @@ void WikiEdit_ProcessorThread::Process(WikiEdit *edit)
             edit->RecordScore("UserPage", conf->ScoreUser);
         if (edit->Page->IsTalk())
             edit->RecordScore("ScoreTalk", conf->ScoreTalk);
-        if (edit->diffSize > 1200 || edit->diffSize < -1200)
-            edit->RecordScore("ScoreChange", conf->ScoreChange);
         if (edit->Page->IsUserpage())
             IgnoreWords = true;
         if (edit->User->IsWhitelisted())
@@ -825,16 +1448,31 @@ void WikiEdit_ProcessorThread::Process(WikiEdit *edit)
         edit->RecordScore("User_BadnessScore", edit->User->GetBadnessScore());
         if (!IgnoreWords)
             edit->ProcessWords();
-        foreach (QString tx, edit->Tags)
+        edit->User->ParseTP(QDate::currentDate());
+        // size, summary, tags and revert flag are scored for every revision, so that merging a run of edits
+        // neither hides them nor counts them twice, the last revision is scored under plain names
+        if (edit->Revisions.isEmpty())
+        {
+            WikiEdit_Revision single;
+            single.RevID = edit->RevID;
+            single.Summary = edit->Summary;
+            single.Size = edit->diffSize;
+            single.SizeIsKnown = edit->SizeIsKnown;
+            single.IsRevert = edit->IsRevert;
+            single.Tags = edit->Tags;
+            WikiEdit_ScoreRevision(edit, conf, single, "");
+        } else
         {
-            if (conf->ScoreTags.contains(tx))
-                edit->RecordScore("tag_" + tx, conf->ScoreTags[tx]);
+            int revision = 0;
+            while (revision < edit->Revisions.count())
+            {
+                const WikiEdit_Revision &merged = edit->Revisions.at(revision++);
+                QString suffix;
+                if (revision < edit->Revisions.count())
+                    suffix = "_" + QString::number(merged.RevID);
+                WikiEdit_ScoreRevision(edit, conf, merged, suffix);
+            }
         }
-        if (edit->SizeIsKnown && edit->diffSize < (-1 * conf->LargeRemoval))
-            edit->RecordScore("ScoreRemoval", conf->ScoreRemoval);
-        edit->User->ParseTP(QDate::currentDate());
-        if (edit->Summary.size() == 0)
-            edit->RecordScore("NoSummary", 10);
         int warning_level = edit->User->GetWarningLevel();
         if (warning_level > 0)
         {
@@ -866,5 +1504,6 @@ void WikiEdit_ProcessorThread::Process(WikiEdit *edit)
     // Hooks::EditAfterPostProcess(edit);
     edit->postProcessing = false;
     edit->processedByWorkerThread = true;
+    edit->indexPage();
     edit->Status = StatusPostProcessed;
 }
@@ -24,6 +24,8 @@
 #include "collectable_smartptr.hpp"
 #include "edittype.hpp"
 
+class QDataStream;
+
 namespace Huggle
 {
     enum WarningLevel
@@ -42,6 +44,42 @@ namespace Huggle
         StatusPostProcessed
     };
 
+    //! Tier in which the heavy text (diffs, page contents, talk page) of an edit is held
+    enum WEMemoryTier
+    {
+        //! Text is held as it was retrieved
+        MemoryTierActive,
+        //! Edit was already reviewed and the text is compressed
+        MemoryTierCompressed,
+        //! Text was released and needs to be retrieved from wiki again
+        MemoryTierDropped
+    };
+
+    //! Summary of memory that is held by edits in every tier
+    class HUGGLE_EX_CORE WikiEdit_MemoryUsage
+    {
+        public:
+            int ActiveEdits = 0;
+            qint64 ActiveBytes = 0;
+            int CompressedEdits = 0;
+            qint64 CompressedBytes = 0;
+            int DroppedEdits = 0;
+    };
+
+    //! One of the revisions that were merged into a single edit, see WikiEdit::MergeRevision
+    class HUGGLE_EX_CORE WikiEdit_Revision
+    {
+        public:
+            revid_ht RevID = 0;
+            QString Summary;
+            long Size = 0;
+            bool SizeIsKnown = false;
+            bool IsMinor = false;
+            bool IsRevert = false;
+            QDateTime Time;
+            QStringList Tags;
+    };
+
     class Query;
     class ApiQuery;
     class WikiPage;
@@ -81,17 +119,76 @@ namespace Huggle
             //! This function will return a constant (which needs to be generated runtime)
             //! which is used as "unknown time" in case we don't know the edit's time
             static QDateTime GetUnknownEditTime();
-            static Collectable_SmartPtr<WikiEdit> FromCacheByRevID(revid_ht revid, const QString& prev = "prev");
+            /*!
+             * \brief FromCacheByRevID returns an edit from cache of all edits in memory
+             * \param revid ID of revision
+             * \param prev DiffTo of edit
+             * \param site Site of edit, if it's NULL the edit from any site is returned
+             * \return Edit or NULL if there is no such an edit in memory
+             */
+            static Collectable_SmartPtr<WikiEdit> FromCacheByRevID(revid_ht revid, const QString& prev = "prev", WikiSite *site = nullptr);
+            /*!
+             * \brief GetCachedEditsForPage returns all post processed edits of a page that are in memory
+             * \param page Page, only title and site are compared
+             * \return List of edits ordered by revision ID, pointers are only valid while Lock_EditList is held
+             */
+            static QList<WikiEdit*> GetCachedEditsForPage(WikiPage *page);
             static QString GetPixmapFromEditType(EditType edit_type);
+            //! Walks through all edits in memory and sums up the size of text held in each tier
+            static WikiEdit_MemoryUsage GetMemoryUsage();
+            //! Drops the text of edits that are compressed for more than max_age minutes, returns number of dropped edits
+            static int DropOldText(int max_age);
+            //! Drops compressed text of oldest reviewed edits until at least given number of bytes is released
+            static qint64 DropCompressedText(qint64 bytes);
             //! This list contains reference to all existing edits in memory
             static QList<WikiEdit*> EditList;
             static QMutex *Lock_EditList;
+            //! Protects diff and page text while it's being compressed, restored or dropped, because processor thread may read it
+            static QMutex *Lock_Text;
+            //! Number of times the whole talk page of user was downloaded
+            static qint64 TalkPageDownloads;
+            //! Number of times only id of last revision of talk page was retrieved
+            static qint64 TalkPageRevisionChecks;
+            //! Number of revision checks which found out that talk page we have is current
+            static qint64 TalkPageDownloadsAvoided;
+            //! Bytes received by queries for talk pages
+            static qint64 TalkPageBytes;
 
             //! Creates a new empty wiki edit
             WikiEdit();
             ~WikiEdit() override;
             //! This function is called by internals of huggle
             void PostProcess(); 
+            //! Number of API queries that PostProcess would issue for this edit
+            int GetPostProcessQueryCount();
+            /*!
+             * \brief MergeRevision extends this edit with a revision that was made by same user to same page right after it
+             *
+             * The edit then represents all merged revisions, its RevID is the last one and the diff is
+             * retrieved from the parent of first revision to the last one. This can be only done before
+             * the edit is post processed.
+             * \param edit Pre processed edit whose OldID is RevID of this edit
+             * \return false if the edit can't be merged
+             */
+            bool MergeRevision(WikiEdit *edit);
+            //! Number of revisions this edit represents
+            int GetRevisionCount();
+            /*!
+             * \brief WriteSnapshot writes post processed edit including its scores and state of user, so that it can be restored in next session
+             *  The record must be followed by text returned by GetSnapshotText, compressed with qCompress if it isn't compressed yet
+             */
+            void WriteSnapshot(QDataStream &stream);
+            /*!
+             * \brief GetSnapshotText returns texts of edit for snapshot, empty array if they were dropped
+             * \param compressed Set to true if the data are already compressed, compression of the others is left to caller,
+             *  so that it doesn't need to happen on main thread
+             */
+            QByteArray GetSnapshotText(bool *compressed);
+            /*!
+             * \brief ReadSnapshot restores an edit that was written by WriteSnapshot
+             * \return Post processed edit or NULL if its site isn't loaded, in that case the record is skipped
+             */
+            static WikiEdit *ReadSnapshot(QDataStream &stream);
             WikiSite *GetSite();
             void SetSize(long size);
             long GetSize();
@@ -106,7 +203,22 @@ namespace Huggle
             //! Processes all score words in text
             void ProcessWords();
             void RecordScore(const QString& name, score_ht score);
+            //! Change the revision ID, this needs to be used instead of writing to RevID so that the edit can be found by FromCacheByRevID
+            void SetRevID(revid_ht revid);
             void RemoveFromHistoryChain();
+            //! Compress the text of this edit, this is done once the edit leaves the active queue
+            void CompressText();
+            //! Restore the text that was compressed, in case it was dropped this returns false and
+            //! text needs to be retrieved from the wiki again
+            bool DecompressText();
+            //! Release the text completely
+            void DropText();
+            WEMemoryTier GetMemoryTier();
+            //! Approximate number of bytes held by diff, page and talk page text of this edit
+            qint64 GetTextMemoryUsage();
+            //! Approximate number of bytes held by this edit, including page and user, but without any text that
+            //! is returned by GetTextMemoryUsage, compressed text is accounted for by the edit cache of memory budget
+            qint64 GetMemoryEstimate();
             QString ContentModel;
             //! Page that was changed by edit
             WikiPage *Page;
@@ -123,10 +235,16 @@ namespace Huggle
             //! Diff id - this is probably same as RevID and can be safely removed
             revid_ht Diff;
             bool IsValid = true;
+            //! Mask of HuggleQueueFilterProperty flags, see HuggleQueueFilter::GetProperties
+            quint32 FilterProperties = 0;
+            //! Status of edit when FilterProperties were computed, -1 if they weren't computed yet
+            int FilterPropertiesStatus = -1;
+            //! Generation of HuggleQueueFilter properties in which FilterProperties were computed
+            int FilterPropertiesGeneration = -1;
             //! Old id
             revid_ht OldID;
             bool IsRevert;
-            //! Revision ID
+            //! Revision ID, use SetRevID to change it
             revid_ht RevID;
             //! Indicator whether the edit was processed or not
             WEStatus Status;
@@ -169,14 +287,38 @@ namespace Huggle
             //! List of parsed score words which were found in this edit
             QStringList ScoreWords;
             QDateTime Time;
+            //! All revisions that were merged into this edit, oldest first, empty if edit represents only one revision
+            QList<WikiEdit_Revision> Revisions;
         protected:
+            //! Index of EditList by revision ID, it's protected by Lock_EditList
+            static QMultiHash<revid_ht, WikiEdit*> editsByRevID;
+            //! Index of post processed edits by site and sanitized page title, it's protected by Lock_EditList
+            static QHash<WikiSite*, QHash<QString, QList<WikiEdit*> > > editsByPage;
+            //! Edits waiting for revision check of talk page of their user, it's protected by Lock_EditList
+            static QHash<WikiSite*, QList<WikiEdit*> > pendingTalkPageChecks;
+            //! Edits waiting for download of talk page of their user, it's protected by Lock_EditList
+            static QHash<WikiSite*, QList<WikiEdit*> > pendingTalkPageDownloads;
+            //! Send the pending checks and downloads of talk pages on this site, talk pages of many users are requested by one query
+            static void sendTalkPageQueries(WikiSite *site);
+            //! Insert this edit to editsByPage, this is called when edit is post processed
+            void indexPage();
             void processCallback();
             //! This function is called by core
             bool finalizePostProcessing();
+            //! Schedule download of whole talk page of user, it's sent together with other talk pages by sendTalkPageQueries
+            void retrieveTalkPage();
+            //! Returns true if the revision check of talk page found same revision as the one we have
+            bool talkPageIsCurrent();
+            //! Returns true if founder of page doesn't need to be retrieved, because edit was made from IP range with good reputation
+            bool skipsFounder();
+            //! Same as skipsFounder but for categories and watched status, these are still retrieved when queue filter needs them
+            bool skipsCategoriesAndWatched();
             bool processingByWorkerThread;
             bool processingRevs;
             bool processingEditInfo;
             bool processingDiff = false;
+            //! qTalkpage is only checking the id of last revision of talk page
+            bool checkingTalkPageRevision = false;
             //! This variable is used by worker thread and needs to be public so that it is working
             bool postProcessing;
             //! This variable is used by worker thread and needs to be public so that it is working
@@ -192,6 +334,16 @@ namespace Huggle
             Collectable_SmartPtr<ApiQuery> qCategoriesAndWatched;
             //! Size of change of edit
             long diffSize;
+            //! Revision ID under which this edit is stored in editsByRevID
+            revid_ht indexedRevID = WIKI_UNKNOWN_REVID;
+            //! Site and title under which this edit is stored in editsByPage
+            WikiSite *indexedSite = nullptr;
+            QString indexedPage;
+            WEMemoryTier memoryTier = MemoryTierActive;
+            //! Compressed copy of diff and page text in case the edit is in compressed tier
+            QByteArray compressedText;
+            //! Time when the text was compressed, used to figure out when to drop it
+            QDateTime compressionTime;
             friend class WikiEdit_ProcessorThread;
             friend class MainWindow;
     };
@@ -206,6 +358,18 @@ namespace Huggle
         return (this->Status == StatusPostProcessed);
     }
 
+    inline WEMemoryTier WikiEdit::GetMemoryTier()
+    {
+        return this->memoryTier;
+    }
+
+    inline int WikiEdit::GetRevisionCount()
+    {
+        if (this->Revisions.isEmpty())
+            return 1;
+        return this->Revisions.count();
+    }
+
     inline long WikiEdit::GetSize()
     {
         return this->diffSize;
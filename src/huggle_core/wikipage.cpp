@@ -11,6 +11,7 @@
 #include "wikipage.hpp"
 #include <QUrl>
 #include "exception.hpp"
+#include "hugglequeuefilter.hpp"
 #include "wikisite.hpp"
 #include "localization.hpp"
 using namespace Huggle;
@@ -26,10 +27,10 @@ WikiPage::WikiPage(WikiSite *site) : MediaWikiObject(site)
 
 WikiPage::WikiPage(const QString &name, WikiSite *site) : MediaWikiObject(site)
 {
-    this->PageName = name;
     this->Contents = "";
     if (!this->Site)
         throw new Huggle::NullPointerException("local Site", BOOST_CURRENT_FUNCTION);
+    this->PageName = this->Site->Intern(name);
     this->NS = this->Site->RetrieveNSFromTitle(this->PageName);
 }
 
@@ -84,7 +85,21 @@ QString WikiPage::GetFounder()
 
 bool WikiPage::EqualTo(WikiPage *page)
 {
-    return this->Site == page->Site && this->SanitizedName() == page->SanitizedName();
+    if (this->Site != page->Site)
+        return false;
+    // interned titles share the buffer so that this is usually just a pointer compare
+    if (StringPool::Equal(this->PageName, page->PageName))
+        return true;
+    return this->SanitizedName() == page->SanitizedName();
+}
+
+void WikiPage::SetWatched(bool value)
+{
+    if (this->watched == value)
+        return;
+    this->watched = value;
+    // edits of this page may match the watched filter now
+    HuggleQueueFilter::InvalidateProperties();
 }
 
 void WikiPage::SetFounder(const QString &name)
@@ -99,10 +99,6 @@ namespace Huggle
         return this->watched;
     }
 
-    inline void WikiPage::SetWatched(bool value)
-    {
-        this->watched = value;
-    }
 }
 
 #endif // WIKIPAGE_H
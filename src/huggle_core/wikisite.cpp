@@ -12,6 +12,7 @@
 #include "wikisite.hpp"
 #include "configuration.hpp"
 #include "exception.hpp"
+#include "huggleparser.hpp"
 #include "syslog.hpp"
 using namespace Huggle;
 
@@ -46,6 +47,8 @@ WikiPageNS::WikiPageNS(WikiPageNS *k)
 
 WikiSite::WikiSite(const WikiSite &w)
 {
+    this->Strings = new StringPool();
+    this->IPRanges = new IPRangeTrie();
     QList<int> k_ = w.NamespaceList.keys();
     foreach (int x, k_)
         this->NamespaceList.insert(x, new WikiPageNS(w.NamespaceList[x]));
@@ -66,6 +69,8 @@ WikiSite::WikiSite(const WikiSite &w)
 
 WikiSite::WikiSite(WikiSite *w)
 {
+    this->Strings = new StringPool();
+    this->IPRanges = new IPRangeTrie();
     QList<int> k_ = w->NamespaceList.keys();
     foreach (int x, k_)
         this->NamespaceList.insert(x, new WikiPageNS(w->NamespaceList[x]));
@@ -86,6 +91,8 @@ WikiSite::WikiSite(WikiSite *w)
 
 WikiSite::WikiSite(const QString &name, const QString &url)
 {
+    this->Strings = new StringPool();
+    this->IPRanges = new IPRangeTrie();
     this->CurrentFilter = HuggleQueueFilter::DefaultFilter;
     this->LongPath = "wiki/";
     this->Name = name;
@@ -100,6 +107,8 @@ WikiSite::WikiSite(const QString &name, const QString &url)
 WikiSite::WikiSite(const QString &name, const QString &url, const QString &path, const QString &script, bool https, bool oauth, const QString &channel, const QString &wl, const QString &han, bool isrtl)
 {
     Q_UNUSED(oauth);
+    this->Strings = new StringPool();
+    this->IPRanges = new IPRangeTrie();
     this->CurrentFilter = HuggleQueueFilter::DefaultFilter;
     this->IRCChannel = channel;
     this->LongPath = path;
@@ -115,9 +124,12 @@ WikiSite::WikiSite(const QString &name, const QString &url, const QString &path,
 
 WikiSite::~WikiSite()
 {
+    HuggleParser::ReleaseSite(this);
     this->ClearNS();
     delete this->ProjectConfig;
     delete this->UserConfig;
+    delete this->Strings;
+    delete this->IPRanges;
 }
 
 WikiPageNS *WikiSite::RetrieveNSFromTitle(const QString &title)
@@ -186,6 +198,8 @@ void WikiSite::InsertNS(WikiPageNS *Ns)
         Syslog::HuggleLogs->WarningLog("Ignoring multiple definitions of namespace " + QString::number(Ns->GetID()) + " mw bug?");
         return;
     }
+    Ns->localizedName = this->Intern(Ns->localizedName);
+    Ns->canonicalName = this->Intern(Ns->canonicalName);
     this->NamespaceList.insert(Ns->GetID(), Ns);
 }
 
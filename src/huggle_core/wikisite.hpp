@@ -15,7 +15,9 @@
 
 #include <QString>
 #include <QHash>
+#include "iprangetrie.hpp"
 #include "projectconfiguration.hpp"
+#include "stringpool.hpp"
 #include "userconfiguration.hpp"
 #include "version.hpp"
 
@@ -36,6 +38,7 @@ namespace Huggle
             bool IsTalkPage();
             int GetID();
         private:
+            friend class WikiSite;
             QString localizedName;
             QString canonicalName;
             bool isTalk;
@@ -105,6 +108,8 @@ namespace Huggle
             void InsertNS(WikiPageNS *Ns);
             void RemoveNS(int ns);
             void ClearNS();
+            //! Returns a shared instance of string from the string pool of this site
+            QString Intern(const QString &string);
             HuggleQueueFilter *CurrentFilter = nullptr;
             //! If this is true it shouldn't be possible to login to wiki without SSL, it may be needed for some WMF sites which now require SSL
             bool ForceSSL = false;
@@ -133,7 +138,16 @@ namespace Huggle
             //! Whether the site supports the ssl
             bool SupportHttps;
             bool IsRightToLeft = false;
+            //! Pool of titles, usernames, tags and namespace prefixes used on this site
+            StringPool *Strings;
+            //! Badness and warnings of anonymous users aggregated per IP range
+            IPRangeTrie *IPRanges;
     };
+
+    inline QString WikiSite::Intern(const QString &string)
+    {
+        return this->Strings->Intern(string);
+    }
 }
 
 #endif // WIKISITE_H
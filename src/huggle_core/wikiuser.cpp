@@ -10,6 +10,7 @@
 
 #include "wikiuser.hpp"
 #include <QMutex>
+#include <QElapsedTimer>
 #include "configuration.hpp"
 #include "projectconfiguration.hpp"
 #include "exception.hpp"
@@ -17,25 +18,22 @@
 #include "localization.hpp"
 #include "hooks.hpp"
 #include "huggleprofiler.hpp"
+#include "hugglequeuefilter.hpp"
+#include "ipaddress.hpp"
+#include "reputationstore.hpp"
 #include "syslog.hpp"
 #include "wikipage.hpp"
 #include "wikisite.hpp"
 using namespace Huggle;
 
-//QRegExp WikiUser::IPv4Regex("^(?:[0-9]{1,3}\\.){3}[0-9]{1,3}$");
-QRegExp WikiUser::IPv4Regex(R"(\b((25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)(\.|$)){4}\b)");
-QRegExp WikiUser::IPv6Regex("(([0-9a-fA-F]{1,4}:){7,7}[0-9a-fA-F]{1,4}|([0-9a-fA-F]{1,4}:){1,7}:|([0-9a-fA-F]"\
-                            "{1,4}:){1,6}:[0-9a-fA-F]{1,4}|([0-9a-fA-F]{1,4}:){1,5}(:[0-9a-fA-F]{1,4}){1,2}|("\
-                            "[0-9a-fA-F]{1,4}:){1,4}(:[0-9a-fA-F]{1,4}){1,3}|([0-9a-fA-F]{1,4}:){1,3}(:[0-9a-"\
-                            "fA-F]{1,4}){1,4}|([0-9a-fA-F]{1,4}:){1,2}(:[0-9a-fA-F]{1,4}){1,5}|[0-9a-fA-F]{1,"\
-                            "4}:((:[0-9a-fA-F]{1,4}){1,6})|:((:[0-9a-fA-F]{1,4}){1,7}|:)|fe80:(:[0-9a-fA-F]{0"\
-                            ",4}){0,4}%[0-9a-zA-Z]{1,}|::(ffff(:0{1,4}){0,1}:){0,1}((25[0-5]|(2[0-4]|1{0,1}[0"\
-                            "-9]){0,1}[0-9]).){3,3}(25[0-5]|(2[0-4]|1{0,1}[0-9]){0,1}[0-9])|([0-9a-fA-F]{1,4}"\
-                            ":){1,4}:((25[0-5]|(2[0-4]|1{0,1}[0-9]){0,1}[0-9]).){3,3}(25[0-5]|(2[0-4]|1{0,1}["\
-                            "0-9]){0,1}[0-9]))");
-QList<WikiUser*> WikiUser::ProblematicUsers;
+QHash<QPair<WikiSite*, QString>, WikiUser*> WikiUser::ProblematicUsers;
 QMutex WikiUser::ProblematicUserListLock(QMutex::Recursive);
+qint64 WikiUser::ProblematicUsersLookups = 0;
+qint64 WikiUser::ProblematicUsersLookupTime = 0;
+qint64 WikiUser::ProblematicUsersEvicted = 0;
 QDateTime WikiUser::InvalidTime = QDateTime::fromMSecsSinceEpoch(2);
+QHash<QPair<WikiSite*, QString>, WikiUser*> WikiUser::SharedUsers;
+QMutex WikiUser::SharedUsersLock(QMutex::Recursive);
 
 WikiUser *WikiUser::RetrieveUser(WikiUser *user)
 {
@@ -45,38 +43,120 @@ WikiUser *WikiUser::RetrieveUser(WikiUser *user)
 WikiUser *WikiUser::RetrieveUser(const QString &user, WikiSite *site)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    QElapsedTimer timer;
+    timer.start();
     WikiUser::ProblematicUserListLock.lock();
-    foreach (WikiUser *user_, WikiUser::ProblematicUsers)
+    WikiUser *user_ = WikiUser::ProblematicUsers.value(WikiUser::problematicUserKey(user, site), nullptr);
+    if (user_ != nullptr)
+        user_->lastAccess = QDateTime::currentMSecsSinceEpoch();
+    WikiUser::ProblematicUsersLookups++;
+    WikiUser::ProblematicUsersLookupTime += timer.nsecsElapsed();
+    WikiUser::ProblematicUserListLock.unlock();
+    return user_;
+}
+
+WikiUser *WikiUser::Acquire(const QString &user, WikiSite *site)
+{
+    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    if (user.isEmpty())
+        return new WikiUser(user, site);
+    QPair<WikiSite*, QString> key = WikiUser::problematicUserKey(user, site);
+    WikiUser::SharedUsersLock.lock();
+    WikiUser *shared = WikiUser::SharedUsers.value(key, nullptr);
+    if (shared != nullptr)
+    {
+        shared->sharedRefs++;
+        WikiUser::SharedUsersLock.unlock();
+        return shared;
+    }
+    WikiUser::SharedUsersLock.unlock();
+    // constructor looks into list of problematic users, so we don't want to do that with shared list locked
+    WikiUser *created = new WikiUser(user, site);
+    WikiUser::SharedUsersLock.lock();
+    shared = WikiUser::SharedUsers.value(key, nullptr);
+    if (shared == nullptr)
     {
-        if (site == user_->Site && user == user_->Username)
+        shared = created;
+        WikiUser::SharedUsers.insert(key, shared);
+    } else
+    {
+        // other thread was faster
+        delete created;
+    }
+    shared->sharedRefs++;
+    WikiUser::SharedUsersLock.unlock();
+    return shared;
+}
+
+void WikiUser::Release(WikiUser *user)
+{
+    if (user == nullptr)
+        return;
+    WikiUser::SharedUsersLock.lock();
+    if (user->sharedRefs > 0)
+    {
+        if (--user->sharedRefs > 0)
         {
-            WikiUser::ProblematicUserListLock.unlock();
-            return user_;
+            WikiUser::SharedUsersLock.unlock();
+            return;
         }
+        QPair<WikiSite*, QString> key = WikiUser::problematicUserKey(user->Username, user->GetSite());
+        if (WikiUser::SharedUsers.value(key, nullptr) == user)
+            WikiUser::SharedUsers.remove(key);
     }
-    WikiUser::ProblematicUserListLock.unlock();
-    return nullptr;
+    WikiUser::SharedUsersLock.unlock();
+    delete user;
+}
+
+static bool WikiUser_TrimLessThan(WikiUser *a, WikiUser *b)
+{
+    // users that are least useful go first
+    if (a->GetWarningLevel() != b->GetWarningLevel())
+        return a->GetWarningLevel() < b->GetWarningLevel();
+    if (a->GetBadnessScore(false) != b->GetBadnessScore(false))
+        return a->GetBadnessScore(false) < b->GetBadnessScore(false);
+    return a->LastAccess() < b->LastAccess();
 }
 
 void WikiUser::TrimProblematicUsersList()
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
     WikiUser::ProblematicUserListLock.lock();
-    int i = 0;
-    while (i < WikiUser::ProblematicUsers.count())
+    QHash<QPair<WikiSite*, QString>, WikiUser*>::iterator i = WikiUser::ProblematicUsers.begin();
+    while (i != WikiUser::ProblematicUsers.end())
     {
-        WikiUser *user = WikiUser::ProblematicUsers.at(i);
+        WikiUser *user = i.value();
         if (!user)
             throw new Huggle::NullPointerException("WikiUser user", BOOST_CURRENT_FUNCTION);
         if (user->GetBadnessScore(false) == 0 && user->warningLevel == 0)
         {
             // there is no point to hold information for them
-            WikiUser::ProblematicUsers.removeAt(i);
+            i = WikiUser::ProblematicUsers.erase(i);
+            if (user->IsIP())
+                user->GetSite()->IPRanges->Remove(user->Username);
             delete user;
             continue;
         }
         ++i;
     }
+    int max = hcfg->SystemConfig_ProblematicUsersMax;
+    if (max > 0 && WikiUser::ProblematicUsers.count() > max)
+    {
+        QList<WikiUser*> users = WikiUser::ProblematicUsers.values();
+        qSort(users.begin(), users.end(), WikiUser_TrimLessThan);
+        int remove = users.count() - max;
+        int x = 0;
+        while (x < remove)
+        {
+            WikiUser *user = users.at(x++);
+            WikiUser::ProblematicUsers.remove(WikiUser::problematicUserKey(user->Username, user->Site));
+            if (user->IsIP())
+                user->GetSite()->IPRanges->Remove(user->Username);
+            delete user;
+        }
+        WikiUser::ProblematicUsersEvicted += remove;
+        HUGGLE_DEBUG("Removed " + QString::number(remove) + " users from list of problematic users", 2);
+    }
     WikiUser::ProblematicUserListLock.unlock();
 }
 
@@ -85,36 +165,50 @@ void WikiUser::UpdateUser(WikiUser *us)
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
     WikiUser::ProblematicUserListLock.lock();
     WikiUser::UpdateWl(us, us->GetBadnessScore(false));
-    foreach (WikiUser *user, WikiUser::ProblematicUsers)
+    QPair<WikiSite*, QString> key = WikiUser::problematicUserKey(us->Username, us->Site);
+    WikiUser *user = WikiUser::ProblematicUsers.value(key, nullptr);
+    if (user != nullptr)
     {
-        if (user->Username == us->Username)
+        user->lastAccess = QDateTime::currentMSecsSinceEpoch();
+        user->BadnessScore = us->BadnessScore;
+        if (user->warningLevel != us->warningLevel)
         {
-            user->BadnessScore = us->BadnessScore;
-            if (user->warningLevel != us->warningLevel)
-            {
-                user->warningLevel = us->warningLevel;
-                Hooks::WikiUser_Updated(us);
-            }
-            user->whitelistInfo = us->whitelistInfo;
-            if (us->IsReported)
-            {
-                user->IsReported = true;
-            }
-            user->talkPageWasRetrieved = us->talkPageWasRetrieved;
-            user->dateOfTalkPage = us->dateOfTalkPage;
-            user->contentsOfTalkPage = us->contentsOfTalkPage;
-            user->LastMessageTime = us->LastMessageTime;
-            user->LastMessageTimeKnown = us->LastMessageTimeKnown;
-            if (!us->IsIP() && user->EditCount < 0)
-            {
-                user->EditCount = us->EditCount;
-            }
-            WikiUser::ProblematicUserListLock.unlock();
-            return;
+            user->warningLevel = us->warningLevel;
+            Hooks::WikiUser_Updated(us);
+        }
+        user->whitelistInfo = us->whitelistInfo;
+        if (us->IsReported)
+        {
+            user->IsReported = true;
         }
+        user->talkPageWasRetrieved = us->talkPageWasRetrieved;
+        user->dateOfTalkPage = us->dateOfTalkPage;
+        user->contentsOfTalkPage = us->contentsOfTalkPage;
+        user->compressedTalkPage = us->compressedTalkPage;
+        user->LastMessageTime = us->LastMessageTime;
+        user->LastMessageTimeKnown = us->LastMessageTimeKnown;
+        if (us->TalkPageRevID != WIKI_UNKNOWN_REVID)
+            user->TalkPageRevID = us->TalkPageRevID;
+        if (!us->IsIP() && user->EditCount < 0)
+        {
+            user->EditCount = us->EditCount;
+        }
+        if (us->IsIP())
+            us->GetSite()->IPRanges->Update(us->Username, us->BadnessScore, us->warningLevel);
+        // store may need to resize or rewrite its file, so a copy is written once the list is unlocked,
+        // the user in list may be deleted by another thread in meantime
+        WikiUser stored(user);
+        WikiUser::ProblematicUserListLock.unlock();
+        WikiUser::storeReputation(&stored);
+        return;
     }
-    ProblematicUsers.append(new WikiUser(us));
+    user = new WikiUser(us);
+    user->lastAccess = QDateTime::currentMSecsSinceEpoch();
+    WikiUser::ProblematicUsers.insert(key, user);
+    if (us->IsIP())
+        us->GetSite()->IPRanges->Update(us->Username, us->BadnessScore, us->warningLevel);
     WikiUser::ProblematicUserListLock.unlock();
+    WikiUser::storeReputation(us);
 
     if (us->GetWarningLevel() > 0)
     {
@@ -123,6 +217,12 @@ void WikiUser::UpdateUser(WikiUser *us)
     }
 }
 
+QPair<WikiSite*, QString> WikiUser::problematicUserKey(const QString &user, WikiSite *site)
+{
+    QString name = user;
+    return QPair<WikiSite*, QString>(site, name.replace(" ", "_"));
+}
+
 bool WikiUser::CompareUsernames(QString a, QString b)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
@@ -134,13 +234,13 @@ bool WikiUser::CompareUsernames(QString a, QString b)
 bool WikiUser::IsIPv4(const QString &user)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
-    return WikiUser::IPv4Regex.exactMatch(user);
+    return IPAddress::IsIPv4(user);
 }
 
 bool WikiUser::IsIPv6(const QString &user)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
-    return WikiUser::IPv6Regex.exactMatch(user);
+    return IPAddress::IsIPv6(user);
 }
 
 void WikiUser::UpdateWl(WikiUser *us, long score)
@@ -151,14 +251,16 @@ void WikiUser::UpdateWl(WikiUser *us, long score)
         if (us->GetSite()->GetProjectConfig()->WhiteList.contains(us->Username))
         {
             us->whitelistInfo = HUGGLE_WL_TRUE;
+            HuggleQueueFilter::InvalidateProperties();
             us->Update();
             return;
         }
         QStringList pm = QStringList() << us->Username << QString::number(score) << us->GetSite()->Name;
         Syslog::HuggleLogs->Log(_l("whitelisted", pm));
         us->GetSite()->GetProjectConfig()->NewWhitelist.append(us->Username);
-        us->GetSite()->GetProjectConfig()->WhiteList.append(us->Username);
+        us->GetSite()->GetProjectConfig()->WhiteList.insert(us->Username);
         us->whitelistInfo = HUGGLE_WL_TRUE;
+        HuggleQueueFilter::InvalidateProperties();
         us->Update();
     }
 }
@@ -191,6 +293,7 @@ WikiUser::WikiUser(WikiUser *u) : MediaWikiObject(u)
     this->dateOfTalkPage = u->dateOfTalkPage;
     this->IsBlocked = u->IsBlocked;
     this->contentsOfTalkPage = u->contentsOfTalkPage;
+    this->compressedTalkPage = u->compressedTalkPage;
     this->IsReported = u->IsReported;
     this->talkPageWasRetrieved = u->talkPageWasRetrieved;
     this->whitelistInfo = HUGGLE_WL_UNKNOWN;
@@ -199,6 +302,7 @@ WikiUser::WikiUser(WikiUser *u) : MediaWikiObject(u)
     this->RegistrationDate = u->RegistrationDate;
     this->LastMessageTimeKnown = u->LastMessageTimeKnown;
     this->LastMessageTime = u->LastMessageTime;
+    this->TalkPageRevID = u->TalkPageRevID;
 }
 
 WikiUser::WikiUser(const WikiUser &u) : MediaWikiObject(u)
@@ -212,6 +316,7 @@ WikiUser::WikiUser(const WikiUser &u) : MediaWikiObject(u)
     this->IsBlocked = u.IsBlocked;
     this->dateOfTalkPage = u.dateOfTalkPage;
     this->contentsOfTalkPage = u.contentsOfTalkPage;
+    this->compressedTalkPage = u.compressedTalkPage;
     this->talkPageWasRetrieved = u.talkPageWasRetrieved;
     this->whitelistInfo = HUGGLE_WL_UNKNOWN;
     this->isBot = u.isBot;
@@ -219,24 +324,17 @@ WikiUser::WikiUser(const WikiUser &u) : MediaWikiObject(u)
     this->RegistrationDate = u.RegistrationDate;
     this->LastMessageTime = u.LastMessageTime;
     this->LastMessageTimeKnown = u.LastMessageTimeKnown;
+    this->TalkPageRevID = u.TalkPageRevID;
 }
 
 WikiUser::WikiUser(const QString &user, WikiSite *site) : MediaWikiObject(site)
 {
     this->userMutex = new QMutex(QMutex::Recursive);
     this->IP = false;
-    if (!user.isEmpty())
-    {
-        if (WikiUser::IsIPv4(user))
-        {
-            this->IP = true;
-        } else if (WikiUser::IsIPv6(user))
-        {
-            this->IP = true;
-        }
-    }
     this->Username = user;
     this->Sanitize();
+    if (this->Site)
+        this->Username = this->Site->Intern(this->Username);
     this->IsBlocked = false;
     this->talkPageWasRetrieved = false;
     this->dateOfTalkPage = InvalidTime;
@@ -248,7 +346,23 @@ WikiUser::WikiUser(const QString &user, WikiSite *site) : MediaWikiObject(site)
     this->BadnessScore = 0;
     this->warningLevel = 0;
     this->IsReported = false;
-    this->Resync();
+    WikiUser::ProblematicUserListLock.lock();
+    WikiUser *shared = WikiUser::RetrieveUser(this->Username, this->Site);
+    if (shared != nullptr)
+    {
+        // the shared instance already knows if this is an IP, so we don't need to match it again
+        this->IP = shared->IP;
+        this->resyncFrom(shared);
+        WikiUser::ProblematicUserListLock.unlock();
+    } else
+    {
+        WikiUser::ProblematicUserListLock.unlock();
+        if (!user.isEmpty())
+        {
+            this->IP = IPAddress::Parse(user) != IPAddressTypeNone;
+            this->loadReputation();
+        }
+    }
 }
 
 WikiUser::~WikiUser()
@@ -260,30 +374,83 @@ WikiUser::~WikiUser()
 bool WikiUser::Resync()
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    WikiUser::ProblematicUserListLock.lock();
     WikiUser *user = WikiUser::RetrieveUser(this);
     if (user && user != this)
     {
-        this->BadnessScore = user->BadnessScore;
-        this->contentsOfTalkPage = user->TalkPage_GetContents();
-        this->talkPageWasRetrieved = user->talkPageWasRetrieved;
-        this->dateOfTalkPage = user->dateOfTalkPage;
-        if (user->warningLevel > this->warningLevel)
-            this->warningLevel = user->warningLevel;
-        if (this->EditCount < 0)
-            this->EditCount = user->EditCount;
-        this->IsReported = user->IsReported;
-        this->IsBlocked = user->IsBlocked;
-        this->LastMessageTime = user->LastMessageTime;
-        this->LastMessageTimeKnown = user->LastMessageTimeKnown;
+        this->resyncFrom(user);
+        WikiUser::ProblematicUserListLock.unlock();
         return true;
     }
+    WikiUser::ProblematicUserListLock.unlock();
     return false;
 }
 
+void WikiUser::resyncFrom(WikiUser *user)
+{
+    this->BadnessScore = user->BadnessScore;
+    // both of these are implicitly shared, so this only references the data of shared instance, the talk
+    // page is not decompressed here because TalkPage_GetContents reads it from shared instance anyway
+    user->userMutex->lock();
+    this->contentsOfTalkPage = user->contentsOfTalkPage;
+    this->compressedTalkPage = user->compressedTalkPage;
+    user->userMutex->unlock();
+    this->talkPageWasRetrieved = user->talkPageWasRetrieved;
+    this->dateOfTalkPage = user->dateOfTalkPage;
+    if (user->warningLevel > this->warningLevel)
+        this->warningLevel = user->warningLevel;
+    if (this->EditCount < 0)
+        this->EditCount = user->EditCount;
+    this->IsReported = user->IsReported;
+    this->IsBlocked = user->IsBlocked;
+    this->LastMessageTime = user->LastMessageTime;
+    this->LastMessageTimeKnown = user->LastMessageTimeKnown;
+    this->TalkPageRevID = user->TalkPageRevID;
+}
+
+void WikiUser::loadReputation()
+{
+    if (ReputationStore::HuggleReputation == nullptr || this->Site == nullptr || this->Site->ProjectConfig == nullptr)
+        return;
+    ReputationStore_Entry entry;
+    if (!ReputationStore::HuggleReputation->Get(this->Site, this->Username, &entry))
+        return;
+    this->BadnessScore = entry.Badness;
+    this->TalkPageRevID = entry.TalkPageRevID;
+    // warnings older than this are ignored by talk page parser as well
+    QDateTime warning_time = QDateTime::fromMSecsSinceEpoch(entry.WarningTime);
+    if (entry.WarningTime > 0 && QDate::currentDate().addDays(this->Site->ProjectConfig->TemplateAge) <= warning_time.date())
+    {
+        this->warningLevel = static_cast<byte_ht>(entry.WarningLevel);
+        this->LastMessageTime = warning_time;
+        this->LastMessageTimeKnown = true;
+    }
+}
+
+void WikiUser::storeReputation(WikiUser *user)
+{
+    if (ReputationStore::HuggleReputation == nullptr)
+        return;
+    if (user->BadnessScore == 0 && user->warningLevel == 0 && user->TalkPageRevID == WIKI_UNKNOWN_REVID)
+        return;
+    ReputationStore_Entry entry;
+    ReputationStore_Entry previous;
+    entry.Badness = user->BadnessScore;
+    entry.WarningLevel = user->warningLevel;
+    if (user->LastMessageTimeKnown)
+        entry.WarningTime = user->LastMessageTime.toMSecsSinceEpoch();
+    else if (ReputationStore::HuggleReputation->Get(user->GetSite(), user->Username, &previous))
+        entry.WarningTime = previous.WarningTime;
+    entry.TalkPageRevID = user->TalkPageRevID;
+    ReputationStore::HuggleReputation->Put(user->GetSite(), user->Username, entry);
+}
+
 QString WikiUser::TalkPage_GetContents()
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
-    // first we need to lock this object because it might be accessed from another thread in same moment
+    // the list is locked first so that the global user can't be deleted while we read it, then we
+    // need to lock this object because it might be accessed from another thread in same moment
+    WikiUser::ProblematicUserListLock.lock();
     this->userMutex->lock();
     // check if there isn't some global talk page
     WikiUser *user = WikiUser::RetrieveUser(this);
@@ -293,24 +460,54 @@ QString WikiUser::TalkPage_GetContents()
     if (user != nullptr && user->TalkPage_WasRetrieved())
     {
         // we return a value of user from global db instead of local
-        contents = user->contentsOfTalkPage;
+        contents = user->talkPageContents();
         this->userMutex->unlock();
+        WikiUser::ProblematicUserListLock.unlock();
         return contents;
     }
-    contents = this->contentsOfTalkPage;
+    contents = this->talkPageContents();
     this->userMutex->unlock();
+    WikiUser::ProblematicUserListLock.unlock();
     return contents;
 }
 
+QString WikiUser::talkPageContents()
+{
+    if (this->contentsOfTalkPage.isEmpty() && !this->compressedTalkPage.isEmpty())
+        return QString::fromUtf8(qUncompress(this->compressedTalkPage));
+    return this->contentsOfTalkPage;
+}
+
+void WikiUser::TalkPage_Compress()
+{
+    this->userMutex->lock();
+    if (!this->contentsOfTalkPage.isEmpty())
+    {
+        this->compressedTalkPage = qCompress(this->contentsOfTalkPage.toUtf8());
+        this->contentsOfTalkPage.clear();
+    }
+    this->userMutex->unlock();
+}
+
+qint64 WikiUser::TalkPage_MemoryUsage()
+{
+    this->userMutex->lock();
+    qint64 size = this->contentsOfTalkPage.size() * sizeof(QChar) + this->compressedTalkPage.size();
+    this->userMutex->unlock();
+    return size;
+}
+
 void WikiUser::TalkPage_SetContents(const QString &text)
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
     this->userMutex->lock();
     this->talkPageWasRetrieved = true;
     this->contentsOfTalkPage = text;
+    this->compressedTalkPage.clear();
     this->dateOfTalkPage = QDateTime::currentDateTime();
-    this->Update();
     this->userMutex->unlock();
+    // this needs to happen without holding the user lock, list of problematic users is always locked first
+    this->Update();
 }
 
 void WikiUser::Update(bool MatchingOnly)
@@ -348,7 +545,7 @@ QString WikiUser::UnderscorelessUsername()
 
 bool WikiUser::EqualTo(WikiUser *user)
 {
-    return this->Site == user->Site && this->Username == user->Username;
+    return this->Site == user->Site && StringPool::Equal(this->Username, user->Username);
 }
 
 QString WikiUser::GetTalk()
@@ -377,6 +574,14 @@ WikiPage *WikiUser::GetTalkPage()
     return page;
 }
 
+bool WikiUser::TalkPage_Exists()
+{
+    if (!this->TalkPage_GetContents().isEmpty())
+        return true;
+    // contents of talk page are not kept in between sessions, but id of its last revision is
+    return this->TalkPageRevID > 0;
+}
+
 bool WikiUser::TalkPage_ContainsSharedIPTemplate()
 {
     if (this->GetSite()->GetProjectConfig()->SharedIPTemplateTags.length() < 1)
@@ -411,6 +616,32 @@ bool WikiUser::IsWhitelisted()
     }
 }
 
+IPRangeStats WikiUser::GetRangeStats()
+{
+    if (!this->IP)
+        return IPRangeStats();
+    IPAddress address;
+    IPAddressType type = IPAddress::Parse(this->Username, &address);
+    if (type == IPAddressTypeNone)
+        return IPRangeStats();
+    int prefix = hcfg->SystemConfig_IPv6RangePrefix;
+    if (type == IPAddressTypeIPv4)
+        prefix = hcfg->SystemConfig_IPv4RangePrefix;
+    return this->GetSite()->IPRanges->GetRange(address, prefix, true);
+}
+
+bool WikiUser::IsInBadRange()
+{
+    IPRangeStats range = this->GetRangeStats();
+    return range.Addresses > 0 && (range.Warnings > 0 || range.Badness > 0);
+}
+
+bool WikiUser::IsInGoodRange()
+{
+    IPRangeStats range = this->GetRangeStats();
+    return range.Addresses > 0 && range.Warnings == 0 && range.Badness < 0;
+}
+
 QString WikiUser::GetUserPage()
 {
     // get a userspace prefix for this site
@@ -506,6 +737,30 @@ void WikiUser::SetLastMessageTime(const QDateTime &date_time)
     this->LastMessageTime = date_time;
 }
 
+void WikiUser::SetUserInfo(long edit_count, const QString &registration, const QStringList &groups)
+{
+    this->userMutex->lock();
+    if (edit_count >= 0)
+        this->EditCount = edit_count;
+    if (!registration.isEmpty())
+        this->RegistrationDate = registration;
+    this->Groups = groups;
+    this->userMutex->unlock();
+}
+
+void WikiUser::RestoreUserInfo(long edit_count, const QString &registration, const QStringList &groups, bool blocked)
+{
+    this->userMutex->lock();
+    if (this->EditCount < 0)
+    {
+        this->EditCount = edit_count;
+        this->RegistrationDate = registration;
+        this->Groups = groups;
+        this->IsBlocked = this->IsBlocked || blocked;
+    }
+    this->userMutex->unlock();
+}
+
 byte_ht WikiUser::GetWarningLevel() const
 {
     return this->warningLevel;
@@ -13,11 +13,14 @@
 
 #include "definitions.hpp"
 
+#include <QHash>
 #include <QList>
+#include <QPair>
 #include <QStringList>
 #include <QDateTime>
 #include <QString>
 #include <QRegExp>
+#include "iprangetrie.hpp"
 #include "mediawikiobject.hpp"
 
 class QMutex;
@@ -31,7 +34,12 @@ namespace Huggle
     class HUGGLE_EX_CORE WikiUser : public MediaWikiObject
     {
         public:
-            //! Delete all users that have badness score 0 these users aren't necessary to be stored in a list
+            /*!
+             * \brief Delete all users that have badness score 0 these users aren't necessary to be stored in a list
+             *
+             * If there is still more users than SystemConfig_ProblematicUsersMax, the users with lowest warning
+             * level and score that weren't accessed for longest time are removed as well
+             */
             static void TrimProblematicUsersList();
             static bool CompareUsernames(QString a, QString b);
             //! Update a list of problematic users
@@ -45,18 +53,40 @@ namespace Huggle
              * In case the user in question is already in list of problematic users, this function
              * will return its instance. It compares the username against the usernames that
              * are in this list.
+             *
+             * Users that are no longer problematic are periodically deleted by TrimProblematicUsersList,
+             * so the returned pointer is only valid as long as ProblematicUserListLock is held by caller.
              * \param user
              * \return static user from list of problematic users
              */
             static WikiUser *RetrieveUser(const QString &user, WikiSite *site);
             static WikiUser *RetrieveUser(WikiUser *user);
+            /*!
+             * \brief Returns the shared instance of user with given name on given site, it's created if it doesn't exist yet
+             *
+             * All edits made by same user reference this one instance, so that changes made to it through any
+             * of them are immediately visible to all others. Every call needs to be matched by Release.
+             */
+            static WikiUser *Acquire(const QString &user, WikiSite *site);
+            //! Releases a user owned by caller, shared instances are deleted once the last reference is released,
+            //! users that aren't shared are deleted immediately
+            static void Release(WikiUser *user);
+            //! Shared instances returned by Acquire, protected by SharedUsersLock
+            static QHash<QPair<WikiSite*, QString>, WikiUser*> SharedUsers;
+            static QMutex SharedUsersLock;
             /*!
              * \brief List of users that are scored in this instance of huggle
              *
              * Either vandals or even good users, this list is preserved on shutdown and startup
              */
-            static QList<WikiUser*> ProblematicUsers;
+            static QHash<QPair<WikiSite*, QString>, WikiUser*> ProblematicUsers;
             static QMutex ProblematicUserListLock;
+            //! Number of lookups in list of problematic users
+            static qint64 ProblematicUsersLookups;
+            //! Total time in nanoseconds spent by lookups in list of problematic users
+            static qint64 ProblematicUsersLookupTime;
+            //! Number of users that were removed from list of problematic users because it was too big
+            static qint64 ProblematicUsersEvicted;
             static QDateTime InvalidTime;
 
             WikiUser(WikiSite *site);
@@ -81,6 +111,10 @@ namespace Huggle
              * \param text New content of talk page
              */
             void TalkPage_SetContents(const QString &text);
+            //! Compress the cached talk page, it's transparently uncompressed by TalkPage_GetContents
+            void TalkPage_Compress();
+            //! Number of bytes held by cached talk page, either plain or compressed
+            qint64 TalkPage_MemoryUsage();
             //! Call UpdateUser on current user
             void Update(bool MatchingOnly = false);
             QString UnderscorelessUsername();
@@ -106,9 +140,22 @@ namespace Huggle
             //! Returns a WikiPage object for talk page of this user, unlike "GetTalk()" which only returns a name of talk page
             WikiPage *GetTalkPage();
             bool TalkPage_WasRetrieved();
+            //! Returns true if talk page of user exists, this is known even without contents if revision of talk page is known
+            bool TalkPage_Exists();
             bool TalkPage_ContainsSharedIPTemplate();
             //! Returns true if this user is wl
             bool IsWhitelisted();
+            /*!
+             * \brief Information about other anonymous users from same IP range as this user
+             *
+             * The range is given by SystemConfig_IPv4RangePrefix or SystemConfig_IPv6RangePrefix, this user is not
+             * included in the result. For registered users the result is empty.
+             */
+            IPRangeStats GetRangeStats();
+            //! Returns true if other users from IP range of this user were warned or have positive badness
+            bool IsInBadRange();
+            //! Returns true if other users from IP range of this user were never warned and have negative badness
+            bool IsInGoodRange();
             QDateTime TalkPage_RetrievalTime();
             QString GetUserPage();
             /*!
@@ -133,7 +180,15 @@ namespace Huggle
             void IncrementWarningLevel();
             void SetWarningLevel(byte_ht level);
             void SetLastMessageTime(const QDateTime &date_time);
+            //! Store edit count, registration and groups retrieved from the wiki, negative edit count or empty
+            //! registration keep the current value. This is thread safe, user may be shared by many edits
+            void SetUserInfo(long edit_count, const QString &registration, const QStringList &groups);
+            //! Fill in the information stored in a snapshot, it's only used when nothing was retrieved for
+            //! this user yet, so that newer information of shared user is never replaced with stale one
+            void RestoreUserInfo(long edit_count, const QString &registration, const QStringList &groups, bool blocked);
             byte_ht GetWarningLevel() const;
+            //! Time in ms since epoch when this user was last accessed in list of problematic users
+            qint64 LastAccess() const;
             //! Username
             QString Username;
             bool IsBlocked;
@@ -149,12 +204,19 @@ namespace Huggle
             bool LastMessageTimeKnown = false;
             //! Time when received last warning
             QDateTime LastMessageTime;
+            //! Revision of talk page that was last retrieved, 0 if talk page doesn't exist
+            revid_ht TalkPageRevID = WIKI_UNKNOWN_REVID;
 
     protected:
-            //! Matches only IPv4
-            static QRegExp IPv4Regex;
-            //! Matches all IP
-            static QRegExp IPv6Regex;
+            //! Key of user in ProblematicUsers, usernames are stored with underscores
+            static QPair<WikiSite*, QString> problematicUserKey(const QString &user, WikiSite *site);
+            //! Write the reputation of user to ReputationStore so that it's known in next session
+            static void storeReputation(WikiUser *user);
+            //! Copy the scores, flags and talk page from shared instance of this user
+            void resyncFrom(WikiUser *user);
+            //! Load the badness and warning level this user had in previous sessions
+            void loadReputation();
+            QString talkPageContents();
 
             /*!
              * \brief Badness score of current user
@@ -169,11 +231,17 @@ namespace Huggle
             byte_ht whitelistInfo;
             //! In case that we retrieved the talk page during parse of warning level, this string contains it
             QString contentsOfTalkPage;
+            //! Compressed copy of talk page, if this is not empty the contentsOfTalkPage is empty
+            QByteArray compressedTalkPage;
             bool talkPageWasRetrieved;
             //! This is a date when we retrieved this talk page
             QDateTime dateOfTalkPage;
             QMutex *userMutex;
             WikiPage *wpTalkPage = nullptr;
+            //! Time in ms since epoch when this user was last retrieved from or updated in ProblematicUsers
+            qint64 lastAccess = 0;
+            //! Number of references to this user in case it's in SharedUsers, 0 for users that aren't shared
+            int sharedRefs = 0;
             bool isBot;
             bool IP;
     };
@@ -193,6 +261,11 @@ namespace Huggle
         return this->talkPageWasRetrieved;
     }
 
+    inline qint64 WikiUser::LastAccess() const
+    {
+        return this->lastAccess;
+    }
+
     inline bool WikiUser::IsIP() const
     {
         return this->IP;
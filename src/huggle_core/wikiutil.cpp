@@ -364,7 +364,7 @@ static void RetrieveEditByRevid_Page_OK(Query *query)
     source_info->edit->SetSize(revision_data->GetAttribute("size", "0").toLong());
     source_info->edit->Summary = revision_data->GetAttribute("comment");
     source_info->edit->Time = MediaWiki::FromMWTimestamp(revision_data->GetAttribute("timestamp"));
-    source_info->edit->User = new WikiUser(revision_data->GetAttribute("user"), result->GetSite());
+    source_info->edit->User = WikiUser::Acquire(revision_data->GetAttribute("user"), result->GetSite());
     // pre process the edit
     QueryPool::HugglePool->PreProcessEdit(source_info->edit);
     // \bug now put the diff into the diff store, keep in mind that edit is still not postprocessed so many things are probably not going to be evaluated
@@ -397,7 +397,7 @@ void WikiUtil::RetrieveEditByRevid(revid_ht revid, WikiSite *site, void *source,
     // let's create a new edit
     WikiEdit *edit = new WikiEdit();
     edit->Diff = revid;
-    edit->RevID = revid;
+    edit->SetRevID(revid);
     // let's get the information about the page now, once that is finished, we get information about the user
     ApiQuery *qPage = new ApiQuery(ActionQuery, site);
     RetrieveEditByRevid_SourceInfo *i = new RetrieveEditByRevid_SourceInfo();
@@ -435,7 +435,7 @@ ApiQuery *WikiUtil::RetrieveWikiPageContents(const QString &page, WikiSite *site
 ApiQuery *WikiUtil::RetrieveWikiPageContents(WikiPage *page, bool parse)
 {
     // performance hack
-    static QString options = QUrl::toPercentEncoding("timestamp|user|comment|content");
+    static QString options = QUrl::toPercentEncoding("ids|timestamp|user|comment|content");
     ApiQuery *query = new ApiQuery(ActionQuery, page->Site);
     query->Target = "Retrieving contents of " + page->PageName;
     query->Parameters = "prop=revisions&rvlimit=1&rvprop=" + options + "&titles=" + QUrl::toPercentEncoding(page->PageName);
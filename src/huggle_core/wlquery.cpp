@@ -12,10 +12,29 @@
 #include <QtNetwork>
 #include <QUrl>
 #include "configuration.hpp"
+#include "hugglequeuefilter.hpp"
+#include "projectconfiguration.hpp"
 #include "syslog.hpp"
 #include "wikisite.hpp"
 using namespace Huggle;
 
+QStringList WLQuery::ParseList(const QString &data)
+{
+    QString list = data;
+    list.replace("<!-- list -->", "");
+    list.replace("||EOW||", "");
+    QStringList users = list.split("|", QString::SkipEmptyParts);
+    QStringList result;
+    result.reserve(users.count());
+    foreach (QString user, users)
+    {
+        user = user.trimmed();
+        if (!user.isEmpty())
+            result.append(user);
+    }
+    return result;
+}
+
 WLQuery::WLQuery(WikiSite *site) : MediaWikiObject(site)
 {
     this->Type = QueryType::QueryWl;
@@ -46,10 +65,17 @@ QString WLQuery::QueryTypeToString()
 
 QString WLQuery::QueryTargetToString()
 {
-    if (this->WL_Type != WLQueryType_SuspWL)
-        return "Writing users to WhiteList";
-    else
-        return "Reporting suspicious edit";
+    switch (this->WL_Type)
+    {
+        case WLQueryType_ReadWL:
+        case WLQueryType_ReadWLChanges:
+            return "Reading WhiteList";
+        case WLQueryType_SuspWL:
+            return "Reporting suspicious edit";
+        case WLQueryType_WriteWL:
+            break;
+    }
+    return "Writing users to WhiteList";
 }
 
 void WLQuery::Kill()
@@ -91,6 +117,13 @@ void WLQuery::Process()
     {
         case WLQueryType_ReadWL:
             break;
+        case WLQueryType_ReadWLChanges:
+            // servers that don't know the since parameter just return whole list, which is fine as well
+            // because the result is merged with the list we already have
+            url = QUrl(Configuration::HuggleConfiguration->GlobalConfig_Whitelist
+                       + "?action=read&wp=" + this->GetSite()->WhiteList
+                       + "&since=" + QString::number(this->Since.toTime_t()));
+            break;
         case WLQueryType_SuspWL:
             url = QUrl(Configuration::HuggleConfiguration->GlobalConfig_Whitelist +
                        "susp.php?action=insert&" + this->Parameters);
@@ -105,20 +138,10 @@ void WLQuery::Process()
     QByteArray data;
     if (this->WL_Type == WLQueryType_WriteWL)
     {
-        QString whitelist = "";
-        int p = 0;
-        while (p < this->GetSite()->GetProjectConfig()->NewWhitelist.count())
-        {
-            if (!this->GetSite()->GetProjectConfig()->NewWhitelist.at(p).isEmpty())
-            {
-                whitelist += this->GetSite()->GetProjectConfig()->NewWhitelist.at(p) + "|";
-            }
-            p++;
-        }
-        if (whitelist.endsWith("|"))
-        {
-            whitelist = whitelist.mid(0, whitelist.length() - 1);
-        }
+        if (this->Users.isEmpty())
+            this->Users = this->GetSite()->GetProjectConfig()->NewWhitelist;
+        this->Users.removeAll("");
+        QString whitelist = this->Users.join("|");
         whitelist += "||EOW||";
         params = "wl=" + QUrl::toPercentEncoding(whitelist);
         data = params.toUtf8();
@@ -126,7 +149,7 @@ void WLQuery::Process()
         Syslog::HuggleLogs->DebugLog("Sending whitelist data of size: " + QString::number(size) + " byte to " + this->GetSite()->Name);
     }
     QNetworkRequest request(url);
-    if (this->WL_Type == WLQueryType_ReadWL)
+    if (this->WL_Type == WLQueryType_ReadWL || this->WL_Type == WLQueryType_ReadWLChanges)
     {
         this->networkReply = Query::NetworkManager->get(request);
     } else
@@ -153,10 +176,33 @@ void WLQuery::finished()
     {
         Syslog::HuggleLogs->DebugLog(this->Result->Data, 2);
         if (!this->Result->Data.contains("written"))
+        {
             Syslog::HuggleLogs->ErrorLog("Failed to store data to white list: " + this->Result->Data);
+        } else if (!this->networkReply->error())
+        {
+            // these users are now on server, so we don't need to send them again
+            ProjectConfiguration *conf = this->GetSite()->GetProjectConfig();
+            QSet<QString> written = this->Users.toSet();
+            QStringList pending;
+            foreach (QString user, conf->NewWhitelist)
+            {
+                if (!written.contains(user))
+                    pending.append(user);
+            }
+            conf->NewWhitelist = pending;
+            conf->WhiteList.unite(written);
+            HuggleQueueFilter::InvalidateProperties();
+        }
     }
     if (this->WL_Type == WLQueryType_SuspWL)
         HUGGLE_DEBUG("Result of susp.php: " + this->Result->Data, 2);
+    if (this->networkReply->hasRawHeader("Date"))
+    {
+        // HTTP date is always in GMT and english, e.g. Sun, 06 Nov 1994 08:49:37 GMT
+        QString date = QString::fromLatin1(this->networkReply->rawHeader("Date")).trimmed();
+        this->ServerTime = QLocale::c().toDateTime(date, "ddd, dd MMM yyyy hh:mm:ss 'GMT'");
+        this->ServerTime.setTimeSpec(Qt::UTC);
+    }
     // now we need to check if request was successful or not
     if (this->networkReply->error())
     {
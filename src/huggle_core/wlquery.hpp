@@ -14,8 +14,13 @@
 #include "definitions.hpp"
 
 #include <QString>
+#include <QStringList>
+#include <QDateTime>
 #include "query.hpp"
 #include "mediawikiobject.hpp"
+
+//! Number of seconds that delta of whitelist overlaps with previous download, users in both are merged anyway
+#define HUGGLE_WL_SINCE_OVERLAP 60
 class QNetworkReply;
 namespace Huggle
 {
@@ -23,6 +28,8 @@ namespace Huggle
     {
         WLQueryType_WriteWL,
         WLQueryType_ReadWL,
+        //! Read only users that were added to whitelist since WLQuery::Since
+        WLQueryType_ReadWLChanges,
         WLQueryType_SuspWL
     };
     class WikiSite;
@@ -32,6 +39,12 @@ namespace Huggle
     {
             Q_OBJECT
         public:
+            /*!
+             * \brief Parse a list of users as returned by whitelist server
+             * \param data Contents of the reply, with optional <!-- list --> header and ||EOW|| terminator
+             * \return List of usernames without empty items
+             */
+            static QStringList ParseList(const QString &data);
             WLQuery(WikiSite *site);
             ~WLQuery() override;
             //! Get a query target as a string
@@ -42,6 +55,18 @@ namespace Huggle
             void Process() override;
             QString Parameters;
             WLQueryType WL_Type;
+            //! For WLQueryType_ReadWLChanges this is the time of last known version of whitelist
+            QDateTime Since;
+            //! Time of the whitelist server when it replied, taken from Date header of the reply, it's invalid if the
+            //! server didn't send it, this needs to be used instead of local time for Since of next query
+            QDateTime ServerTime;
+            /*!
+             * \brief Users that are written to whitelist by WLQueryType_WriteWL
+             *
+             * If this is empty when query is processed, it's filled with copy of NewWhitelist of the site. Once
+             * the server confirms the write, these users are moved from NewWhitelist to WhiteList.
+             */
+            QStringList Users;
             double Progress;
         private slots:
             void readData();
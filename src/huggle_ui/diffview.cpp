@@ -0,0 +1,299 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#include "diffview.hpp"
+#include <QPainter>
+#include <QScrollBar>
+#include <QTextLayout>
+#include <QVector>
+#include <QtMath>
+
+using namespace Huggle;
+
+// space around the text of every cell
+#define HUGGLE_DIFFVIEW_PADDING 4
+// width of column with + and - markers in front of each side
+#define HUGGLE_DIFFVIEW_MARKER  16
+
+DiffView::DiffView(QWidget *parent) : QAbstractScrollArea(parent)
+{
+    this->setFrameShape(QFrame::NoFrame);
+    this->viewport()->setAutoFillBackground(true);
+    this->viewport()->setBackgroundRole(QPalette::Base);
+    this->header.setDocumentMargin(HUGGLE_DIFFVIEW_PADDING);
+}
+
+DiffView::~DiffView()
+{
+    this->clearLayouts();
+}
+
+void DiffView::Display(const DiffDocument &document, const QString &header, const QStringList &words)
+{
+    this->renderPending = true;
+    this->document = document;
+    this->words = words;
+    this->search.clear();
+    this->header.setDefaultFont(this->font());
+    this->header.setHtml(header);
+    this->layoutWidth = -1;
+    this->layoutRows();
+    this->verticalScrollBar()->setValue(0);
+    this->viewport()->update();
+}
+
+void DiffView::Clear()
+{
+    this->clearLayouts();
+    this->document.Clear();
+    this->header.clear();
+    this->contentHeight = 0;
+    this->layoutWidth = -1;
+    this->renderPending = false;
+    this->search.clear();
+    this->viewport()->update();
+}
+
+void DiffView::Find(const QString &text)
+{
+    this->search = text;
+    this->layoutRows();
+    if (!text.isEmpty())
+    {
+        // rows are laid out in same order as rows of document
+        int i = 0;
+        while (i < this->rows.count())
+        {
+            const DiffDocument_Row &source = this->document.Rows.at(i);
+            if (source.Left.GetText().contains(text, Qt::CaseInsensitive) || source.Right.GetText().contains(text, Qt::CaseInsensitive))
+            {
+                this->verticalScrollBar()->setValue(this->rows.at(i).Y);
+                break;
+            }
+            i++;
+        }
+    }
+    this->viewport()->update();
+}
+
+void DiffView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this->viewport());
+    int offset = this->verticalScrollBar()->value();
+    int width = this->viewport()->width();
+    int visible_height = this->viewport()->height();
+    painter.translate(0, -offset);
+    this->header.drawContents(&painter, QRectF(0, offset, width, visible_height));
+    int column = (width - 2 * HUGGLE_DIFFVIEW_MARKER) / 2;
+    foreach (DiffView_Row row, this->rows)
+    {
+        if (row.Y + row.Height < offset)
+            continue;
+        if (row.Y > offset + visible_height)
+            break;
+        if (row.LeftType == DiffDocument_Notice)
+        {
+            this->paintCell(&painter, row.LeftType, row.Left, 0, row.Y, width - HUGGLE_DIFFVIEW_MARKER, row.Height);
+            continue;
+        }
+        this->paintCell(&painter, row.LeftType, row.Left, 0, row.Y, column, row.Height);
+        this->paintCell(&painter, row.RightType, row.Right, column + HUGGLE_DIFFVIEW_MARKER, row.Y, column, row.Height);
+    }
+    if (this->renderPending)
+    {
+        this->renderPending = false;
+        emit this->Rendered();
+    }
+}
+
+void DiffView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    if (this->layoutWidth != this->viewport()->width())
+        this->layoutRows();
+    this->verticalScrollBar()->setPageStep(this->viewport()->height());
+    this->verticalScrollBar()->setRange(0, qMax(0, this->contentHeight - this->viewport()->height()));
+}
+
+QTextLayout *DiffView::createLayout(const DiffDocument_Cell &cell, int width, int *height)
+{
+    QString text = cell.GetText();
+    if (text.isEmpty())
+        return nullptr;
+    QTextLayout *layout = new QTextLayout(text, this->font());
+    QTextOption option;
+    option.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+    layout->setTextOption(option);
+    QList<QTextLayout::FormatRange> formats;
+    QTextLayout::FormatRange range;
+    int position = 0;
+    foreach (DiffDocument_Segment segment, cell.Segments)
+    {
+        if (segment.Changed)
+        {
+            range.start = position;
+            range.length = segment.Text.size();
+            range.format = QTextCharFormat();
+            range.format.setFontWeight(QFont::Bold);
+            range.format.setBackground(QColor(cell.Type == DiffDocument_Deleted ? "#feeec8" : "#d8ecff"));
+            formats.append(range);
+        }
+        position += segment.Text.size();
+    }
+    if (cell.Type == DiffDocument_LineNumber || cell.Type == DiffDocument_Notice)
+    {
+        range.start = 0;
+        range.length = text.size();
+        range.format = QTextCharFormat();
+        if (cell.Type == DiffDocument_LineNumber)
+            range.format.setFontWeight(QFont::Bold);
+        else
+            range.format.setFontItalic(true);
+        formats.append(range);
+    } else
+    {
+        foreach (QString word, this->words)
+        {
+            if (word.isEmpty())
+                continue;
+            int index = 0;
+            while ((index = text.indexOf(word, index, Qt::CaseInsensitive)) >= 0)
+            {
+                range.start = index;
+                range.length = word.size();
+                range.format = QTextCharFormat();
+                range.format.setForeground(Qt::red);
+                range.format.setBackground(Qt::yellow);
+                formats.append(range);
+                index += word.size();
+            }
+        }
+    }
+    if (!this->search.isEmpty())
+    {
+        int index = 0;
+        while ((index = text.indexOf(this->search, index, Qt::CaseInsensitive)) >= 0)
+        {
+            range.start = index;
+            range.length = this->search.size();
+            range.format = QTextCharFormat();
+            range.format.setBackground(QColor("#ff9632"));
+            formats.append(range);
+            index += this->search.size();
+        }
+    }
+#if QT_VERSION >= 0x050600
+    layout->setFormats(formats.toVector());
+#else
+    layout->setAdditionalFormats(formats);
+#endif
+    qreal y = 0;
+    layout->beginLayout();
+    while (true)
+    {
+        QTextLine line = layout->createLine();
+        if (!line.isValid())
+            break;
+        line.setLineWidth(width);
+        line.setPosition(QPointF(0, y));
+        y += line.height();
+    }
+    layout->endLayout();
+    *height = qCeil(y);
+    return layout;
+}
+
+void DiffView::clearLayouts()
+{
+    foreach (DiffView_Row row, this->rows)
+    {
+        delete row.Left;
+        delete row.Right;
+    }
+    this->rows.clear();
+}
+
+void DiffView::layoutRows()
+{
+    this->clearLayouts();
+    int width = this->viewport()->width();
+    this->layoutWidth = width;
+    this->header.setTextWidth(width);
+    int y = qCeil(this->header.size().height());
+    int column = (width - 2 * HUGGLE_DIFFVIEW_MARKER) / 2;
+    // text starts after the thick left border
+    int text_width = qMax(1, column - 3 * HUGGLE_DIFFVIEW_PADDING);
+    // notices span both columns
+    int notice_width = qMax(1, width - HUGGLE_DIFFVIEW_MARKER - 3 * HUGGLE_DIFFVIEW_PADDING);
+    int line_height = this->fontMetrics().height();
+    this->rows.reserve(this->document.Rows.count());
+    foreach (DiffDocument_Row source, this->document.Rows)
+    {
+        DiffView_Row row;
+        int left_height = line_height;
+        int right_height = line_height;
+        row.LeftType = source.Left.Type;
+        row.RightType = source.Right.Type;
+        row.Left = this->createLayout(source.Left, source.Left.Type == DiffDocument_Notice ? notice_width : text_width, &left_height);
+        row.Right = this->createLayout(source.Right, text_width, &right_height);
+        row.Y = y;
+        row.Height = qMax(qMax(left_height, right_height), line_height) + 2 * HUGGLE_DIFFVIEW_PADDING;
+        y += row.Height;
+        this->rows.append(row);
+    }
+    this->contentHeight = y;
+    this->verticalScrollBar()->setSingleStep(line_height);
+    this->verticalScrollBar()->setPageStep(this->viewport()->height());
+    this->verticalScrollBar()->setRange(0, qMax(0, this->contentHeight - this->viewport()->height()));
+}
+
+void DiffView::paintCell(QPainter *painter, DiffDocument_CellType type, QTextLayout *layout, int x, int y, int width, int height)
+{
+    QString marker;
+    QColor border;
+    switch (type)
+    {
+        case DiffDocument_Empty:
+        case DiffDocument_LineNumber:
+        case DiffDocument_Notice:
+            break;
+        case DiffDocument_Context:
+            painter->fillRect(x + HUGGLE_DIFFVIEW_MARKER, y + 1, width, height - 2, QColor("#f8f9fa"));
+            border = QColor("#eaecf0");
+            break;
+        case DiffDocument_Deleted:
+            marker = QChar(0x2212);
+            border = QColor("#ffe49c");
+            break;
+        case DiffDocument_Added:
+            marker = "+";
+            border = QColor("#a3d3ff");
+            break;
+    }
+    if (border.isValid())
+    {
+        painter->setPen(border);
+        painter->drawRect(x + HUGGLE_DIFFVIEW_MARKER, y + 1, width - 1, height - 3);
+        // thick left border, same as in mediawiki
+        painter->fillRect(x + HUGGLE_DIFFVIEW_MARKER, y + 1, 4, height - 2, border);
+    }
+    if (!marker.isEmpty())
+    {
+        painter->setPen(this->palette().color(QPalette::Text));
+        painter->drawText(QRect(x, y, HUGGLE_DIFFVIEW_MARKER, height), Qt::AlignCenter, marker);
+    }
+    if (layout != nullptr)
+    {
+        painter->setPen(this->palette().color(QPalette::Text));
+        layout->draw(painter, QPointF(x + HUGGLE_DIFFVIEW_MARKER + 2 * HUGGLE_DIFFVIEW_PADDING, y + HUGGLE_DIFFVIEW_PADDING));
+    }
+}
@@ -0,0 +1,89 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#ifndef DIFFVIEW_HPP
+#define DIFFVIEW_HPP
+
+#include <huggle_core/definitions.hpp>
+
+#include <QAbstractScrollArea>
+#include <QList>
+#include <QStringList>
+#include <QTextDocument>
+#include <huggle_core/diffdocument.hpp>
+
+class QTextLayout;
+
+namespace Huggle
+{
+    class DiffView_Row
+    {
+        public:
+            DiffDocument_CellType LeftType;
+            DiffDocument_CellType RightType;
+            //! Laid out text of cells, NULL for cells without text
+            QTextLayout *Left = nullptr;
+            QTextLayout *Right = nullptr;
+            int Y;
+            int Height;
+    };
+
+    /*!
+     * \brief The DiffView class paints a diff directly with QPainter
+     *
+     * It's a lightweight alternative to web browser which needs to load a complete html document for every diff,
+     * the diff table is parsed into DiffDocument and every cell is laid out as plain text with formats for the
+     * changed parts and score words.
+     */
+    class HUGGLE_EX_UI DiffView : public QAbstractScrollArea
+    {
+            Q_OBJECT
+        public:
+            explicit DiffView(QWidget *parent = nullptr);
+            ~DiffView() override;
+            /*!
+             * \brief Display a diff
+             * \param document Parsed diff table
+             * \param header Rich text that is displayed above the diff, like summary of edit
+             * \param words Words that are highlighted in text, usually score words of edit
+             */
+            void Display(const DiffDocument &document, const QString &header, const QStringList &words);
+            void Clear();
+            //! Highlight all occurrences of text and scroll to the first one, empty text removes the highlighting
+            void Find(const QString &text);
+
+        signals:
+            //! Emitted when a diff is painted for first time
+            void Rendered();
+
+        protected:
+            void paintEvent(QPaintEvent *event) override;
+            void resizeEvent(QResizeEvent *event) override;
+
+        private:
+            QTextLayout *createLayout(const DiffDocument_Cell &cell, int width, int *height);
+            void clearLayouts();
+            void layoutRows();
+            void paintCell(QPainter *painter, DiffDocument_CellType type, QTextLayout *layout, int x, int y, int width, int height);
+            DiffDocument document;
+            QStringList words;
+            //! Text searched by Find
+            QString search;
+            QTextDocument header;
+            QList<DiffView_Row> rows;
+            int contentHeight = 0;
+            //! Width of viewport for which the rows were laid out
+            int layoutWidth = -1;
+            bool renderPending = false;
+    };
+}
+
+#endif // DIFFVIEW_HPP
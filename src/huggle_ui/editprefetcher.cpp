@@ -0,0 +1,225 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#include "editprefetcher.hpp"
+#include <QDateTime>
+#include <huggle_core/configuration.hpp>
+#include <huggle_core/editqueue.hpp>
+#include <huggle_core/querypool.hpp>
+#include <huggle_core/wikipage.hpp>
+#include <huggle_core/wikisite.hpp>
+#include <huggle_core/wikiuser.hpp>
+#include "genericbrowser.hpp"
+#include "historyform.hpp"
+#include "userinfoform.hpp"
+
+using namespace Huggle;
+
+// contributions retrieved more than this number of seconds ago are not used, because the user may have edited meanwhile,
+// history doesn't need this because HistoryForm retrieves current one after it displays the prefetched one
+#define HUGGLE_PREFETCH_MAX_AGE 60
+
+EditPrefetcher::EditPrefetcher()
+{
+
+}
+
+EditPrefetcher::~EditPrefetcher()
+{
+    this->Clear();
+}
+
+void EditPrefetcher::Update(EditQueue *queue, GenericBrowser *browser)
+{
+    int count = hcfg->SystemConfig_PrefetchCount;
+    if (count > queue->Count())
+        count = queue->Count();
+    QList<WikiEdit*> top;
+    int i = 0;
+    while (i < count)
+        top.append(queue->At(i++));
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    // forget items that are no longer on top of queue, the others are kept as long as they stay there
+    i = 0;
+    while (i < this->items.count())
+    {
+        EditPrefetcher_Item *item = this->items.at(i);
+        if (!top.contains(item->Edit.GetPtr()))
+        {
+            this->items.removeAt(i);
+            delete item;
+            continue;
+        }
+        i++;
+    }
+    foreach (WikiEdit *edit, top)
+    {
+        if (!edit->IsPostProcessed() || this->findItem(edit) != nullptr)
+            continue;
+        EditPrefetcher_Item *item = new EditPrefetcher_Item();
+        item->Edit = edit;
+        if (hcfg->UserConfig->HistoryLoad)
+        {
+            item->History = HistoryForm::CreateQuery(edit->Page);
+            item->History->Process();
+            // same user often has more edits on top of the queue, these can share one query
+            EditPrefetcher_Item *shared = this->findContributions(edit->User);
+            if (shared != nullptr)
+            {
+                item->Contributions = shared->Contributions;
+                item->ContributionsTime = shared->ContributionsTime;
+            } else
+            {
+                item->Contributions = UserinfoForm::CreateQuery(edit->User);
+                item->ContributionsTime = now;
+                QueryPool::HugglePool->AppendQuery(item->Contributions);
+                item->Contributions->Process();
+            }
+        }
+        this->items.append(item);
+    }
+    // best edit is the one that is most likely displayed next, so we render it offscreen
+    if (!top.isEmpty())
+    {
+        EditPrefetcher_Item *best = this->findItem(top.first());
+        if (best != nullptr)
+            this->buildHtml(best, browser);
+    }
+}
+
+Collectable_SmartPtr<ApiQuery> EditPrefetcher::TakeHistory(WikiPage *page)
+{
+    Collectable_SmartPtr<ApiQuery> result;
+    foreach (EditPrefetcher_Item *item, this->items)
+    {
+        if (item->History == nullptr || item->Edit->Page->GetSite() != page->GetSite() || item->Edit->Page->PageName != page->PageName)
+            continue;
+        if (item->History->IsProcessed() && item->History->IsFailed())
+        {
+            item->History = nullptr;
+            continue;
+        }
+        result = item->History;
+        item->History = nullptr;
+        this->HistoryHits++;
+        return result;
+    }
+    this->HistoryMisses++;
+    return result;
+}
+
+Collectable_SmartPtr<ApiQuery> EditPrefetcher::TakeContributions(WikiUser *user)
+{
+    Collectable_SmartPtr<ApiQuery> result;
+    EditPrefetcher_Item *found = this->findContributions(user);
+    if (found == nullptr)
+    {
+        this->ContributionsMisses++;
+        return result;
+    }
+    result = found->Contributions;
+    // the query can be shared by more items, all of them need to release it
+    foreach (EditPrefetcher_Item *item, this->items)
+    {
+        if (item->Contributions == result)
+            item->Contributions = nullptr;
+    }
+    this->ContributionsHits++;
+    return result;
+}
+
+bool EditPrefetcher::IsPreRendered(WikiEdit *edit, GenericBrowser *browser)
+{
+    EditPrefetcher_Item *item = this->findItem(edit);
+    return item != nullptr && item->RenderedIn == browser;
+}
+
+void EditPrefetcher::RecordDisplayLatency(qint64 msecs, bool pre_rendered)
+{
+    this->displayLatency[pre_rendered] += msecs;
+    this->displayCount[pre_rendered]++;
+}
+
+void EditPrefetcher::RecordHistoryLatency(qint64 msecs, bool prefetched)
+{
+    this->historyLatency[prefetched] += msecs;
+    this->historyCount[prefetched]++;
+}
+
+static QString EditPrefetcher_Average(qint64 sum, qint64 count)
+{
+    if (count == 0)
+        return "n/a";
+    return QString::number(sum / count) + " ms (" + QString::number(count) + " edits)";
+}
+
+QString EditPrefetcher::GetStatistics()
+{
+    return "history " + QString::number(this->HistoryHits) + " hits / " + QString::number(this->HistoryMisses) + " misses, contributions " +
+           QString::number(this->ContributionsHits) + " hits / " + QString::number(this->ContributionsMisses) + " misses, " +
+           "average display time " + EditPrefetcher_Average(this->displayLatency[1], this->displayCount[1]) + " pre rendered, " +
+           EditPrefetcher_Average(this->displayLatency[0], this->displayCount[0]) + " not pre rendered, " +
+           "average time to history " + EditPrefetcher_Average(this->historyLatency[1], this->historyCount[1]) + " prefetched, " +
+           EditPrefetcher_Average(this->historyLatency[0], this->historyCount[0]) + " not prefetched";
+}
+
+void EditPrefetcher::Clear()
+{
+    while (!this->items.isEmpty())
+        delete this->items.takeLast();
+}
+
+EditPrefetcher_Item *EditPrefetcher::findItem(WikiEdit *edit)
+{
+    foreach (EditPrefetcher_Item *item, this->items)
+    {
+        if (item->Edit == edit)
+            return item;
+    }
+    return nullptr;
+}
+
+EditPrefetcher_Item *EditPrefetcher::findContributions(WikiUser *user)
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    foreach (EditPrefetcher_Item *item, this->items)
+    {
+        if (item->Contributions == nullptr || item->Edit->User->GetSite() != user->GetSite() || item->Edit->User->Username != user->Username)
+            continue;
+        if (now - item->ContributionsTime > HUGGLE_PREFETCH_MAX_AGE * 1000)
+            continue;
+        if (item->Contributions->IsProcessed() && item->Contributions->IsFailed())
+            continue;
+        return item;
+    }
+    return nullptr;
+}
+
+void EditPrefetcher::buildHtml(EditPrefetcher_Item *item, GenericBrowser *browser)
+{
+    // native diff view is fast enough on its own, so there is nothing to render offscreen
+    if (hcfg->UserConfig->NativeDiffView)
+        return;
+    if (item->BuiltFor == browser && item->NewMessage == hcfg->NewMessage && item->DisplayTitle == hcfg->UserConfig->DisplayTitle)
+        return;
+    item->Edit->DecompressText();
+    item->NewMessage = hcfg->NewMessage;
+    item->DisplayTitle = hcfg->UserConfig->DisplayTitle;
+    item->Html = browser->GetDiffHtml(item->Edit);
+    item->BuiltFor = nullptr;
+    item->RenderedIn = nullptr;
+    if (item->Html.isEmpty())
+        return;
+    item->BuiltFor = browser;
+    // browsers that can't render offscreen ignore it, display of such edit isn't counted as pre rendered
+    if (browser->PreRender(item->Html))
+        item->RenderedIn = browser;
+}
@@ -0,0 +1,101 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#ifndef EDITPREFETCHER_HPP
+#define EDITPREFETCHER_HPP
+
+#include <huggle_core/definitions.hpp>
+
+#include <QList>
+#include <huggle_core/apiquery.hpp>
+#include <huggle_core/collectable_smartptr.hpp>
+#include <huggle_core/wikiedit.hpp>
+
+namespace Huggle
+{
+    class EditQueue;
+    class GenericBrowser;
+    class WikiPage;
+    class WikiUser;
+
+    class HUGGLE_EX_UI EditPrefetcher_Item
+    {
+        public:
+            Collectable_SmartPtr<WikiEdit> Edit;
+            //! History of page, taken by HistoryForm when the edit is displayed
+            Collectable_SmartPtr<ApiQuery> History;
+            //! Contributions of user, may be shared by several items of same user
+            Collectable_SmartPtr<ApiQuery> Contributions;
+            //! Time in msecs since epoch when the contributions query was started
+            qint64 ContributionsTime = 0;
+            QString Html;
+            //! Settings that change the html, if they differ from current ones the html needs to be built again
+            bool NewMessage;
+            bool DisplayTitle;
+            //! Browser for which the html was built, only used for comparison
+            GenericBrowser *BuiltFor = nullptr;
+            //! Browser in which the html was pre rendered, null if the browser can't render offscreen, only used for comparison
+            GenericBrowser *RenderedIn = nullptr;
+
+    };
+
+    /*!
+     * \brief The EditPrefetcher class prepares edits from top of the queue before they are displayed
+     *
+     * For first SystemConfig_PrefetchCount edits in queue it starts the history and contributions queries that
+     * would otherwise be started only after user moves to the edit, and it builds the diff html of best edit so
+     * that browser can render it offscreen. When the edit is displayed, the forms take over the queries, which are
+     * usually finished by then, and the browser only swaps the rendered page.
+     */
+    class HUGGLE_EX_UI EditPrefetcher
+    {
+        public:
+            EditPrefetcher();
+            ~EditPrefetcher();
+            //! Prefetch data for the edits that are now on top of the queue and forget the ones that are not
+            void Update(EditQueue *queue, GenericBrowser *browser);
+            //! Return prefetched history query of a page, or NULL, the query is removed from prefetcher
+            Collectable_SmartPtr<ApiQuery> TakeHistory(WikiPage *page);
+            //! Return prefetched contributions query of a user, or NULL, the query is removed from prefetcher
+            Collectable_SmartPtr<ApiQuery> TakeContributions(WikiUser *user);
+            //! Whether the diff of this edit was rendered offscreen before it was displayed
+            bool IsPreRendered(WikiEdit *edit, GenericBrowser *browser);
+            //! Record time that was needed to display an edit
+            void RecordDisplayLatency(qint64 msecs, bool pre_rendered);
+            //! Record time between request for history of displayed page and the moment it was shown
+            void RecordHistoryLatency(qint64 msecs, bool prefetched);
+            QString GetStatistics();
+            int Count();
+            void Clear();
+            qint64 HistoryHits = 0;
+            qint64 HistoryMisses = 0;
+            qint64 ContributionsHits = 0;
+            qint64 ContributionsMisses = 0;
+        private:
+            EditPrefetcher_Item *findItem(WikiEdit *edit);
+            //! Item with contributions of user that are recent enough to be used
+            EditPrefetcher_Item *findContributions(WikiUser *user);
+            void buildHtml(EditPrefetcher_Item *item, GenericBrowser *browser);
+            QList<EditPrefetcher_Item*> items;
+            // sums of latencies in msecs, index 0 is for edits that were not prepared, 1 for ones that were
+            qint64 displayLatency[2] = { 0, 0 };
+            qint64 displayCount[2] = { 0, 0 };
+            qint64 historyLatency[2] = { 0, 0 };
+            qint64 historyCount[2] = { 0, 0 };
+    };
+
+    inline int EditPrefetcher::Count()
+    {
+        return this->items.count();
+    }
+}
+
+#endif // EDITPREFETCHER_HPP
@@ -9,6 +9,10 @@
 //GNU General Public License for more details.
 
 #include "genericbrowser.hpp"
+#include "diffview.hpp"
+#include <QBoxLayout>
+#include <QDateTime>
+#include <huggle_core/diffdocument.hpp>
 #include <huggle_core/exception.hpp>
 #include <huggle_core/generic.hpp>
 #include <huggle_core/localization.hpp>
@@ -21,6 +25,50 @@
 
 using namespace Huggle;
 
+qint64 GenericBrowser::RenderTime[2] = { 0, 0 };
+qint64 GenericBrowser::RenderCount[2] = { 0, 0 };
+qint64 GenericBrowser::ResidentMemory[2] = { 0, 0 };
+qint64 GenericBrowser::ResidentMemorySamples[2] = { 0, 0 };
+// memory is sampled at most once in this number of seconds, because it needs to read whole process tree
+#define HUGGLE_RSS_SAMPLE_INTERVAL 10
+
+static QString GenericBrowser_FormatStatistics(const QString &name, int backend)
+{
+    QString result = name + ": ";
+    if (GenericBrowser::RenderCount[backend] == 0)
+        return result + "no diffs";
+    result += QString::number(GenericBrowser::RenderCount[backend]) + " diffs, average time to display " +
+              QString::number(GenericBrowser::RenderTime[backend] / GenericBrowser::RenderCount[backend]) + " ms";
+    if (GenericBrowser::ResidentMemorySamples[backend] > 0)
+    {
+        result += ", average memory " + QString::number(GenericBrowser::ResidentMemory[backend] / GenericBrowser::ResidentMemorySamples[backend] / (1024 * 1024)) +
+                  " MB";
+    }
+    return result;
+}
+
+QString GenericBrowser::GetRenderStatistics()
+{
+    return GenericBrowser_FormatStatistics("html browser", RenderBackendHtml) + "; " + GenericBrowser_FormatStatistics("native view", RenderBackendNative);
+}
+
+void GenericBrowser::recordRender(RenderBackend backend, qint64 msecs)
+{
+    // each backend is sampled on its own, otherwise frequent renders of one would starve the other
+    static qint64 last_sample[2] = { 0, 0 };
+    RenderTime[backend] += msecs;
+    RenderCount[backend]++;
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (now - last_sample[backend] < HUGGLE_RSS_SAMPLE_INTERVAL * 1000)
+        return;
+    last_sample[backend] = now;
+    qint64 memory = Generic::GetResidentMemory(true);
+    if (memory < 0)
+        return;
+    ResidentMemory[backend] += memory;
+    ResidentMemorySamples[backend]++;
+}
+
 GenericBrowser::GenericBrowser(QWidget *parent) : QFrame(parent)
 {
     this->CurrentPage = _l("browser-none");
@@ -112,6 +160,30 @@ static QString GenerateEditSumm(WikiEdit *edit)
     }
 }
 
+static QString DiffSummary(WikiEdit *edit)
+{
+    QString result;
+    if (Configuration::HuggleConfiguration->UserConfig->DisplayTitle)
+    {
+        result += "<p><font size=20px>" + Generic::HtmlEncode(edit->Page->PageName) + "</font></p>";
+    }
+    QString size;
+    if (edit->SizeIsKnown)
+    {
+        if (edit->GetSize() > 0)
+            size = "<font color=green>+" + QString::number(edit->GetSize()) + "</font>";
+        else if (edit->GetSize() == 0)
+            size = "<font color=blue>" + QString::number(edit->GetSize()) + "</font>";
+        else
+            size = "<font color=\"red\">" + QString::number(edit->GetSize()) + "</font>";
+    } else
+    {
+        size = "<font color=red>Unknown</font>";
+    }
+    result += GenerateEditSumm(edit) + "<b> Size change: " + size + "</b>" + Extras(edit);
+    return result;
+}
+
 void GenericBrowser::DisplayDiff(WikiEdit *edit)
 {
     this->CurrentEdit = edit;
@@ -131,7 +203,13 @@ void GenericBrowser::DisplayDiff(WikiEdit *edit)
     }
     if (!edit->DiffText.length())
     {
-        Huggle::Syslog::HuggleLogs->WarningLog("unable to retrieve diff for edit " + edit->Page->PageName + " fallback to web rendering");
+        if (edit->GetMemoryTier() == MemoryTierDropped)
+        {
+            HUGGLE_DEBUG("text of edit " + edit->Page->PageName + " was dropped from memory, retrieving it from wiki", 2);
+        } else
+        {
+            Huggle::Syslog::HuggleLogs->WarningLog("unable to retrieve diff for edit " + edit->Page->PageName + " fallback to web rendering");
+        }
         this->RenderHtml(_l("browser-load"));
         if (edit->DiffTo != "prev")
         {
@@ -144,60 +222,157 @@ void GenericBrowser::DisplayDiff(WikiEdit *edit)
         }
         return;
     }
+    // both backends are measured from the same point, so that parsing of diff for native view is included
+    this->startRenderMeasurement();
+    if (hcfg->UserConfig->NativeDiffView && this->displayNativeDiff(edit))
+        return;
+    this->RenderHtml(this->GetDiffHtml(edit));
+}
+
+void GenericBrowser::DisplayNewPageEdit(WikiEdit *edit)
+{
+    if (!edit)
+        throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
+
+    this->CurrentEdit = edit;
+    this->startRenderMeasurement();
+    this->RenderHtml(this->GetDiffHtml(edit));
+}
+
+bool GenericBrowser::PreRender(const QString &html)
+{
+    Q_UNUSED(html);
+    return false;
+}
+
+QString GenericBrowser::GetDiffHtml(WikiEdit *edit)
+{
+    if (edit == nullptr)
+        throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
+    if (edit->Page == nullptr)
+        throw new Huggle::NullPointerException("*edit->Page", BOOST_CURRENT_FUNCTION);
+    // these need to be loaded from wiki
+    if (edit->NewPage && edit->Page->Contents.isEmpty())
+        return QString();
+    if (!edit->NewPage && edit->DiffText.isEmpty())
+        return QString();
+
     QString HTML = Resources::GetHtmlHeader(edit->GetSite());
     if (Configuration::HuggleConfiguration->NewMessage)
     {
         // we display a notification that user received a new message
         HTML += this->GetShortcut();
     }
-    HTML += Resources::DiffHeader + "<tr><td colspan=2>";
-    if (Configuration::HuggleConfiguration->UserConfig->DisplayTitle)
-    {
-        HTML += "<p><font size=20px>" + Generic::HtmlEncode(edit->Page->PageName) + "</font></p>";
-    }
-    QString Summary = GenerateEditSumm(edit);
-    QString size;
-    if (edit->SizeIsKnown)
-    {
-        if (edit->GetSize() > 0)
-            size = "<font color=green>+" + QString::number(edit->GetSize()) + "</font>";
-        else if (edit->GetSize() == 0)
-            size = "<font color=blue>" + QString::number(edit->GetSize()) + "</font>";
-        else
-            size = "<font color=\"red\">" + QString::number(edit->GetSize()) + "</font>";
-    } else
+    if (edit->NewPage)
     {
-        size = "<font color=red>Unknown</font>";
+        if (Configuration::HuggleConfiguration->UserConfig->DisplayTitle)
+        {
+            HTML += "<p><font size=20px>" + Generic::HtmlEncode(edit->Page->PageName) + "</font></p>";
+        }
+        QString Summary = GenerateEditSumm(edit);
+        HTML += Summary + Extras(edit) + "<br>" + edit->Page->Contents + Resources::HtmlFooter;
+        return HTML;
     }
-    Summary += "<b> Size change: " + size + "</b>";
-    HTML += Summary + Extras(edit) + "</td></tr>" + edit->DiffText +
+    HTML += Resources::DiffHeader + "<tr><td colspan=2>" + DiffSummary(edit) + "</td></tr>" + edit->DiffText +
             Resources::DiffFooter + Resources::HtmlFooter;
-    this->RenderHtml(HTML);
+    return HTML;
 }
 
-void GenericBrowser::DisplayNewPageEdit(WikiEdit *edit)
+QWidget *GenericBrowser::GetHtmlWidget()
 {
-    if (!edit)
-        throw new Huggle::NullPointerException("WikiEdit *edit", BOOST_CURRENT_FUNCTION);
+    return nullptr;
+}
 
-    this->CurrentEdit = edit;
-    QString HTML = Resources::GetHtmlHeader(edit->GetSite());
-    if (Configuration::HuggleConfiguration->NewMessage)
+void GenericBrowser::HideNativeDiff()
+{
+    if (this->nativeDiff == nullptr || this->nativeDiff->isHidden())
+        return;
+    this->nativeDiff->hide();
+    // release the layouts of previous diff, they can be quite large
+    this->nativeDiff->Clear();
+    QWidget *html = this->GetHtmlWidget();
+    if (html != nullptr)
+        html->show();
+}
+
+void GenericBrowser::FinishRenderMeasurement()
+{
+    if (!this->measuringRender || this->renderBackend != RenderBackendHtml)
+        return;
+    this->measuringRender = false;
+    qint64 msecs = this->renderTimer.elapsed();
+    recordRender(RenderBackendHtml, msecs);
+    emit this->DiffRendered(msecs);
+}
+
+bool GenericBrowser::IsNativeDiffDisplayed()
+{
+    return this->nativeDiff != nullptr && !this->nativeDiff->isHidden();
+}
+
+void GenericBrowser::ReleaseHtml()
+{
+
+}
+
+void GenericBrowser::OnNativeDiffRendered()
+{
+    if (!this->measuringRender || this->renderBackend != RenderBackendNative)
+        return;
+    this->measuringRender = false;
+    qint64 msecs = this->renderTimer.elapsed();
+    recordRender(RenderBackendNative, msecs);
+    emit this->DiffRendered(msecs);
+}
+
+bool GenericBrowser::displayNativeDiff(WikiEdit *edit)
+{
+    QWidget *html = this->GetHtmlWidget();
+    QBoxLayout *layout = qobject_cast<QBoxLayout*>(this->layout());
+    if (html == nullptr || layout == nullptr)
+        return false;
+    DiffDocument document;
+    if (!document.Parse(edit->DiffText))
     {
-        // we display a notification that user received a new message
-        HTML += this->GetShortcut();
+        HUGGLE_DEBUG("unable to parse diff of " + edit->Page->PageName + ", falling back to html browser", 2);
+        return false;
     }
-    if (Configuration::HuggleConfiguration->UserConfig->DisplayTitle)
+    if (this->nativeDiff == nullptr)
+    {
+        this->nativeDiff = new DiffView(this);
+        connect(this->nativeDiff, SIGNAL(Rendered()), this, SLOT(OnNativeDiffRendered()));
+        layout->insertWidget(layout->indexOf(html), this->nativeDiff);
+    }
+    // the measurement was started by DisplayDiff, now it belongs to native view
+    this->renderBackend = RenderBackendNative;
+    QString header;
+    if (Configuration::HuggleConfiguration->NewMessage)
+        header += this->GetShortcut();
+    header += DiffSummary(edit);
+    this->nativeDiff->Display(document, header, edit->ScoreWords);
+    if (!html->isHidden())
     {
-        HTML += "<p><font size=20px>" + Generic::HtmlEncode(edit->Page->PageName) + "</font></p>";
+        html->hide();
+        this->ReleaseHtml();
     }
-    QString Summary = GenerateEditSumm(edit);
-    HTML += Summary + Extras(edit) + "<br>" + edit->Page->Contents + Resources::HtmlFooter;
-    this->RenderHtml(HTML);
+    this->nativeDiff->show();
+    return true;
+}
+
+void GenericBrowser::startRenderMeasurement()
+{
+    this->measuringRender = true;
+    this->renderBackend = RenderBackendHtml;
+    this->renderTimer.start();
 }
 
 void GenericBrowser::Find(QString text)
 {
+    if (this->IsNativeDiffDisplayed())
+    {
+        this->nativeDiff->Find(text);
+        return;
+    }
     HUGGLE_ERROR("This browser doesn't support this feature");
 }
 
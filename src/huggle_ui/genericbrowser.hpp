@@ -13,6 +13,7 @@
 
 #include <huggle_core/definitions.hpp>
 
+#include <QElapsedTimer>
 #include <QFrame>
 #include <huggle_core/collectable_smartptr.hpp>
 #include <huggle_core/wikiedit.hpp>
@@ -24,6 +25,7 @@ namespace Ui
 
 namespace Huggle
 {
+    class DiffView;
     class WikiPage;
     class Resources;
 
@@ -31,6 +33,20 @@ namespace Huggle
     {
             Q_OBJECT
         public:
+            //! Index of statistics for diffs rendered by html browser and by native diff view
+            enum RenderBackend
+            {
+                RenderBackendHtml,
+                RenderBackendNative
+            };
+            //! Time in msecs from request to display a diff until it was rendered, summed per backend
+            static qint64 RenderTime[2];
+            static qint64 RenderCount[2];
+            //! Resident memory of huggle including child processes in bytes, sampled after diffs were rendered
+            static qint64 ResidentMemory[2];
+            static qint64 ResidentMemorySamples[2];
+            static QString GetRenderStatistics();
+
             explicit GenericBrowser(QWidget *parent = nullptr);
              ~GenericBrowser() override;
             virtual QString CurrentPageName();
@@ -57,15 +73,56 @@ namespace Huggle
              */
             virtual void DisplayDiff(WikiEdit *edit);
             virtual void DisplayNewPageEdit(WikiEdit *edit);
+            /*!
+             * \brief Render a html that is likely to be displayed next, so that RenderHtml with same html is instant
+             *
+             * Browsers that can't render offscreen simply ignore this
+             * \return true if the html is being rendered offscreen
+             */
+            virtual bool PreRender(const QString &html);
+            //! Html of diff or new page of an edit, empty if the edit doesn't have its text and needs to be loaded from wiki
+            QString GetDiffHtml(WikiEdit *edit);
             virtual void Find(QString text);
             virtual void ToggleSearchWidget();
             virtual QString RetrieveHtml()=0;
             static QString Encode(const QString &string);
             Collectable_SmartPtr<WikiEdit> CurrentEdit;
 
+        signals:
+            //! Emitted when diff requested by DisplayDiff was rendered, msecs is the time since the request
+            void DiffRendered(qint64 msecs);
+
+        protected:
+            //! Widget that displays html, it's hidden while native diff view is displayed, NULL if native view isn't supported
+            virtual QWidget *GetHtmlWidget();
+            //! Switch back from native diff view, browsers need to call this whenever they display html or a page
+            void HideNativeDiff();
+            //! Called by browsers when html of diff was rendered
+            void FinishRenderMeasurement();
+            //! Whether diff is displayed by native view instead of html widget
+            bool IsNativeDiffDisplayed();
+            /*!
+             * \brief Called when native view replaced the html widget
+             *  Browsers that run the html engine in separate processes should release their pages here, so that
+             *  they don't keep memory while the native view is used
+             */
+            virtual void ReleaseHtml();
+
+        private slots:
+            void OnNativeDiffRendered();
+
         private:
+            static void recordRender(RenderBackend backend, qint64 msecs);
             virtual QString GetShortcut();
+            //! Display diff using native view, returns false if it's not possible
+            bool displayNativeDiff(WikiEdit *edit);
+            void startRenderMeasurement();
             QString CurrentPage;
+            DiffView *nativeDiff = nullptr;
+            QElapsedTimer renderTimer;
+            bool measuringRender = false;
+            //! Backend that displays the diff which is being measured
+            RenderBackend renderBackend = RenderBackendHtml;
     };
 }
 
@@ -177,14 +177,14 @@ void History::ContextMenu(const QPoint &position)
             case HistoryEdit:
             case HistoryRollback:
                 // let's see if we know this edit
-                edit = WikiEdit::FromCacheByRevID(hi->RevID);
+                edit = WikiEdit::FromCacheByRevID(hi->RevID, "prev", hi->GetSite());
                 if (edit == nullptr)
                 {
                     // if we don't know it we need to create it
                     edit = new WikiEdit();
                     edit->Page = new WikiPage(page, hi->GetSite());
                     edit->User = new WikiUser(hcfg->SystemConfig_UserName, hi->GetSite());
-                    edit->RevID = hi->RevID;
+                    edit->SetRevID(hi->RevID);
                 }
                 break;
             case HistoryUnknown:
@@ -279,7 +279,7 @@ void History::Tick()
         }
         edit->User = new WikiUser(Configuration::HuggleConfiguration->SystemConfig_UserName, site);
         edit->Page->SetContent(result);
-        edit->RevID = revid;
+        edit->SetRevID(revid);
         if (this->RevertingItem->NewPage && this->RevertingItem->Type == HistoryMessage)
         {
             int message = UiGeneric::MessageBox(_l("history-welcome-msg-title"), _l("history-welcome-msg"), MessageBoxStyleQuestion);
@@ -27,6 +27,7 @@
 #include <huggle_core/wikiuser.hpp>
 #include <huggle_core/wikiutil.hpp>
 #include "editbar.hpp"
+#include "editprefetcher.hpp"
 #include "mainwindow.hpp"
 #include "ui_historyform.h"
 
@@ -85,14 +86,28 @@ HistoryForm::~HistoryForm()
     delete this->ui;
 }
 
+ApiQuery *HistoryForm::CreateQuery(WikiPage *page)
+{
+    ApiQuery *query = new ApiQuery(ActionQuery, page->GetSite());
+    query->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|flags|timestamp|user|userid|size|sha1|comment") + "&rvlimit=" +
+        QString::number(hcfg->UserConfig->HistoryMax) + "&titles=" + QUrl::toPercentEncoding(page->PageName);
+    return query;
+}
+
 void HistoryForm::Read()
 {
     //this->ui->pushButton->setText(Localizations::HuggleLocalizations->nullptrze("historyform-retrieving-history"));
     this->ui->pushButton->hide();
-    this->query = new ApiQuery(ActionQuery, this->CurrentEdit->GetSite());
-    this->query->Parameters = "prop=revisions&rvprop=" + QUrl::toPercentEncoding("ids|flags|timestamp|user|userid|size|sha1|comment") + "&rvlimit=" +
-        QString::number(hcfg->UserConfig->HistoryMax) + "&titles=" + QUrl::toPercentEncoding(this->CurrentEdit->Page->PageName);
-    this->query->Process();
+    this->readTimer.start();
+    // history of edits on top of the queue is usually retrieved before they are displayed
+    this->query = MainWindow::HuggleMain->Prefetcher->TakeHistory(this->CurrentEdit->Page);
+    this->queryPrefetched = this->query != nullptr;
+    this->refreshingHistory = false;
+    if (!this->queryPrefetched)
+    {
+        this->query = CreateQuery(this->CurrentEdit->Page);
+        this->query->Process();
+    }
     delete this->t1;
     this->t1 = new QTimer(this);
     this->Clear();
@@ -122,6 +137,7 @@ void HistoryForm::Update(WikiEdit *edit)
     {
         this->query = nullptr;
     }
+    this->refreshingHistory = false;
 }
 
 void HistoryForm::onTick01()
@@ -155,6 +171,8 @@ void HistoryForm::onTick01()
         return;
     }
     bool IsLatest = false;
+    // current history replaces the prefetched one
+    this->Clear();
     QList<ApiQueryResultNode*> revision_data = this->query->GetApiQueryResult()->GetNodes("rev");
     int x = 0;
     while (x < revision_data.count())
@@ -200,6 +218,7 @@ void HistoryForm::onTick01()
             item->Type = EditType_W;
             icon = QIcon(":/huggle/pictures/Resources/blob-ignored.png");
         }
+        WikiUser::ProblematicUserListLock.lock();
         WikiUser *wu = WikiUser::RetrieveUser(item->User, item->Site);
         if (wu != nullptr)
         {
@@ -231,6 +250,7 @@ void HistoryForm::onTick01()
                 }
             }
         }
+        WikiUser::ProblematicUserListLock.unlock();
         bool selected = this->CurrentEdit->RevID == item->RevID.toInt();
         if (selected && x == 0)
             IsLatest = true;
@@ -262,6 +282,19 @@ void HistoryForm::onTick01()
     }
     this->ui->tableWidget->resizeRowsToContents();
     this->query = nullptr;
+    if (!this->refreshingHistory)
+        MainWindow::HuggleMain->Prefetcher->RecordHistoryLatency(this->readTimer.elapsed(), this->queryPrefetched);
+    if (this->queryPrefetched)
+    {
+        // prefetched history may be missing edits that were made since it was retrieved, so it's only displayed and
+        // the decision whether this is the latest revision is made once the current history arrives
+        this->queryPrefetched = false;
+        this->refreshingHistory = true;
+        this->query = CreateQuery(this->CurrentEdit->Page);
+        this->query->Process();
+        return;
+    }
+    this->refreshingHistory = false;
     this->t1->stop();
     if (!this->CurrentEdit->NewPage && !Configuration::HuggleConfiguration->ForceNoEditJump && !IsLatest)
     {
@@ -376,7 +409,7 @@ void HistoryForm::GetEdit(long revid, QString prev, int row, QString html, bool
 void HistoryForm::GetEdit(long revid, QString prev, QString user, QString html, bool turtlemode)
 {
     this->RetrievingEdit = true;
-    Collectable_SmartPtr<WikiEdit> edit = WikiEdit::FromCacheByRevID(revid, prev);
+    Collectable_SmartPtr<WikiEdit> edit = WikiEdit::FromCacheByRevID(revid, prev, this->CurrentEdit->GetSite());
     if (edit != nullptr)
     {
         MainWindow::HuggleMain->ProcessEdit(edit, false, true);
@@ -392,11 +425,11 @@ void HistoryForm::GetEdit(long revid, QString prev, QString user, QString html,
     if (prev == "prev")
     {
         w->DiffTo = prev;
-        w->RevID = revid;
+        w->SetRevID(revid);
     } else
     {
         w->DiffTo = QString::number(revid);
-        w->RevID = prev.toLongLong();
+        w->SetRevID(prev.toLongLong());
     }
     w->User = new WikiUser(user, this->CurrentEdit->GetSite());
     w->Page = new WikiPage(this->CurrentEdit->Page);
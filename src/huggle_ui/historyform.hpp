@@ -14,6 +14,7 @@
 #include <huggle_core/definitions.hpp>
 
 #include <QDockWidget>
+#include <QElapsedTimer>
 #include <huggle_core/apiquery.hpp>
 #include <huggle_core/edittype.hpp>
 #include <huggle_core/mediawikiobject.hpp>
@@ -62,6 +63,8 @@ namespace Huggle
             ~HistoryForm();
             void GetEdit(long revid, QString prev, int row, QString html, bool turtlemode = false);
             void GetEdit(long revid, QString prev, QString user, QString html, bool turtlemode = false);
+            //! Create a query that retrieves history of a page, it's not processed yet
+            static ApiQuery *CreateQuery(WikiPage *page);
             void Read();
             void Update(WikiEdit *edit);
             QList<WikiPageHistoryItem*> Items;
@@ -81,6 +84,12 @@ namespace Huggle
             Ui::HistoryForm *ui;
             Collectable_SmartPtr<WikiEdit> CurrentEdit;
             Collectable_SmartPtr<ApiQuery> query;
+            //! Whether the query was taken from prefetcher
+            bool queryPrefetched = false;
+            //! Prefetched history is displayed and the query is retrieving current one, which decides whether to jump to newer edit
+            bool refreshingHistory = false;
+            //! Measures time since the history was requested, for statistics
+            QElapsedTimer readTimer;
             int PreviouslySelectedRow;
             int SelectedRow;
             Collectable_SmartPtr<WikiEdit> RetrievedEdit;
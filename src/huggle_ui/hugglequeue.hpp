@@ -14,10 +14,7 @@
 #include <huggle_core/definitions.hpp>
 
 #include <QDockWidget>
-#include <QList>
-#include <QFrame>
-#include <QWidget>
-#include <QVBoxLayout>
+#include <QModelIndex>
 #include <huggle_core/editqueue.hpp>
 #include <huggle_core/hugglequeuefilter.hpp>
 //#include "wikiedit.hpp"
@@ -29,11 +26,11 @@ namespace Ui
 
 namespace Huggle
 {
+    class EditQueueModel;
     class HuggleQueueFilter;
-    class HuggleQueueItemLabel;
+    class HuggleQueueItemDelegate;
     class WikiEdit;
     class WikiSite;
-    class WikiUser;
 
     //! Queue of edits
     class HUGGLE_EX_UI HuggleQueue : public QDockWidget, public EditQueue
@@ -49,40 +46,26 @@ namespace Huggle
              * \param page is a pointer to wiki edit you want to insert to queue
              */
             void AddItem(WikiEdit *edit);
-            void Delete(HuggleQueueItemLabel *item, QLayoutItem *qi = nullptr);
-            /*!
-             * \brief DeleteByScore deletes all edits that have lower than specified score
-             * \param Score
-             * \return number of records that matched the score
-             */
-            int DeleteByScore(long Score);
-            bool DeleteByRevID(revid_ht RevID, WikiSite *site);
-            //! Delete all edits to the page that are older than this edit
-            void DeleteOlder(WikiEdit *edit);
-            void UpdateUser(WikiUser *user);
             //! Reload filters
             void Filters();
             //! Switch and render next edit in queue
             bool Next();
-            WikiEdit *GetWikiEditByRevID(revid_ht RevID, WikiSite *site);
-            void Sort();
             void SortItemByEdit(WikiEdit *e);
-            void Trim(unsigned int i);
-            //! Remove 1 item
-            void Trim();
-            void Clear();
             void RedrawTitle();
             WikiSite *CurrentSite();
             void ChangeSite(WikiSite *site);
-            QList<HuggleQueueItemLabel*> Items;
+        protected:
+            bool canRemove(WikiEdit *edit);
         private slots:
             void on_comboBox_currentIndexChanged(int index);
+            void on_itemList_pressed(const QModelIndex &index);
+            void OnQueueChanged();
         private:
-            long GetScore(int id);
-            void ResortItem(QLayoutItem *item, int position = -1);
-            //! Internal function
-            bool DeleteItem(HuggleQueueItemLabel *item);
+            //! Remove edit from queue and open it
+            void processItem(int row);
             Ui::HuggleQueue *ui;
+            EditQueueModel *queueModel;
+            HuggleQueueItemDelegate *delegate;
             bool loading;
     };
 }
@@ -0,0 +1,87 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#include "hugglequeueitemdelegate.hpp"
+#include <huggle_core/editqueuemodel.hpp>
+#include <QApplication>
+#include <QCryptographicHash>
+#include <QFrame>
+#include <QPainter>
+#include <QStyleOptionFrame>
+
+using namespace Huggle;
+
+//! Height of one item in queue
+#define HUGGLEQUEUE_ITEM_HEIGHT 20
+
+HuggleQueueItemDelegate::HuggleQueueItemDelegate(QObject *parent) : QStyledItemDelegate(parent)
+{
+
+}
+
+void HuggleQueueItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionFrame frame;
+    frame.rect = option.rect;
+    frame.state = option.state | QStyle::State_Raised;
+    frame.lineWidth = 1;
+    frame.frameShape = QFrame::StyledPanel;
+    QStyle *style = option.widget ? option.widget->style() : QApplication::style();
+    style->drawPrimitive(QStyle::PE_Frame, &frame, painter, option.widget);
+
+    painter->save();
+    QRect rect = option.rect;
+    const QPixmap &pixmap = this->getPixmap(index.data(EditQueueModel::PixmapRole).toString());
+    if (!pixmap.isNull())
+    {
+        QRect icon(rect.left(), rect.top() + (rect.height() - pixmap.height()) / 2, pixmap.width(), pixmap.height());
+        painter->drawPixmap(icon, pixmap);
+        rect.setLeft(icon.right() + 8);
+    }
+    QString name = index.data(Qt::DisplayRole).toString();
+    int ns = index.data(EditQueueModel::NamespaceRole).toInt();
+    if (ns != 0)
+    {
+        QRect background = rect;
+        background.setWidth(qMin(rect.width(), option.fontMetrics.width(name)));
+        painter->fillRect(background, this->getColor(ns));
+    }
+    painter->setPen(option.palette.color(QPalette::Text));
+    painter->drawText(rect, Qt::AlignVCenter | Qt::AlignLeft, option.fontMetrics.elidedText(name, Qt::ElideRight, rect.width()));
+    painter->restore();
+}
+
+QSize HuggleQueueItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    Q_UNUSED(index);
+    return QSize(option.rect.width(), HUGGLEQUEUE_ITEM_HEIGHT);
+}
+
+QColor HuggleQueueItemDelegate::getColor(int id) const
+{
+    if (this->colors.contains(id))
+        return this->colors[id];
+
+    // let's create some hash color from the id
+    QString color = QString(QCryptographicHash::hash(QString::number(id).toUtf8(), QCryptographicHash::Md5).toHex());
+    if (color.length() > 6)
+        color = color.mid(0, 6);
+    QColor result("#" + color);
+    this->colors.insert(id, result);
+    return result;
+}
+
+const QPixmap &HuggleQueueItemDelegate::getPixmap(const QString &path) const
+{
+    if (!this->pixmaps.contains(path))
+        this->pixmaps.insert(path, QPixmap(path));
+    return this->pixmaps[path];
+}
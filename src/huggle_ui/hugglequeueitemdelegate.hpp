@@ -0,0 +1,40 @@
+//This program is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+
+#ifndef HUGGLEQUEUEITEMDELEGATE_HPP
+#define HUGGLEQUEUEITEMDELEGATE_HPP
+
+#include <huggle_core/definitions.hpp>
+
+#include <QHash>
+#include <QPixmap>
+#include <QStyledItemDelegate>
+
+namespace Huggle
+{
+    //! Paints items of edit queue, replaces the widget that used to be created for every edit
+    class HUGGLE_EX_UI HuggleQueueItemDelegate : public QStyledItemDelegate
+    {
+            Q_OBJECT
+        public:
+            explicit HuggleQueueItemDelegate(QObject *parent = nullptr);
+            void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+            QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+
+        private:
+            QColor getColor(int id) const;
+            const QPixmap &getPixmap(const QString &path) const;
+            mutable QHash<int, QColor> colors;
+            mutable QHash<QString, QPixmap> pixmaps;
+    };
+}
+
+#endif // HUGGLEQUEUEITEMDELEGATE_HPP
@@ -179,7 +179,7 @@ void HuggleTool::FinishPage()
         this->edit = new WikiEdit();
         this->edit->Page = new WikiPage(item->GetAttribute("title"), this->query->GetSite());
         this->edit->User = new WikiUser(item->GetAttribute("user"), this->query->GetSite());
-        this->edit->RevID = item->GetAttribute("revid").toInt();
+        this->edit->SetRevID(item->GetAttribute("revid").toLongLong());
         QueryPool::HugglePool->PreProcessEdit(this->edit);
         QueryPool::HugglePool->PostProcessEdit(this->edit);
         this->QueryPhase = 4;
@@ -205,7 +205,7 @@ void HuggleTool::FinishPage()
                 this->edit->User = new WikiUser(rev->GetAttribute("user"), this->query->GetSite());
             }
             if (rev->Attributes.contains("revid"))
-                this->edit->RevID = rev->GetAttribute("revid").toInt();
+                this->edit->SetRevID(rev->GetAttribute("revid").toLongLong());
         }
         if (this->edit->User == nullptr)
         {
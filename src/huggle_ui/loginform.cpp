@@ -21,6 +21,7 @@
 #include <huggle_core/syslog.hpp>
 #include <huggle_core/wikisite.hpp>
 #include <huggle_core/wikiutil.hpp>
+#include <huggle_core/wlquery.hpp>
 #include <QCheckBox>
 #include <QFile>
 #include <QUrl>
@@ -754,16 +755,41 @@ void LoginForm::retrieveWhitelist(WikiSite *site)
         if (query->IsProcessed())
         {
             this->wlQueries.remove(site);
-            if (query->IsFailed())
+            ProjectConfiguration *conf = site->GetProjectConfig();
+            if (query->WL_Type == WLQueryType_ReadWLChanges)
+            {
+                // we already have a snapshot of whitelist, so failure here is not fatal, we just use what we have
+                if (query->IsFailed())
+                {
+                    Syslog::HuggleLogs->WarningLog("Unable to retrieve changes of whitelist for " + site->Name + ", using local copy: "
+                                                   + query->GetFailureReason());
+                } else
+                {
+                    QStringList changes = WLQuery::ParseList(query->Result->Data);
+                    HUGGLE_DEBUG("Merging " + QString::number(changes.count()) + " whitelist changes for " + site->Name, 2);
+                    conf->WhiteList.unite(changes.toSet());
+                    HuggleQueueFilter::InvalidateProperties();
+                    // only the time of changes moves forward, age of the snapshot is still counted from last full download,
+                    // if server didn't tell us its time we keep the old one and just get some of the changes again next time
+                    if (query->ServerTime.isValid())
+                        conf->WhitelistTime = query->ServerTime.addSecs(-HUGGLE_WL_SINCE_OVERLAP);
+                    conf->SaveWhitelistSnapshot(Configuration::GetWhitelistSnapshotPath(site));
+                }
+            } else if (query->IsFailed())
             {
                 //! \todo This needs to be handled per project, there is no point in disabling WL on all projects
                 hcfg->SystemConfig_WhitelistDisabled = true;
             } else
             {
-                QString list = query->Result->Data;
-                list = list.replace("<!-- list -->", "");
-                site->GetProjectConfig()->WhiteList = list.split("|");
-                site->GetProjectConfig()->WhiteList.removeAll("");
+                conf->WhiteList = WLQuery::ParseList(query->Result->Data).toSet();
+                HuggleQueueFilter::InvalidateProperties();
+                // clock of this computer may differ from the server, so we use the time of server whenever it's known,
+                // users added while the list was being sent are part of next delta thanks to the overlap
+                QDateTime time = query->ServerTime.isValid() ? query->ServerTime : query->StartTime;
+                conf->WhitelistTime = time.addSecs(-HUGGLE_WL_SINCE_OVERLAP);
+                conf->WhitelistSnapshotTime = conf->WhitelistTime;
+                if (hcfg->SystemConfig_WhitelistSnapshotAge > 0)
+                    conf->SaveWhitelistSnapshot(Configuration::GetWhitelistSnapshotPath(site));
             }
             this->processedWL[site] = true;
             this->loadingForm->ModifyIcon(this->GetRowIDForSite(site, LOGINFORM_WHITELIST), LoadingForm_Icon_Success);
@@ -773,6 +799,13 @@ void LoginForm::retrieveWhitelist(WikiSite *site)
     }
     this->loadingForm->ModifyIcon(this->GetRowIDForSite(site, LOGINFORM_WHITELIST), LoadingForm_Icon_Loading);
     WLQuery *query = new WLQuery(site);
+    if (hcfg->SystemConfig_WhitelistSnapshotAge > 0 &&
+            site->GetProjectConfig()->LoadWhitelistSnapshot(Configuration::GetWhitelistSnapshotPath(site), hcfg->SystemConfig_WhitelistSnapshotAge))
+    {
+        // we have a recent copy of whitelist on disk, so we only need to download what was added since then
+        query->WL_Type = WLQueryType_ReadWLChanges;
+        query->Since = site->GetProjectConfig()->WhitelistTime;
+    }
     query->IncRef();
     this->wlQueries.insert(site, query);
     query->RetryOnTimeoutFailure = false;
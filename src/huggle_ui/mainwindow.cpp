@@ -14,11 +14,11 @@
 #include "deleteform.hpp"
 #include "editbar.hpp"
 #include "editform.hpp"
+#include "editprefetcher.hpp"
 #include "history.hpp"
 #include "hugglelog.hpp"
 #include "huggletool.hpp"
 #include "hugglequeue.hpp"
-#include "hugglequeueitemlabel.hpp"
 #include "ignorelist.hpp"
 #include "speedyform.hpp"
 #include "userinfoform.hpp"
@@ -48,10 +48,13 @@
 #include <huggle_core/apiqueryresult.hpp>
 #include <huggle_core/events.hpp>
 #include <huggle_core/configuration.hpp>
+#include <huggle_core/editaggregator.hpp>
 #include <huggle_core/generic.hpp>
 #include <huggle_core/gc.hpp>
 #include <huggle_core/querypool.hpp>
 #include <huggle_core/hooks.hpp>
+#include <huggle_core/memorybudget.hpp>
+#include <huggle_core/reputationstore.hpp>
 #include <huggle_core/hugglefeedproviderwiki.hpp>
 #include <huggle_core/hugglefeedproviderirc.hpp>
 #include <huggle_core/hugglefeedproviderxml.hpp>
@@ -98,6 +101,36 @@
 using namespace Huggle;
 MainWindow *MainWindow::HuggleMain = nullptr;
 
+static qint64 MemoryBudget_QueueSize(void *source)
+{
+    return ((HuggleQueue*)source)->GetMemoryUsage();
+}
+
+static qint64 MemoryBudget_QueueEvict(void *source, qint64 bytes)
+{
+    return ((HuggleQueue*)source)->TrimMemory(bytes);
+}
+
+static qint64 MemoryBudget_HistorySize(void *source)
+{
+    return ((MainWindow*)source)->GetHistoryMemoryUsage();
+}
+
+static qint64 MemoryBudget_HistoryEvict(void *source, qint64 bytes)
+{
+    return ((MainWindow*)source)->TrimHistory(bytes);
+}
+
+static qint64 MemoryBudget_HANSize(void *source)
+{
+    return ((VandalNw*)source)->GetCacheMemoryUsage();
+}
+
+static qint64 MemoryBudget_HANEvict(void *source, qint64 bytes)
+{
+    return ((VandalNw*)source)->TrimCache(bytes);
+}
+
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWindow)
 {
     if (MainWindow::HuggleMain)
@@ -134,6 +167,10 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     this->TrayIcon.show();
     this->TrayIcon.setToolTip("Huggle");
     this->Queue1 = new HuggleQueue(this);
+    if (hcfg->SystemConfig_QueueSnapshotInterval > 0)
+        this->restoredEdits = this->Queue1->LoadSnapshot(Configuration::GetQueueSnapshotPath(), hcfg->SystemConfig_QueueSnapshotMaxAge);
+    this->Aggregator = new EditAggregator();
+    this->Prefetcher = new EditPrefetcher();
     this->wEditBar = new EditBar(this);
     this->_History = new History(this);
     this->wHistory = new HistoryForm(this);
@@ -163,8 +200,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     this->SystemLog->resize(100, 80);
     foreach (WikiSite *site, hcfg->Projects)
     {
-        if (!site->GetProjectConfig()->WhiteList.contains(hcfg->SystemConfig_UserName))
-            site->GetProjectConfig()->WhiteList.append(hcfg->SystemConfig_UserName);
+        site->GetProjectConfig()->WhiteList.insert(hcfg->SystemConfig_UserName);
     }
     QString projects;
     if (hcfg->SystemConfig_Multiple)
@@ -314,11 +350,20 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     connect(Events::Global, SIGNAL(System_WarningMessage(QString,QString)), this, SLOT(OnWarning(QString,QString)));
     connect(Events::Global, SIGNAL(System_YesNoQuestion(QString,QString,bool*)), this, SLOT(OnQuestion(QString,QString,bool*)));
     this->EnableEditing(false);
+    MemoryBudget::HuggleMemoryBudget->Register("queue", HUGGLE_MEMORY_PRIORITY_QUEUE, this->Queue1, MemoryBudget_QueueSize, MemoryBudget_QueueEvict);
+    MemoryBudget::HuggleMemoryBudget->Register("history", HUGGLE_MEMORY_PRIORITY_HISTORY, this, MemoryBudget_HistorySize, MemoryBudget_HistoryEvict);
+    MemoryBudget::HuggleMemoryBudget->Register("HAN", HUGGLE_MEMORY_PRIORITY_HAN, this->VandalDock, MemoryBudget_HANSize, MemoryBudget_HANEvict);
     UiHooks::MainWindow_OnLoad(this);
 }
 
 MainWindow::~MainWindow()
 {
+    if (MemoryBudget::HuggleMemoryBudget)
+    {
+        MemoryBudget::HuggleMemoryBudget->Unregister(this->Queue1);
+        MemoryBudget::HuggleMemoryBudget->Unregister(this);
+        MemoryBudget::HuggleMemoryBudget->Unregister(this->VandalDock);
+    }
     while (this->Historical.count())
     {
         this->Historical.at(0)->UnregisterConsumer(HUGGLECONSUMER_MAINFORM_HISTORICAL);
@@ -358,6 +403,8 @@ MainWindow::~MainWindow()
     delete this->fScoreWord;
     delete this->fWhitelist;
     delete this->Ignore;
+    delete this->Aggregator;
+    delete this->Prefetcher;
     delete this->Queue1;
     delete this->SystemLog;
     delete this->Status;
@@ -551,8 +598,15 @@ void MainWindow::ProcessEdit(WikiEdit *e, bool IgnoreHistory, bool KeepHistory,
     this->Queue1->ChangeSite(e->GetSite());
     e->User->Resync();
     Configuration::HuggleConfiguration->ForceNoEditJump = ForcedJump;
+    // previous edit was reviewed, so we don't need to keep its text in plain form
+    if (this->CurrentEdit != nullptr && this->CurrentEdit != e && hcfg->SystemConfig_CompressReviewedEdits)
+        this->CurrentEdit->CompressText();
+    e->DecompressText();
     this->CurrentEdit = e;
     this->editLoadDateTime = QDateTime::currentDateTime();
+    // browser may render the diff asynchronously, so the latency is recorded once it reports that it's done
+    this->displayPreRendered = this->Prefetcher->IsPreRendered(e, this->Browser);
+    this->displayPending = true;
     this->Browser->DisplayDiff(e);
     this->Render(KeepHistory, KeepUser);
     e->DecRef();
@@ -672,7 +726,7 @@ void MainWindow::UpdateStatusBarData()
     params << Generic::ShrinkText(QString::number(QueryPool::HugglePool->ProcessingEdits.count()), 3)
            << Generic::ShrinkText(QString::number(QueryPool::HugglePool->RunningQueriesGetCount()), 3)
            << QString::number(this->GetCurrentWikiSite()->GetProjectConfig()->WhiteList.size())
-           << Generic::ShrinkText(QString::number(this->Queue1->Items.count()), 4);
+           << Generic::ShrinkText(QString::number(this->Queue1->Count()), 4);
     QString statistics_;
     // calculate stats, but not if huggle uptime is lower than 50 seconds
     qint64 Uptime = this->GetCurrentWikiSite()->Provider->GetUptime();
@@ -1381,6 +1435,7 @@ void MainWindow::createBrowserTab(const QString& name, int index)
 {
     QWidget *tab = new QWidget(this);
     HuggleWeb *web = new HuggleWeb();
+    connect(web, SIGNAL(DiffRendered(qint64)), this, SLOT(OnDiffRendered(qint64)));
     this->Browsers.append(web);
     QVBoxLayout *lay = new QVBoxLayout(tab);
     lay->setSizeConstraint(QLayout::SetNoConstraint);
@@ -1501,7 +1556,7 @@ void MainWindow::OnMainTimerTick()
     }
     Warnings::ResendWarnings();
     // check if queue isn't full
-    if (this->Queue1->Items.count() > Configuration::HuggleConfiguration->SystemConfig_QueueSize)
+    if (this->Queue1->Count() > Configuration::HuggleConfiguration->SystemConfig_QueueSize)
     {
         if (this->ui->actionStop_feed->isChecked())
         {
@@ -1530,21 +1585,34 @@ void MainWindow::OnMainTimerTick()
                 if (!wiki->Provider->ContainsEdit())
                     continue;
 
-                // we take the edit and start post processing it
+                // we take the edit and let aggregator hold it for a while, in case that same user saves the page again
                 WikiEdit *edit = wiki->Provider->RetrieveEdit();
                 if (edit != nullptr)
-                {
-                    QueryPool::HugglePool->PostProcessEdit(edit);
-                    edit->RegisterConsumer(HUGGLECONSUMER_MAINPEND);
-                    edit->DecRef();
-                    this->PendingEdits.append(edit);
-                }
+                    this->Aggregator->Insert(edit);
 
                 if (!full && wiki->Provider->ContainsEdit())
                     full = true;
             }
         }
     }
+    WikiEdit *held_edit;
+    // while the queue is paused or full the held edits stay in aggregator, where newer revisions can still be merged into them
+    while (RetrieveEdit && (held_edit = this->Aggregator->RetrieveEdit()) != nullptr)
+    {
+        // filter may have changed while the edit was waiting in buffer, and providers from
+        // extensions don't need to filter edits at all, so we check it again before we run
+        // any queries for it
+        if (!held_edit->GetSite()->CurrentFilter->MatchesBeforePostProcessing(held_edit))
+        {
+            held_edit->DecRef();
+            continue;
+        }
+        // we start post processing it
+        QueryPool::HugglePool->PostProcessEdit(held_edit);
+        held_edit->RegisterConsumer(HUGGLECONSUMER_MAINPEND);
+        held_edit->DecRef();
+        this->PendingEdits.append(held_edit);
+    }
     if (this->PendingEdits.count() > 0)
     {
         // postprocessed edits can be added to queue
@@ -1557,7 +1625,7 @@ void MainWindow::OnMainTimerTick()
                 Hooks::WikiEdit_ScoreJS(edit);
                 // We need to check the edit against filter once more, because some of the checks work
                 // only on post processed edits
-                if (edit->GetSite()->CurrentFilter->Matches(edit))
+                if (edit->GetSite()->CurrentFilter->MatchesAfterPostProcessing(edit))
                     this->Queue1->AddItem(edit);
                 this->PendingEdits.removeAt(c);
                 edit->UnregisterConsumer(HUGGLECONSUMER_MAINPEND);
@@ -1610,9 +1678,68 @@ void MainWindow::OnMainTimerTick()
     }
     this->finishRestore();
     this->TruncateReverts();
+    if (this->lastTextTrim.secsTo(QDateTime::currentDateTime()) > 60)
+    {
+        WikiEdit::DropOldText(hcfg->SystemConfig_ReviewedEditsTextAge);
+        MemoryBudget::HuggleMemoryBudget->Check();
+        WikiUser::TrimProblematicUsersList();
+        foreach (WikiSite *site, hcfg->Projects)
+            site->Strings->Trim();
+        this->syncWhitelist();
+        this->lastTextTrim = QDateTime::currentDateTime();
+    }
+    this->snapshotQueue();
+    if (hcfg->SystemConfig_PrefetchCount > 0 && this->Shutdown == ShutdownOpRunning)
+        this->Prefetcher->Update(this->Queue1, this->Browser);
+    else if (this->Prefetcher->Count() > 0)
+        this->Prefetcher->Clear();
+    if (this->firstReviewableEditLatency < 0 && this->Queue1->Count() > 0)
+    {
+        this->firstReviewableEditLatency = Core::HuggleCore->StartupTime.msecsTo(QDateTime::currentDateTime());
+        Syslog::HuggleLogs->Log("First edit was ready for review " + QString::number(this->firstReviewableEditLatency) +
+                                " ms after startup, " + QString::number(this->restoredEdits) + " edits were restored from snapshot");
+    }
     this->SystemLog->Render();
 }
 
+void MainWindow::snapshotQueue()
+{
+    if (hcfg->SystemConfig_QueueSnapshotInterval <= 0 || this->Shutdown != ShutdownOpRunning)
+        return;
+    if (this->lastQueueSnapshot.secsTo(QDateTime::currentDateTime()) < hcfg->SystemConfig_QueueSnapshotInterval * 60)
+        return;
+    this->lastQueueSnapshot = QDateTime::currentDateTime();
+    this->Queue1->SaveSnapshot(Configuration::GetQueueSnapshotPath());
+}
+
+void MainWindow::syncWhitelist()
+{
+    // remove the queries that already finished, users they wrote were moved to whitelist by query itself
+    foreach (WikiSite *site, this->WhitelistQueries.keys())
+    {
+        if (this->WhitelistQueries[site]->IsProcessed())
+        {
+            this->WhitelistQueries[site]->DecRef();
+            this->WhitelistQueries.remove(site);
+        }
+    }
+    if (hcfg->SystemConfig_WhitelistDisabled || hcfg->SystemConfig_WhitelistSyncInterval <= 0 || this->Shutdown != ShutdownOpRunning)
+        return;
+    if (this->lastWhitelistSync.secsTo(QDateTime::currentDateTime()) < hcfg->SystemConfig_WhitelistSyncInterval * 60)
+        return;
+    this->lastWhitelistSync = QDateTime::currentDateTime();
+    foreach (WikiSite *site, hcfg->Projects)
+    {
+        if (this->WhitelistQueries.contains(site) || site->GetProjectConfig()->NewWhitelist.isEmpty())
+            continue;
+        WLQuery *query = new WLQuery(site);
+        query->WL_Type = WLQueryType_WriteWL;
+        query->IncRef();
+        this->WhitelistQueries.insert(site, query);
+        query->Process();
+    }
+}
+
 void MainWindow::TruncateReverts()
 {
     HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
@@ -1639,6 +1766,15 @@ void MainWindow::TruncateReverts()
     }
 }
 
+void MainWindow::OnDiffRendered(qint64 msecs)
+{
+    // other tabs and pages that are not diffs of current edit are not measured
+    if (this->sender() != this->Browser || !this->displayPending)
+        return;
+    this->displayPending = false;
+    this->Prefetcher->RecordDisplayLatency(msecs, this->displayPreRendered);
+}
+
 void MainWindow::OnTimerTick0()
 {
     if (this->Shutdown != ShutdownOpUpdatingConf)
@@ -1654,6 +1790,16 @@ void MainWindow::OnTimerTick0()
                 this->Shutdown = ShutdownOpGracetimeQueries;
                 return;
             }
+            // periodic sync may still be writing, we need to wait for it, otherwise its users would be sent twice
+            // and the query could be released while it's still running
+            foreach (WLQuery *query, this->WhitelistQueries)
+            {
+                if (!query->IsProcessed())
+                {
+                    this->fWaiting->Status(20, _l("updating-wl"));
+                    return;
+                }
+            }
             this->Shutdown = ShutdownOpUpdatingWhitelist;
             this->fWaiting->Status(20, _l("updating-wl"));
             foreach (WikiSite*site, Configuration::HuggleConfiguration->Projects)
@@ -1695,7 +1841,15 @@ void MainWindow::OnTimerTick0()
                 this->fWaiting->Status(20);
                 return;
             }
-            // we finished writing the wl
+            // we finished writing the wl, keep a local copy of it for next start
+            if (hcfg->SystemConfig_WhitelistSnapshotAge > 0)
+            {
+                foreach (WikiSite *site, Configuration::HuggleConfiguration->Projects)
+                {
+                    if (site->GetProjectConfig()->WhitelistTime.isValid())
+                        site->GetProjectConfig()->SaveWhitelistSnapshot(Configuration::GetWhitelistSnapshotPath(site));
+                }
+            }
             this->fWaiting->Status(60, _l("gracetime"));
             this->Shutdown = ShutdownOpGracetimeQueries;
             // now we need to give a gracetime to queries
@@ -1961,6 +2115,13 @@ void MainWindow::Exit()
         layout->close();
         delete layout;
     }
+    if (hcfg->SystemConfig_QueueSnapshotInterval > 0)
+    {
+        // periodic snapshot may still be running, the final one must not be skipped because of it
+        this->Queue1->WaitForSnapshot();
+        this->Queue1->SaveSnapshot(Configuration::GetQueueSnapshotPath());
+        this->Queue1->WaitForSnapshot();
+    }
     if (Configuration::HuggleConfiguration->DeveloperMode)
     {
         this->ShutdownForm();
@@ -2282,7 +2443,7 @@ void MainWindow::DisplayRevid(revid_ht revid, WikiSite *site)
 {
     // kill currently displayed edit
     this->LockPage();
-    Collectable_SmartPtr<WikiEdit> edit = WikiEdit::FromCacheByRevID(revid);
+    Collectable_SmartPtr<WikiEdit> edit = WikiEdit::FromCacheByRevID(revid, "prev", site);
     if (edit != nullptr)
     {
         this->ProcessEdit(edit);
@@ -2296,6 +2457,31 @@ void MainWindow::DisplayRevid(revid_ht revid, WikiSite *site)
     //this->Browser->RenderHtml(html);
 }
 
+qint64 MainWindow::GetHistoryMemoryUsage()
+{
+    qint64 size = 0;
+    foreach (WikiEdit *edit, this->Historical)
+        size += edit->GetMemoryEstimate();
+    return size;
+}
+
+qint64 MainWindow::TrimHistory(qint64 bytes)
+{
+    qint64 released = 0;
+    while (released < bytes && this->Historical.count())
+    {
+        WikiEdit *prev = this->Historical.at(0);
+        if (this->CurrentEdit == prev)
+            break;
+        // text isn't touched here, it's freed only once GC deletes the edit
+        released += prev->GetMemoryEstimate();
+        this->Historical.removeAt(0);
+        prev->RemoveFromHistoryChain();
+        prev->UnregisterConsumer(HUGGLECONSUMER_MAINFORM_HISTORICAL);
+    }
+    return released;
+}
+
 void MainWindow::PauseQueue()
 {
     if (this->QueueIsNowPaused)
@@ -2323,7 +2509,7 @@ void MainWindow::FlagGood()
     Hooks::OnGood(this->CurrentEdit);
     this->PatrolEdit();
     this->CurrentEdit->User->SetBadnessScore(this->CurrentEdit->User->GetBadnessScore() - 200);
-    if (Configuration::HuggleConfiguration->UserConfig->WelcomeGood && this->CurrentEdit->User->TalkPage_GetContents().isEmpty())
+    if (Configuration::HuggleConfiguration->UserConfig->WelcomeGood && !this->CurrentEdit->User->TalkPage_Exists())
         this->triggerWelcome();
     this->DisplayNext();
 }
@@ -2439,7 +2625,7 @@ void MainWindow::welcomeCurrentUser(QString message)
     ProjectConfiguration *conf = this->GetCurrentWikiSite()->GetProjectConfig();
     this->CurrentEdit->User->Resync();
     bool create_only = true;
-    if (!this->CurrentEdit->User->TalkPage_GetContents().isEmpty())
+    if (this->CurrentEdit->User->TalkPage_Exists())
     {
         if (UiGeneric::pMessageBox(this, "Welcome :o", _l("welcome-tp-empty-fail"), MessageBoxStyleQuestion) == QMessageBox::No)
             return;
@@ -2961,6 +3147,79 @@ void MainWindow::on_actionEdit_info_triggered()
 {
     // don't localize this please
     Syslog::HuggleLogs->Log("Current number of edits in memory: " + QString::number(WikiEdit::EditList.count()));
+    WikiEdit_MemoryUsage usage = WikiEdit::GetMemoryUsage();
+    Syslog::HuggleLogs->Log("Edit text in memory: active " + QString::number(usage.ActiveEdits) + " edits (" +
+                            QString::number(usage.ActiveBytes) + " bytes), compressed " + QString::number(usage.CompressedEdits) +
+                            " edits (" + QString::number(usage.CompressedBytes) + " bytes), dropped " +
+                            QString::number(usage.DroppedEdits) + " edits");
+    foreach (MemoryBudget_Subsystem subsystem, MemoryBudget::HuggleMemoryBudget->GetSubsystems())
+    {
+        Syslog::HuggleLogs->Log("Memory of " + subsystem.Name + ": " + QString::number(subsystem.Size) + " bytes, evicted " +
+                                QString::number(subsystem.Evicted) + " bytes");
+    }
+    Syslog::HuggleLogs->Log("Memory budget: " + QString::number(MemoryBudget::HuggleMemoryBudget->GetTotalSize()) + " / " +
+                            QString::number(MemoryBudget::HuggleMemoryBudget->GetBudget()) + " bytes");
+    WikiUser::ProblematicUserListLock.lock();
+    qint64 lookups = WikiUser::ProblematicUsersLookups;
+    qint64 lookup_avg = 0;
+    if (lookups > 0)
+        lookup_avg = WikiUser::ProblematicUsersLookupTime / lookups;
+    Syslog::HuggleLogs->Log("Problematic users: " + QString::number(WikiUser::ProblematicUsers.count()) + " users, " +
+                            QString::number(lookups) + " lookups, " + QString::number(lookup_avg) + " ns per lookup, evicted " +
+                            QString::number(WikiUser::ProblematicUsersEvicted) + " users");
+    WikiUser::ProblematicUserListLock.unlock();
+    WikiUser::SharedUsersLock.lock();
+    Syslog::HuggleLogs->Log("Shared users referenced by edits: " + QString::number(WikiUser::SharedUsers.count()));
+    WikiUser::SharedUsersLock.unlock();
+    Syslog::HuggleLogs->Log("Talk page level cache: " + QString::number(HuggleParser::GetLevelCacheHits()) + " hits, " +
+                            QString::number(HuggleParser::GetLevelCacheMisses()) + " misses");
+    Syslog::HuggleLogs->Log("Network: " + QString::number(Query::GetBytesReceivedSinceStartup()) + " bytes received, " +
+                            QString::number(Query::GetBytesSentSinceStartup()) + " bytes sent");
+    Syslog::HuggleLogs->Log("Talk pages: " + QString::number(WikiEdit::TalkPageDownloads) + " downloads, " +
+                            QString::number(WikiEdit::TalkPageRevisionChecks) + " revision checks, " +
+                            QString::number(WikiEdit::TalkPageDownloadsAvoided) + " downloads avoided, " +
+                            QString::number(WikiEdit::TalkPageBytes) + " bytes received");
+    if (ReputationStore::HuggleReputation && ReputationStore::HuggleReputation->IsOpen())
+    {
+        Syslog::HuggleLogs->Log("Reputation store: " + QString::number(ReputationStore::HuggleReputation->Count()) + " / " +
+                                QString::number(ReputationStore::HuggleReputation->GetCapacity()) + " users, " +
+                                QString::number(ReputationStore::HuggleReputation->GetHits()) + " hits, " +
+                                QString::number(ReputationStore::HuggleReputation->GetMisses()) + " misses");
+    }
+    foreach (WikiSite *site, hcfg->Projects)
+    {
+        Syslog::HuggleLogs->Log("String pool of " + site->Name + ": " + QString::number(site->Strings->Count()) + " strings, " +
+                                QString::number(site->Strings->GetSize()) + " bytes, " + QString::number(site->Strings->GetHits()) +
+                                " hits, " + QString::number(site->Strings->GetBytesSaved()) + " bytes saved");
+        Syslog::HuggleLogs->Log("IP ranges of " + site->Name + ": " + QString::number(site->IPRanges->GetAddressCount()) + " addresses, " +
+                                QString::number(site->IPRanges->GetNodeCount()) + " nodes");
+    }
+    qint64 uptime = Core::HuggleCore->GetUptimeInSeconds();
+    double avoided_per_hour = 0;
+    if (uptime > 0)
+        avoided_per_hour = static_cast<double>(HuggleQueueFilter::RequestsAvoided.load()) * 3600 / uptime;
+    Syslog::HuggleLogs->Log("Queue filter: " + QString::number(HuggleQueueFilter::EarlyRejections.load()) + " edits rejected before post processing, " +
+                            QString::number(HuggleQueueFilter::LateRejections.load()) + " after post processing, " +
+                            QString::number(HuggleQueueFilter::RequestsAvoided.load()) + " API requests avoided (" +
+                            QString::number(avoided_per_hour, 'f', 1) + " per hour)");
+    Syslog::HuggleLogs->Log("Edit aggregation: " + QString::number(EditAggregator::MergedEdits) + " edits merged, " +
+                            QString::number(EditAggregator::RequestsAvoided) + " API requests avoided, " +
+                            QString::number(this->Aggregator->Count()) + " edits held");
+    Syslog::HuggleLogs->Log("Queue snapshot: " + QString::number(this->restoredEdits) + " edits restored, " +
+                            QString::number(this->Queue1->GetSnapshotPendingCount()) + " waiting for revalidation, first edit ready " +
+                            QString::number(this->firstReviewableEditLatency) + " ms after startup");
+    Syslog::HuggleLogs->Log("Prefetch: " + QString::number(this->Prefetcher->Count()) + " edits prepared, " + this->Prefetcher->GetStatistics());
+    Syslog::HuggleLogs->Log("Diff rendering: " + GenericBrowser::GetRenderStatistics());
+    if (hcfg->SystemConfig_FilterProfiling)
+    {
+        foreach (QString line, HuggleQueueFilter::GetStatistics())
+            Syslog::HuggleLogs->Log("Queue filter " + line);
+        QString path = Configuration::GetConfigurationPath() + "filter_statistics.tsv";
+        if (HuggleQueueFilter::DumpStatistics(path))
+            Syslog::HuggleLogs->Log("Queue filter statistics were written to " + path);
+        else
+            Syslog::HuggleLogs->ErrorLog("Unable to write queue filter statistics to " + path);
+    }
 }
 
 void MainWindow::on_actionFlag_as_suspicious_edit_triggered()
@@ -3513,9 +3772,10 @@ void MainWindow::on_actionContribution_browser_triggered()
 void MainWindow::on_actionCheck_for_dups_triggered()
 {
     QHash<QString, int> occurences;
-    foreach (HuggleQueueItemLabel *e, this->Queue1->Items)
+    int x = 0;
+    while (x < this->Queue1->Count())
     {
-        QString page = e->Edit->Page->PageName.toLower();
+        QString page = this->Queue1->At(x)->Page->PageName.toLower();
         if (!occurences.contains(page))
         {
             occurences.insert(page, 1);
@@ -3523,6 +3783,7 @@ void MainWindow::on_actionCheck_for_dups_triggered()
         {
             occurences[page]++;
         }
+        x++;
     }
     bool found = false;
     foreach (QString page, occurences.keys())
@@ -52,6 +52,8 @@ namespace Huggle
     class AboutForm;
     class BlockUserForm;
     class DeleteForm;
+    class EditAggregator;
+    class EditPrefetcher;
     class EditBar;
     class HuggleLog;
     class History;
@@ -179,6 +181,10 @@ namespace Huggle
              * \param site Mediawiki site
              */
             void DisplayRevid(revid_ht revid, WikiSite *site);
+            //! Approximate number of bytes held by edits in history
+            qint64 GetHistoryMemoryUsage();
+            //! Remove oldest edits from history until at least given number of bytes is released
+            qint64 TrimHistory(qint64 bytes);
             void PauseQueue();
             //! Recreate interface, should be called everytime you do anything with main form
             void Render(bool KeepHistory = false, bool KeepUser = false);
@@ -211,6 +217,10 @@ namespace Huggle
             void RemoveStatusBarItem(QWidget *widget);
             //! List of edits that are being saved
             QList<WikiEdit*> PendingEdits;
+            //! Edits retrieved from providers wait here before post processing, so that runs of edits can be merged
+            EditAggregator *Aggregator;
+            //! Prepares history, contributions and diff of edits on top of queue before they are displayed
+            EditPrefetcher *Prefetcher;
             //! Pointer to syslog
             HuggleLog *SystemLog;
             bool QueueIsNowPaused = false;
@@ -279,6 +289,7 @@ namespace Huggle
             void on_actionAbout_triggered();
             void OnMainTimerTick();
             void OnTimerTick0();
+            void OnDiffRendered(qint64 msecs);
             void on_actionNext_triggered();
             void on_actionNext_2_triggered();
             void on_actionWarn_triggered();
@@ -426,6 +437,10 @@ namespace Huggle
             void RevertAgf(bool only);
             //! This function is called by main thread and is used to remove edits that were already reverted
             void TruncateReverts();
+            //! Send users that were whitelisted since last sync to whitelist server, so that there is less to do on exit
+            void syncWhitelist();
+            //! Write the queue to snapshot if it's time for that
+            void snapshotQueue();
             void closeEvent(QCloseEvent *event) override;
             void ReloadSc();
             void ReloadShort(const QString& id);
@@ -448,6 +463,20 @@ namespace Huggle
             QToolButton *rwToolButtonMenu = nullptr;
             QToolButton *welcomeToolButtonMenu = nullptr;
             QDateTime editLoadDateTime;
+            //! Diff of current edit was requested and browser didn't report that it was rendered yet
+            bool displayPending = false;
+            //! Whether diff of current edit was rendered offscreen by prefetcher
+            bool displayPreRendered = false;
+            //! Last time when text of old reviewed edits was dropped and memory budget checked
+            QDateTime lastTextTrim = QDateTime::currentDateTime();
+            //! Last time when new users were sent to whitelist server
+            QDateTime lastWhitelistSync = QDateTime::currentDateTime();
+            //! Last time when queue was written to snapshot
+            QDateTime lastQueueSnapshot = QDateTime::currentDateTime();
+            //! Number of ms from startup until first edit could be reviewed, -1 if there wasn't any yet
+            qint64 firstReviewableEditLatency = -1;
+            //! Number of edits that were restored from queue snapshot on startup
+            int restoredEdits = 0;
             QString RestoreEdit_RevertReason;
             ReloginForm *fRelogin = nullptr;
             QTimer *wlt = nullptr;
@@ -55,6 +55,7 @@ Preferences::Preferences(QWidget *parent) : HW("preferences", this, parent), ui(
     SetDefaults(this->ui->cbqWl);
     SetDefaults(this->ui->cbqWatched);
     SetDefaults(this->ui->cbqIP);
+    SetDefaults(this->ui->cbqBadRange);
     this->ui->cbProviders->addItem("Wiki");
     this->ui->cbProviders->addItem("IRC");
     this->ui->cbProviders->addItem("XmlRcs");
@@ -169,6 +170,7 @@ Preferences::Preferences(QWidget *parent) : HW("preferences", this, parent), ui(
     this->ui->checkBox_notifyBeta->setText(_l("config-beta"));
     this->ui->checkBox_31->setText(_l("config-html-messages"));
     this->ui->label_Unregistered->setText(_l("config-ip"));
+    this->ui->label_badRange->setText(_l("config-bad-range"));
     this->ui->checkBox_7->setText(_l("config-summary-present"));
     this->ui->pushButton_OK->setText(_l("ok"));
     this->ui->cbPlayOnNewItem->setText(_l("preferences-sounds-enable-queue"));
@@ -261,6 +263,7 @@ void Huggle::Preferences::on_listWidget_itemSelectionChanged()
     SetValue(f->getIgnoreSelf(), this->ui->cbqOwn);
     SetValue(f->getIgnoreWatched(), this->ui->cbqWatched);
     SetValue(f->getIgnoreIP(), this->ui->cbqIP);
+    SetValue(f->getIgnoreBadRange(), this->ui->cbqBadRange);
     SetValue(f->getIgnoreMinor(), this->ui->cbqMinor);
     this->ui->leIgnoredTags->setText(f->GetIgnoredTags_CommaSeparated());
     this->ui->leRequiredTags->setText(f->GetRequiredTags_CommaSeparated());
@@ -282,6 +285,7 @@ void Preferences::EnableQueues(bool enabled)
     this->ui->cbqNew->setEnabled(enabled);
     this->ui->cbqOwn->setEnabled(enabled);
     this->ui->cbqIP->setEnabled(enabled);
+    this->ui->cbqBadRange->setEnabled(enabled);
     this->ui->cbqWatched->setEnabled(enabled);
     this->ui->cbqRevert->setEnabled(enabled);
     this->ui->pushButton_QueueSave->setEnabled(enabled);
@@ -588,6 +592,7 @@ void Preferences::ResetItems()
     this->ui->checkBox_27->setChecked(hcfg->SystemConfig_InstantReverts);
     this->ui->checkBox_22->setChecked(hcfg->SystemConfig_DynamicColsInList);
     this->ui->checkBox_23->setChecked(hcfg->UserConfig->DisplayTitle);
+    this->ui->checkBox_NativeDiff->setChecked(hcfg->UserConfig->NativeDiffView);
     this->ui->checkBox_WelcomeEmptyPage->setChecked(hcfg->UserConfig->WelcomeGood);
     this->ui->checkBox_AutoReport->setChecked(hcfg->UserConfig->AutomaticReports);
     this->ui->checkBox_31->setChecked(hcfg->UserConfig->HtmlAllowedInIrc);
@@ -710,6 +715,12 @@ void Huggle::Preferences::on_cbqWatched_currentIndexChanged(int index)
     this->queueModified = true;
 }
 
+void Huggle::Preferences::on_cbqBadRange_currentIndexChanged(int index)
+{
+    (void)index;
+    this->queueModified = true;
+}
+
 void Huggle::Preferences::on_leIgnoredTags_textEdited(const QString &arg1)
 {
     (void)arg1;
@@ -761,6 +772,7 @@ void Huggle::Preferences::on_pushButton_OK_clicked()
     hcfg->UserConfig->TruncateEdits = this->ui->checkBox_RemoveOldEdits->isChecked();
     hcfg->SystemConfig_DynamicColsInList = this->ui->checkBox_22->isChecked();
     hcfg->UserConfig->DisplayTitle = this->ui->checkBox_23->isChecked();
+    hcfg->UserConfig->NativeDiffView = this->ui->checkBox_NativeDiff->isChecked();
     hcfg->UserConfig->PreferredProvider = this->ui->cbProviders->currentIndex();
     hcfg->UserConfig->ManualWarning = !this->ui->checkBox_AutoWarning->isChecked();
     hcfg->UserConfig->RetrieveFounder = this->ui->checkBox_8->isChecked();
@@ -884,6 +896,7 @@ void Huggle::Preferences::on_pushButton_QueueSave_clicked()
     filter->setIgnoreFriends(Match(this->ui->cbqFrd));
     filter->setIgnore_UserSpace(Match(this->ui->cbqUserspace));
     filter->setIgnoreWatched(Match(this->ui->cbqWatched));
+    filter->setIgnoreBadRange(Match(this->ui->cbqBadRange));
     int ns = 0;
     while (ns < this->ui->tableWidget_3->rowCount())
     {
@@ -61,6 +61,7 @@ namespace Huggle
             void on_cbqUserspace_currentIndexChanged(int index);
             void on_cbqTp_currentIndexChanged(int index);
             void on_cbqWatched_currentIndexChanged(int index);
+            void on_cbqBadRange_currentIndexChanged(int index);
             void on_leIgnoredTags_textEdited(const QString &arg1);
             void on_leIgnoredCategories_textEdited(const QString &arg1);
             void on_leRequiredTags_textEdited(const QString &arg1);
@@ -10,6 +10,7 @@
 
 #include "userinfoform.hpp"
 #include "editbar.hpp"
+#include "editprefetcher.hpp"
 #include "mainwindow.hpp"
 #include "ui_userinfoform.h"
 #include "uihooks.hpp"
@@ -102,16 +103,26 @@ void UserinfoForm::Read()
 {
     if (!UiHooks::ContribBoxBeforeQuery(this->User, this))
         return;
-    this->qContributions = new ApiQuery(ActionQuery, this->User->GetSite());
-    this->qContributions->Target = "Retrieving contributions of " + this->User->Username;
-    this->qContributions->Parameters = "list=usercontribs&ucuser=" + QUrl::toPercentEncoding(this->User->Username) +
-                                       "&ucprop=flags%7Ccomment%7Ctimestamp%7Ctitle%7Cids%7Csize&uclimit=20";
-    QueryPool::HugglePool->AppendQuery(this->qContributions);
     ui->pushButton->hide();
-    this->qContributions->Process();
+    this->qContributions = MainWindow::HuggleMain->Prefetcher->TakeContributions(this->User);
+    if (this->qContributions == nullptr)
+    {
+        this->qContributions = CreateQuery(this->User);
+        QueryPool::HugglePool->AppendQuery(this->qContributions);
+        this->qContributions->Process();
+    }
     this->timer->start(HUGGLE_TIMER);
 }
 
+ApiQuery *UserinfoForm::CreateQuery(WikiUser *user)
+{
+    ApiQuery *query = new ApiQuery(ActionQuery, user->GetSite());
+    query->Target = "Retrieving contributions of " + user->Username;
+    query->Parameters = "list=usercontribs&ucuser=" + QUrl::toPercentEncoding(user->Username) +
+                        "&ucprop=flags%7Ccomment%7Ctimestamp%7Ctitle%7Cids%7Csize&uclimit=20";
+    return query;
+}
+
 void UserinfoForm::on_pushButton_clicked()
 {
     this->Read();
@@ -253,7 +264,7 @@ void UserinfoForm::JumpToSpecificContrib(long revid, QString page)
     this->edit = new WikiEdit();
     this->edit->User = new WikiUser(this->User);
     this->edit->Page = new WikiPage(page, this->User->GetSite());
-    this->edit->RevID = revid;
+    this->edit->SetRevID(revid);
     QueryPool::HugglePool->PreProcessEdit(this->edit);
     QueryPool::HugglePool->PostProcessEdit(this->edit);
     MainWindow::HuggleMain->Browser->RenderHtml(_l("wait"));
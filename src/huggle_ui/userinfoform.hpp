@@ -60,6 +60,8 @@ namespace Huggle
             explicit UserinfoForm(QWidget *parent = nullptr);
             ~UserinfoForm();
             void ChangeUser(WikiUser *user);
+            //! Create a query that retrieves contributions of user, it's not processed yet
+            static ApiQuery *CreateQuery(WikiUser *user);
             void Read();
             void JumpToSpecificContrib(long revid, QString page);
             QList<revid_ht> GetTopRevisions();
@@ -294,6 +294,52 @@ bool VandalNw::IsParsed(WikiEdit *edit)
     return false;
 }
 
+static qint64 GetHANItemSize(const HAN::GenericItem &item)
+{
+    return sizeof(HAN::RescoreItem) + (item.User.size() + item.Ident.size() + item.Host.size()) * sizeof(QChar);
+}
+
+qint64 VandalNw::GetCacheMemoryUsage()
+{
+    qint64 size = 0;
+    foreach (HAN::RescoreItem item, this->UnparsedScores)
+        size += GetHANItemSize(item);
+    foreach (HAN::GenericItem item, this->UnparsedGood)
+        size += GetHANItemSize(item);
+    foreach (HAN::GenericItem item, this->UnparsedRoll)
+        size += GetHANItemSize(item);
+    foreach (HAN::GenericItem item, this->UnparsedSusp)
+        size += GetHANItemSize(item);
+    return size;
+}
+
+qint64 VandalNw::TrimCache(qint64 bytes)
+{
+    qint64 released = 0;
+    // good edits and scores are least important, rollbacks are kept as long as possible
+    while (released < bytes && !this->UnparsedGood.isEmpty())
+    {
+        released += GetHANItemSize(this->UnparsedGood.at(0));
+        this->UnparsedGood.removeAt(0);
+    }
+    while (released < bytes && !this->UnparsedScores.isEmpty())
+    {
+        released += GetHANItemSize(this->UnparsedScores.at(0));
+        this->UnparsedScores.removeAt(0);
+    }
+    while (released < bytes && !this->UnparsedSusp.isEmpty())
+    {
+        released += GetHANItemSize(this->UnparsedSusp.at(0));
+        this->UnparsedSusp.removeAt(0);
+    }
+    while (released < bytes && !this->UnparsedRoll.isEmpty())
+    {
+        released += GetHANItemSize(this->UnparsedRoll.at(0));
+        this->UnparsedRoll.removeAt(0);
+    }
+    return released;
+}
+
 bool VandalNw::IsBot(QString nick, QString host)
 {
     if (nick.endsWith("Bot"))
@@ -130,6 +130,10 @@ namespace Huggle
             //! For debugging only
             void WriteTest(WikiEdit *edit);
             bool IsBot(QString nick, QString host);
+            //! Approximate number of bytes held by HAN items that were not parsed yet
+            qint64 GetCacheMemoryUsage();
+            //! Remove oldest unparsed HAN items until at least given number of bytes is released
+            qint64 TrimCache(qint64 bytes);
             QHash<QString,WikiSite*> Ch2Site;
             QHash<WikiSite*,QString> Site2Channel;
             //! Prefix to special commands that are being sent to network to other users
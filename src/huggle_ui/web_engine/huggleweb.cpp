@@ -19,7 +19,11 @@ HuggleWeb::HuggleWeb(QWidget *parent) : GenericBrowser(parent), ui(new Ui::Huggl
     this->ui->setupUi(this);
     this->ui->label->setVisible(false);
     this->ui->lineEdit->setVisible(false);
-    this->ui->webView->setPage(new HuggleWebEnginePage());
+    // the view doesn't own its page, so browser does, otherwise the page is never deleted once it's swapped
+    HuggleWebEnginePage *page = new HuggleWebEnginePage();
+    page->setParent(this);
+    this->ui->webView->setPage(page);
+    connect(this->ui->webView, SIGNAL(loadFinished(bool)), this, SLOT(OnLoadFinished(bool)));
 }
 
 HuggleWeb::~HuggleWeb()
@@ -29,11 +33,17 @@ HuggleWeb::~HuggleWeb()
 
 void HuggleWeb::Find(QString text)
 {
+    if (this->IsNativeDiffDisplayed())
+    {
+        GenericBrowser::Find(text);
+        return;
+    }
     this->ui->webView->findText(text);
 }
 
 void HuggleWeb::DisplayPage(const QString &url)
 {
+    this->HideNativeDiff();
     this->ui->webView->history()->clear();
     this->source.clear();
     this->ui->webView->load(url);
@@ -41,13 +51,48 @@ void HuggleWeb::DisplayPage(const QString &url)
 
 void HuggleWeb::RenderHtml(const QString &html)
 {
-    this->ui->webView->history()->clear();
+    this->HideNativeDiff();
     this->source = html;
+    if (this->preparedPage != nullptr && this->preparedSource == html)
+    {
+        // this html was already rendered offscreen, so we just swap the pages
+        bool loaded = this->preparedLoaded;
+        this->replacePage(this->preparedPage);
+        this->preparedPage = nullptr;
+        this->preparedSource.clear();
+        this->preparedLoaded = false;
+        // otherwise the measurement is finished by OnPreparedLoadFinished
+        if (loaded)
+            this->FinishRenderMeasurement();
+        return;
+    }
+    this->ui->webView->history()->clear();
     this->ui->webView->setHtml(html);
 }
 
+bool HuggleWeb::PreRender(const QString &html)
+{
+    if (html.isEmpty())
+        return false;
+    if (html == this->preparedSource)
+        return true;
+    if (this->preparedPage == nullptr)
+    {
+        this->preparedPage = new HuggleWebEnginePage();
+        this->preparedPage->setParent(this);
+        connect(this->preparedPage, SIGNAL(loadFinished(bool)), this, SLOT(OnPreparedLoadFinished(bool)));
+    }
+    this->preparedSource = html;
+    this->preparedLoaded = false;
+    this->preparedPage->setHtml(html);
+    return true;
+}
+
 QString HuggleWeb::RetrieveHtml()
 {
+    // web view keeps only a blank page while native view displays the diff
+    if (this->IsNativeDiffDisplayed() && this->CurrentEdit != nullptr)
+        return this->GetDiffHtml(this->CurrentEdit);
     if (!this->source.isEmpty())
         return this->source;
     return "Retrieving of source code is not supported yet in Chromium library";
@@ -65,5 +110,50 @@ void HuggleWeb::ToggleSearchWidget()
 
 void Huggle::HuggleWeb::on_lineEdit_textChanged(const QString &arg1)
 {
-    this->ui->webView->findText(arg1);
+    this->Find(arg1);
+}
+
+QWidget *HuggleWeb::GetHtmlWidget()
+{
+    return this->ui->webView;
+}
+
+void HuggleWeb::ReleaseHtml()
+{
+    // renderer process of a page lives as long as the page, a page that never loaded anything doesn't have one
+    delete this->preparedPage;
+    this->preparedPage = nullptr;
+    this->preparedSource.clear();
+    this->preparedLoaded = false;
+    this->source.clear();
+    HuggleWebEnginePage *page = new HuggleWebEnginePage();
+    page->setParent(this);
+    this->replacePage(page);
+}
+
+void HuggleWeb::replacePage(QWebEnginePage *page)
+{
+    QWebEnginePage *previous = this->ui->webView->page();
+    this->ui->webView->setPage(page);
+    if (previous != nullptr && previous->parent() == this)
+        previous->deleteLater();
+}
+
+void HuggleWeb::OnLoadFinished(bool ok)
+{
+    Q_UNUSED(ok);
+    this->FinishRenderMeasurement();
+}
+
+void HuggleWeb::OnPreparedLoadFinished(bool ok)
+{
+    if (this->sender() == this->preparedPage)
+    {
+        // page is still offscreen, load that was interrupted by newer html doesn't count
+        this->preparedLoaded = ok;
+        return;
+    }
+    // page was swapped into view before it finished loading
+    if (this->sender() == this->ui->webView->page())
+        this->FinishRenderMeasurement();
 }
@@ -35,15 +35,29 @@ namespace Huggle
             void Find(QString text);
             void DisplayPage(const QString &url);
             void RenderHtml(const QString &html);
+            bool PreRender(const QString &html);
             QString RetrieveHtml();
             void ToggleSearchWidget();
 
+        protected:
+            QWidget *GetHtmlWidget();
+            void ReleaseHtml();
+
         private slots:
             void on_lineEdit_textChanged(const QString &arg1);
+            void OnLoadFinished(bool ok);
+            void OnPreparedLoadFinished(bool ok);
 
         private:
+            //! Replace page of view with new one, the old one is deleted together with its renderer process
+            void replacePage(QWebEnginePage *page);
             Ui::HuggleWeb *ui;
             QString source;
+            //! Offscreen page that already contains the html in preparedSource
+            QWebEnginePage *preparedPage = nullptr;
+            QString preparedSource;
+            //! Prepared page finished loading, if it's swapped into view before that, render is measured until it does
+            bool preparedLoaded = false;
     };
 }
 
@@ -17,6 +17,7 @@ using namespace Huggle;
 HuggleWeb::HuggleWeb(QWidget *parent) : GenericBrowser(parent), ui(new Ui::HuggleWeb)
 {
     this->ui->setupUi(this);
+    connect(this->ui->webView, SIGNAL(loadFinished(bool)), this, SLOT(OnLoadFinished(bool)));
 }
 
 HuggleWeb::~HuggleWeb()
@@ -26,6 +27,7 @@ HuggleWeb::~HuggleWeb()
 
 void HuggleWeb::DisplayPage(const QString &url)
 {
+    this->HideNativeDiff();
     this->ui->webView->load(url);
     this->ui->webView->page()->setLinkDelegationPolicy(QWebPage::DelegateAllLinks);
     connect(this->ui->webView, SIGNAL(linkClicked(QUrl)), this, SLOT(Click(QUrl)));
@@ -33,6 +35,7 @@ void HuggleWeb::DisplayPage(const QString &url)
 
 void HuggleWeb::RenderHtml(const QString &html)
 {
+    this->HideNativeDiff();
     this->ui->webView->setContent(html.toUtf8());
 }
 
@@ -43,5 +46,19 @@ void HuggleWeb::Click(const QUrl &page)
 
 QString HuggleWeb::RetrieveHtml()
 {
+    // web view still holds the previous page while native view displays the diff
+    if (this->IsNativeDiffDisplayed() && this->CurrentEdit != nullptr)
+        return this->GetDiffHtml(this->CurrentEdit);
     return this->ui->webView->page()->mainFrame()->toHtml();
 }
+
+QWidget *HuggleWeb::GetHtmlWidget()
+{
+    return this->ui->webView;
+}
+
+void HuggleWeb::OnLoadFinished(bool ok)
+{
+    Q_UNUSED(ok);
+    this->FinishRenderMeasurement();
+}
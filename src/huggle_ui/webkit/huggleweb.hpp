@@ -45,8 +45,12 @@ namespace Huggle
              */
             QString RetrieveHtml();
 
+        protected:
+            QWidget *GetHtmlWidget();
+
         private slots:
             void Click(const QUrl &page);
+            void OnLoadFinished(bool ok);
 
         private:
             Ui::HuggleWeb *ui;
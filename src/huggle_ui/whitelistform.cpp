@@ -81,7 +81,8 @@ void WhitelistForm::Reload(int pn)
     {
         site = Configuration::HuggleConfiguration->Project;
     }
-    site->GetProjectConfig()->WhiteList.sort();
-    this->Whitelist += site->GetProjectConfig()->WhiteList;
+    QStringList whitelist = site->GetProjectConfig()->WhiteList.toList();
+    whitelist.sort();
+    this->Whitelist += whitelist;
     this->timer->start(HUGGLE_TIMER);
 }
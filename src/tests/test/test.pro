@@ -51,7 +51,10 @@ SOURCES += tst_testmain.cpp \
     ../../reloginform.cpp \
     ../../huggletool.cpp \
     ../../huggleweb.cpp \
-    ../../hugglequeueitemlabel.cpp \
+    ../../hugglequeueitemdelegate.cpp \
+    ../../editqueue.cpp \
+    ../../editqueueindex.cpp \
+    ../../editqueuemodel.cpp \
     ../../hugglequeuefilter.cpp \
     ../../hugglequeue.cpp \
     ../../warnings.cpp \
@@ -122,7 +125,10 @@ HEADERS += \
     ../../huggletool.hpp \
     ../../wikiutil.hpp \
     ../../querypool.hpp \
-    ../../hugglequeueitemlabel.hpp \
+    ../../hugglequeueitemdelegate.hpp \
+    ../../editqueue.hpp \
+    ../../editqueueindex.hpp \
+    ../../editqueuemodel.hpp \
     ../../hugglequeuefilter.hpp \
     ../../hugglequeue.hpp \
     ../../hugglelog.hpp \
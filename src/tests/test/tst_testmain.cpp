@@ -12,17 +12,44 @@
 #include <iostream>
 #include <QtTest>
 #include <huggle_core/huggleparser.hpp>
+#include <huggle_core/huggleprofiler.hpp>
 #include <huggle_core/configuration.hpp>
+#include <huggle_core/diffdocument.hpp>
+#include <huggle_core/editaggregator.hpp>
+#include <huggle_core/editqueue.hpp>
+#include <huggle_core/editqueueindex.hpp>
+#include <huggle_core/editqueuemodel.hpp>
 #include <huggle_core/generic.hpp>
+#include <huggle_core/hugglequeuefilter.hpp>
+#include <huggle_core/ipaddress.hpp>
+#include <huggle_core/iprangetrie.hpp>
+#include <huggle_core/multipatternmatcher.hpp>
+#include <huggle_core/reputationstore.hpp>
 #include <huggle_core/wikiedit.hpp>
 #include <huggle_core/wikipage.hpp>
 #include <huggle_core/wikisite.hpp>
 #include <huggle_core/sleeper.hpp>
+#include <huggle_core/syslog.hpp>
+#include <huggle_core/stringpool.hpp>
 #include <huggle_core/terminalparser.hpp>
 #include <huggle_core/wikiuser.hpp>
+#include <huggle_core/wlquery.hpp>
 #include <huggle_core/version.hpp>
 
 static void testTalkPageWarningParser(QString id, QDate date, int level);
+//! Big talk page of established vandal built from all test pages
+static QString benchmarkTalkPage();
+//! Regular expressions that were used to recognize IP users before IPAddress existed, used for benchmark
+static QRegExp IPv4Regex(R"(\b((25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)(\.|$)){4}\b)");
+static QRegExp IPv6Regex("(([0-9a-fA-F]{1,4}:){7,7}[0-9a-fA-F]{1,4}|([0-9a-fA-F]{1,4}:){1,7}:|([0-9a-fA-F]"\
+                            "{1,4}:){1,6}:[0-9a-fA-F]{1,4}|([0-9a-fA-F]{1,4}:){1,5}(:[0-9a-fA-F]{1,4}){1,2}|("\
+                            "[0-9a-fA-F]{1,4}:){1,4}(:[0-9a-fA-F]{1,4}){1,3}|([0-9a-fA-F]{1,4}:){1,3}(:[0-9a-"\
+                            "fA-F]{1,4}){1,4}|([0-9a-fA-F]{1,4}:){1,2}(:[0-9a-fA-F]{1,4}){1,5}|[0-9a-fA-F]{1,"\
+                            "4}:((:[0-9a-fA-F]{1,4}){1,6})|:((:[0-9a-fA-F]{1,4}){1,7}|:)|fe80:(:[0-9a-fA-F]{0"\
+                            ",4}){0,4}%[0-9a-zA-Z]{1,}|::(ffff(:0{1,4}){0,1}:){0,1}((25[0-5]|(2[0-4]|1{0,1}[0"\
+                            "-9]){0,1}[0-9]).){3,3}(25[0-5]|(2[0-4]|1{0,1}[0-9]){0,1}[0-9])|([0-9a-fA-F]{1,4}"\
+                            ":){1,4}:((25[0-5]|(2[0-4]|1{0,1}[0-9]){0,1}[0-9]).){3,3}(25[0-5]|(2[0-4]|1{0,1}["\
+                            "0-9]){0,1}[0-9]))");
 //! This is a unit test
 class HuggleTest : public QObject
 {
@@ -50,6 +77,18 @@ class HuggleTest : public QObject
         void testCaseTalkPageParser0015() { testTalkPageWarningParser("0015", QDate(2014, 5, 16), 1); }
         //! Test if IsIP returns true for users who are IP's
         void testCaseWikiUserCheckIP();
+        void testCaseWikiUserShared();
+        void testCaseIPAddress();
+        void testCaseIPAddressBenchmarkRegex();
+        void testCaseIPAddressBenchmarkParser();
+        void testCaseIPRangeTrie();
+        void testCaseTalkPageLevelCache();
+        void testCaseTalkPageParserBenchmark();
+        void testCaseTalkPageParserBenchmarkLegacy();
+        void testCaseMultiPatternMatcher();
+        void testCaseWhitelistSnapshot();
+        void testCaseWhitelistParseList();
+        void testCaseReputationStore();
         void testCaseTerminalParser();
         void testCaseConfigurationParse_YAML();
         void testCaseConfigurationParse_QL();
@@ -57,6 +96,14 @@ class HuggleTest : public QObject
         void testCaseVersionComparison();
         void testCaseGenerics();
         void testCaseWikiPage();
+        void testCaseStringPool();
+        void testCaseEditCacheByRevID();
+        void testCaseEditQueue();
+        void testCaseEditQueueIndex();
+        void testCaseQueueFilter();
+        void testCaseEditAggregator();
+        void testCaseQueueSnapshot();
+        void testCaseDiffDocument();
 };
 
 HuggleTest::HuggleTest()
@@ -124,6 +171,174 @@ static void testTalkPageWarningParser(QString id, QDate date, int level)
 
 }
 
+//! Talk page parser that was used before HuggleParser::ParseLevel existed, it's copied from the old HuggleParser
+//! without any change, so that benchmark compares with what was really used. It's not indented for the same reason.
+namespace HuggleLegacy
+{
+using namespace Huggle;
+
+static int DateMark(const QString& page, WikiSite *site)
+{
+    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    int m = 0;
+    int position = 0;
+    QString mark = "";
+    while (m < site->GetProjectConfig()->Parser_Date_Suffix.count())
+    {
+        QString m_ = site->GetProjectConfig()->Parser_Date_Suffix.at(m);
+        if (page.contains(m_))
+        {
+            int mp = page.lastIndexOf(m_);
+            if (mp > position)
+            {
+                mark = m_;
+                position = mp;
+            }
+        }
+        m++;
+    }
+    return position;
+}
+
+static byte_ht GetLevel(QString page, QDate bt, WikiSite *site)
+{
+    HUGGLE_PROFILER_INCRCALL(BOOST_CURRENT_FUNCTION);
+    if (Configuration::HuggleConfiguration->SystemConfig_TrimOldWarnings)
+    {
+        // we need to get rid of old warnings now
+        QStringList sections;
+        // windows fix
+        page.replace("\r", "");
+        while (page.length() > 1)
+        {
+            while (page[0] == '\n')
+            {
+                // remove all leading extra lines on page
+                page = page.mid(1);
+            }
+            if (!page.contains("\n\n"))
+            {
+                // no sections
+                sections.append(page);
+                break;
+            }
+            // get to bottom of it
+            int bottom = 0;
+            bottom = page.indexOf("\n\n");
+            QString section = page.mid(0, bottom);
+            page = page.mid(bottom + 2);
+            sections.append(section);
+        }
+
+        // now we browse all sections and remove these with no current date
+        int CurrentIndex = 0;
+        page = "";
+        while (CurrentIndex < sections.count())
+        {
+            int dp = DateMark(sections.at(CurrentIndex), site);
+            // we need to find a date in this section
+            if (!dp)
+            {
+                // there is none
+                CurrentIndex++;
+                continue;
+            }
+            QString section = sections.at(CurrentIndex);
+            section = section.mid(0, dp).trimmed();
+            if (!section.contains(site->GetProjectConfig()->Parser_Date_Prefix))
+            {
+                // this is some borked date let's remove it
+                CurrentIndex++;
+                continue;
+            }
+            QString time = section.mid(section.lastIndexOf(site->GetProjectConfig()->Parser_Date_Prefix) + site->GetProjectConfig()->Parser_Date_Prefix.length());
+            // now we need this uberhack so that we can get a month name from localized version
+            // let's hope that month is a word in a middle of string
+            time = time.trimmed();
+            QString month_name = "";
+            QStringList parts_time = time.split(' ');
+            if (parts_time.count() < 3)
+            {
+                // this is invalid string
+                HUGGLE_DEBUG("Unable to split month: " + time, 12);
+                CurrentIndex++;
+                continue;
+            }
+            QString day = parts_time.at(0);
+            // e.g. dewiki's days end with dot
+            if(day.endsWith('.'))
+                day = day.mid(0, day.length() - 1);
+            // on some wikis months have spaces in name
+            int i = 1;
+            while (i < parts_time.count() - 1)
+            {
+                month_name += parts_time.at(i) + " ";
+                i++;
+            }
+            month_name = month_name.trimmed();
+            byte_ht month = HuggleParser::GetIDOfMonth(month_name, site);
+
+             // let's create a new time string from converted one, just to make sure it will be parsed properly
+            if (month > 0)
+            {
+                time = day + " " + QString::number(month) + " " + parts_time.last();
+            } else
+            {
+                time = day + " " + parts_time.at(1); + " " + parts_time.last();
+            }
+            QDate date = QDate::fromString(time, "d M yyyy");
+            if (!date.isValid())
+            {
+                HUGGLE_DEBUG("Invalid date: " + time, 1);
+                CurrentIndex++;
+                continue;
+            } else
+            {
+                // now check if it's at least 1 month old
+                if (bt.addDays(site->ProjectConfig->TemplateAge) > date)
+                {
+                    // we don't want to parse this thing
+                    CurrentIndex++;
+                    continue;
+                }
+            }
+            page += sections.at(CurrentIndex) + "\n";
+            CurrentIndex++;
+        }
+    }
+    byte_ht level = 4;
+    while (level > 0)
+    {
+        foreach (QString df, site->ProjectConfig->WarningDefs)
+        {
+            if (HuggleParser::GetKeyFromSSItem(df).toInt() == level && page.contains(HuggleParser::GetValueFromSSItem(df)))
+            {
+                return level;
+            }
+        }
+        level--;
+    }
+    return 0;
+}
+}
+
+static QString benchmarkTalkPage()
+{
+    QString text;
+    while (text.size() < 500 * 1024)
+    {
+        int id = 1;
+        while (id <= 15)
+        {
+            QFile file(":/test/wikipage/tp" + QString("%1").arg(id++, 4, 10, QChar('0')) + ".txt");
+            file.open(QIODevice::ReadOnly);
+            text += QString(file.readAll()) + "\n\n";
+            file.close();
+        }
+    }
+    return text;
+}
+
 void HuggleTest::testCaseScores()
 {
     Huggle::Configuration::HuggleConfiguration->ProjectConfig->ScoreWords.clear();
@@ -223,6 +438,282 @@ void HuggleTest::testCaseWikiUserCheckIP()
     QVERIFY2((Huggle::WikiUser("Frank", hcfg->Project).IsIP() == false), "Invalid result for new WikiUser with username of IP, the result of IsIP() was true, but should have been false");
     QVERIFY2((Huggle::WikiUser("Joe", hcfg->Project).IsIP() == false), "Invalid result for new WikiUser with username of IP, the result of IsIP() was true, but should have been false");
     QVERIFY2((Huggle::WikiUser("2601:7:9380:135:1CCE:4CC0:7B6:8CD5", hcfg->Project).IsIP()), "Invalid result for new WikiUser with username of 2601:7:9380:135:1CCE:4CC0:7B6:8CD5, the result of IsIP() was false, but should have been true");
+
+    QVERIFY2(Huggle::WikiUser("2001:DB8::1", hcfg->Project).IsIP(), "Invalid result for compressed IPv6 address");
+    QVERIFY2(Huggle::WikiUser("::1", hcfg->Project).IsIP(), "Invalid result for IPv6 loopback");
+    QVERIFY2(Huggle::WikiUser("::", hcfg->Project).IsIP(), "Invalid result for IPv6 unspecified address");
+    QVERIFY2(Huggle::WikiUser("FE80::", hcfg->Project).IsIP(), "Invalid result for IPv6 address ending with ::");
+    QVERIFY2(Huggle::WikiUser("::FFFF:10.0.0.1", hcfg->Project).IsIP(), "Invalid result for IPv4 mapped IPv6 address");
+    QVERIFY2(Huggle::WikiUser("2001:db8:0:0:0:0:2:1", hcfg->Project).IsIP(), "Invalid result for lowercase IPv6 address");
+    QVERIFY2(!Huggle::WikiUser("2001:DB8::1::2", hcfg->Project).IsIP(), "IPv6 address with two :: was recognized as IP");
+    QVERIFY2(!Huggle::WikiUser("2001:DB8:0:0:0:0:0:0:1", hcfg->Project).IsIP(), "IPv6 address with 9 groups was recognized as IP");
+    QVERIFY2(!Huggle::WikiUser("2001:DB8:0:0:0:0:0", hcfg->Project).IsIP(), "IPv6 address with 7 groups was recognized as IP");
+    QVERIFY2(!Huggle::WikiUser("2001:DB8::12345", hcfg->Project).IsIP(), "IPv6 address with 5 digit group was recognized as IP");
+    QVERIFY2(!Huggle::WikiUser("2001:DB8::G", hcfg->Project).IsIP(), "IPv6 address with invalid digit was recognized as IP");
+    QVERIFY2(!Huggle::WikiUser(":1", hcfg->Project).IsIP(), "IPv6 address starting with single colon was recognized as IP");
+    QVERIFY2(!Huggle::WikiUser("1:", hcfg->Project).IsIP(), "IPv6 address ending with single colon was recognized as IP");
+    QVERIFY2(!Huggle::WikiUser("::FFFF:10.0.0.256", hcfg->Project).IsIP(), "IPv4 mapped address with invalid octet was recognized as IP");
+    QVERIFY2(!Huggle::WikiUser("10.0.0", hcfg->Project).IsIP(), "IPv4 address with 3 octets was recognized as IP");
+    QVERIFY2(!Huggle::WikiUser("10.0.0.1.", hcfg->Project).IsIP(), "IPv4 address ending with dot was recognized as IP");
+    QVERIFY2(!Huggle::WikiUser("Cafe:Bar", hcfg->Project).IsIP(), "Username with colon was recognized as IP");
+}
+
+void HuggleTest::testCaseWikiUserShared()
+{
+    Huggle::WikiUser *a = Huggle::WikiUser::Acquire("Shared user", hcfg->Project);
+    Huggle::WikiUser *b = Huggle::WikiUser::Acquire("Shared_user", hcfg->Project);
+    QVERIFY2(a == b, "Two acquires of same user didn't return the same instance");
+    a->BadnessScore = 42;
+    QVERIFY2(b->GetBadnessScore(false) == 42, "Change of shared user wasn't visible through the other reference");
+    Huggle::WikiUser::Release(a);
+    QVERIFY2(Huggle::WikiUser::SharedUsers.contains(QPair<Huggle::WikiSite*, QString>(hcfg->Project, "Shared_user")), "Shared user was removed while it was still referenced");
+    Huggle::WikiUser::Release(b);
+    QVERIFY2(!Huggle::WikiUser::SharedUsers.contains(QPair<Huggle::WikiSite*, QString>(hcfg->Project, "Shared_user")), "Shared user wasn't removed after last release");
+}
+
+void HuggleTest::testCaseIPAddress()
+{
+    Huggle::IPAddress address;
+    QVERIFY2(Huggle::IPAddress::Parse("192.168.1.20", &address) == Huggle::IPAddressTypeIPv4, "192.168.1.20 is not IPv4");
+    QVERIFY2(address.GetByte(10) == 0xff && address.GetByte(11) == 0xff, "IPv4 address is not mapped to IPv6");
+    QVERIFY2(address.GetByte(12) == 192 && address.GetByte(13) == 168 && address.GetByte(14) == 1 && address.GetByte(15) == 20, "Invalid bytes of IPv4 address");
+    QVERIFY2(Huggle::IPAddress::Parse("2001:DB8::FF00:42:8329", &address) == Huggle::IPAddressTypeIPv6, "2001:DB8::FF00:42:8329 is not IPv6");
+    QVERIFY2(address.GetByte(0) == 0x20 && address.GetByte(1) == 0x01 && address.GetByte(2) == 0x0d && address.GetByte(3) == 0xb8, "Invalid first group of IPv6 address");
+    QVERIFY2(address.GetByte(4) == 0 && address.GetByte(9) == 0, "Compressed groups of IPv6 address are not zero");
+    QVERIFY2(address.GetByte(10) == 0xff && address.GetByte(11) == 0x00 && address.GetByte(13) == 0x42 && address.GetByte(15) == 0x29, "Invalid last groups of IPv6 address");
+    Huggle::IPAddress mapped;
+    Huggle::IPAddress::Parse("::ffff:192.168.1.20", &mapped);
+    Huggle::IPAddress::Parse("192.168.1.20", &address);
+    QVERIFY2(memcmp(mapped.Bytes, address.Bytes, 16) == 0, "IPv4 mapped address differs from IPv4 address");
+    QVERIFY2(Huggle::IPAddress::Parse("Jimbo Wales", &address) == Huggle::IPAddressTypeNone, "Username was parsed as address");
+    QVERIFY2(address.Type == Huggle::IPAddressTypeNone, "Type of address wasn't reset");
+}
+
+static QStringList testIPAddressBenchmarkList()
+{
+    return QStringList() << "10.0.0.1" << "132.185.160.97" << "2601:7:9380:135:1CCE:4CC0:7B6:8CD5" << "2001:DB8::1"
+                         << "Frank" << "Jimbo Wales" << "ClueBot NG" << "355.2.0.1";
+}
+
+void HuggleTest::testCaseIPAddressBenchmarkRegex()
+{
+    QStringList names = testIPAddressBenchmarkList();
+    int ips = 0;
+    QBENCHMARK
+    {
+        ips = 0;
+        foreach (QString name, names)
+        {
+            if (IPv4Regex.exactMatch(name) || IPv6Regex.exactMatch(name))
+                ips++;
+        }
+    }
+    QVERIFY2(ips == 4, "Invalid number of IPs matched by regex");
+}
+
+void HuggleTest::testCaseIPAddressBenchmarkParser()
+{
+    QStringList names = testIPAddressBenchmarkList();
+    int ips = 0;
+    QBENCHMARK
+    {
+        ips = 0;
+        foreach (QString name, names)
+        {
+            if (Huggle::IPAddress::Parse(name) != Huggle::IPAddressTypeNone)
+                ips++;
+        }
+    }
+    QVERIFY2(ips == 4, "Invalid number of IPs recognized by parser");
+}
+
+void HuggleTest::testCaseIPRangeTrie()
+{
+    Huggle::IPRangeTrie trie;
+    QVERIFY2(trie.Update("192.168.1.10", 200, 2), "IPv4 address was not stored");
+    QVERIFY2(trie.Update("192.168.1.20", 400, 1), "IPv4 address was not stored");
+    QVERIFY2(trie.Update("192.168.2.1", -200, 0), "IPv4 address was not stored");
+    QVERIFY2(!trie.Update("Jimbo Wales", 100, 1), "Username was stored as an address");
+    Huggle::IPRangeStats range = trie.GetRange("192.168.1.99", 24);
+    QVERIFY2(range.Addresses == 2, "Invalid number of addresses in /24 range");
+    QVERIFY2(range.Badness == 600, "Invalid badness of /24 range");
+    QVERIFY2(range.Warnings == 3, "Invalid number of warnings in /24 range");
+    range = trie.GetRange("192.168.1.10", 24, true);
+    QVERIFY2(range.Addresses == 1, "Address itself was not excluded from its range");
+    QVERIFY2(range.Badness == 400, "Badness of address itself was not excluded from its range");
+    range = trie.GetRange("192.168.7.7", 16);
+    QVERIFY2(range.Addresses == 3, "Invalid number of addresses in /16 range");
+    QVERIFY2(range.Badness == 400, "Invalid badness of /16 range");
+    QVERIFY2(trie.GetRange("10.0.0.1", 8).Addresses == 0, "Unrelated range contains addresses");
+    // update replaces the previous values of address
+    trie.Update("192.168.1.10", 0, 0);
+    range = trie.GetRange("192.168.1.1", 24);
+    QVERIFY2(range.Addresses == 2, "Update of existing address changed the number of addresses");
+    QVERIFY2(range.Badness == 400, "Update didn't replace the badness of address");
+    QVERIFY2(range.Warnings == 1, "Update didn't replace the warnings of address");
+    trie.Update("2001:db8::1", 200, 1);
+    trie.Update("2001:db8::ffff", 200, 1);
+    QVERIFY2(trie.GetRange("2001:db8::1234", 64).Addresses == 2, "Invalid number of addresses in IPv6 /64 range");
+    QVERIFY2(trie.GetRange("2001:db8:0:1::1", 64).Addresses == 0, "Unrelated IPv6 range contains addresses");
+    QVERIFY2(trie.GetRange("192.168.1.1", 24).Addresses == 2, "IPv6 addresses were counted in IPv4 range");
+    int x = 0;
+    while (x < 1000)
+    {
+        trie.Update("10." + QString::number(x / 256) + "." + QString::number(x % 256) + ".1", 100, 1);
+        x++;
+    }
+    QVERIFY2(trie.GetRange("10.0.0.0", 8).Addresses == 1000, "Invalid number of addresses in /8 range");
+    int nodes = trie.GetNodeCount();
+    x = 0;
+    while (x < 1000)
+    {
+        QVERIFY2(trie.Remove("10." + QString::number(x / 256) + "." + QString::number(x % 256) + ".1"), "Stored address couldn't be removed");
+        x++;
+    }
+    QVERIFY2(trie.GetAddressCount() == 5, "Invalid number of addresses after removal");
+    QVERIFY2(trie.GetRange("10.0.0.0", 8).Addresses == 0, "Removed addresses are still counted in their range");
+    QVERIFY2(trie.GetRange("192.168.1.1", 24).Badness == 400, "Removal changed badness of unrelated range");
+    QVERIFY2(trie.GetNodeCount() < nodes / 10, "Nodes of removed addresses were not released");
+}
+
+void HuggleTest::testCaseTalkPageLevelCache()
+{
+    QFile file(":/test/wikipage/tp0001.txt");
+    file.open(QIODevice::ReadOnly);
+    QString text = QString(file.readAll());
+    file.close();
+    Huggle::HuggleParser::ClearLevelCache();
+    qint64 hits = Huggle::HuggleParser::GetLevelCacheHits();
+    byte_ht level = Huggle::HuggleParser::GetLevel(text, QDate(2014, 4, 1), hcfg->Project);
+    QVERIFY2(level == 3, "Invalid level parsed from tp0001");
+    QVERIFY2(Huggle::HuggleParser::GetLevelCacheHits() == hits, "Cache was hit for page that wasn't parsed yet");
+    QVERIFY2(Huggle::HuggleParser::GetLevel(QString(text), QDate(2014, 4, 1), hcfg->Project) == level, "Cached level differs");
+    QVERIFY2(Huggle::HuggleParser::GetLevelCacheHits() == hits + 1, "Cache wasn't hit for same talk page");
+    // different date must not be served from cache
+    Huggle::HuggleParser::GetLevel(text, QDate(2014, 4, 2), hcfg->Project);
+    QVERIFY2(Huggle::HuggleParser::GetLevelCacheHits() == hits + 1, "Cache was hit for different date");
+    Huggle::HuggleParser::GetLevel(text + "\n", QDate(2014, 4, 1), hcfg->Project);
+    QVERIFY2(Huggle::HuggleParser::GetLevelCacheHits() == hits + 1, "Cache was hit for changed talk page");
+}
+
+void HuggleTest::testCaseTalkPageParserBenchmark()
+{
+    QString text = benchmarkTalkPage();
+    byte_ht level = 0;
+    QBENCHMARK
+    {
+        level = Huggle::HuggleParser::ParseLevel(text, QDate(2014, 5, 16), hcfg->Project);
+    }
+    // the old parser loses the year of dates with unknown month, test pages only use known month names, so results are same
+    QVERIFY2(level == HuggleLegacy::GetLevel(text, QDate(2014, 5, 16), hcfg->Project), "Parser returned different level than the old one");
+}
+
+void HuggleTest::testCaseTalkPageParserBenchmarkLegacy()
+{
+    QString text = benchmarkTalkPage();
+    byte_ht level = 0;
+    QBENCHMARK
+    {
+        level = HuggleLegacy::GetLevel(text, QDate(2014, 5, 16), hcfg->Project);
+    }
+    QVERIFY2(level == Huggle::HuggleParser::ParseLevel(text, QDate(2014, 5, 16), hcfg->Project), "Old parser returned different level than the new one");
+}
+
+void HuggleTest::testCaseMultiPatternMatcher()
+{
+    Huggle::MultiPatternMatcher matcher;
+    QVERIFY2(!matcher.Contains("anything"), "Empty matcher found a pattern");
+    matcher.AddPattern("he", 1);
+    matcher.AddPattern("she", 2);
+    matcher.AddPattern("his", 3);
+    matcher.AddPattern("hers", 4);
+    QVERIFY2(matcher.Count() == 4, "Invalid number of patterns");
+    QVERIFY2(matcher.MatchHighest("ushers") == 4, "Invalid highest match in ushers");
+    QVERIFY2(matcher.MatchHighest("ushe") == 2, "Pattern found through failure link wasn't matched");
+    QVERIFY2(matcher.MatchHighest("ahishe") == 3, "Invalid highest match in ahishe");
+    QVERIFY2(matcher.MatchHighest("hhhhe") == 1, "Pattern after repeated prefix wasn't matched");
+    QVERIFY2(matcher.MatchHighest("hrs sh") == -1, "Found pattern which is not in text");
+    QVERIFY2(matcher.Contains("the"), "Contains didn't find pattern at the end of text");
+    QVERIFY2(!matcher.HasMultilinePatterns(), "Matcher has multiline patterns");
+    matcher.Clear();
+    QVERIFY2(!matcher.Contains("she"), "Matcher wasn't cleared");
+}
+
+void HuggleTest::testCaseWhitelistSnapshot()
+{
+    QString path = QDir::tempPath() + "/huggle_test_whitelist.dat";
+    Huggle::ProjectConfiguration source("test");
+    source.WhiteList << "Jimbo_Wales" << "ClueBot_NG" << QString::fromUtf8("P\xc5\x99\xc3\xadklad");
+    source.WhitelistTime = QDateTime::currentDateTime();
+    source.WhitelistSnapshotTime = source.WhitelistTime;
+    QVERIFY2(source.SaveWhitelistSnapshot(path), "Unable to write whitelist snapshot");
+    Huggle::ProjectConfiguration target("test");
+    QVERIFY2(target.LoadWhitelistSnapshot(path, 24), "Unable to load whitelist snapshot");
+    QVERIFY2(target.WhiteList == source.WhiteList, "Loaded whitelist differs from stored one");
+    QVERIFY2(target.WhitelistSnapshotTime == source.WhitelistSnapshotTime, "Time of full download wasn't restored from snapshot");
+    // changes were merged recently, but whole list is too old, so it needs to be downloaded again
+    source.WhitelistSnapshotTime = QDateTime::currentDateTime().addDays(-2);
+    source.SaveWhitelistSnapshot(path);
+    QVERIFY2(!target.LoadWhitelistSnapshot(path, 24), "Whitelist snapshot which is too old was loaded even though only changes were merged since then");
+    QFile::remove(path);
+    QVERIFY2(!target.LoadWhitelistSnapshot(path, 24), "Whitelist snapshot which doesn't exist was loaded");
+}
+
+void HuggleTest::testCaseWhitelistParseList()
+{
+    QStringList users = Huggle::WLQuery::ParseList("<!-- list -->Jimbo_Wales|ClueBot NG||Test||EOW||");
+    QVERIFY2(users.count() == 3, "Invalid number of users in parsed whitelist");
+    QVERIFY2(users.at(0) == "Jimbo_Wales", "First user of whitelist wasn't parsed correctly");
+    QVERIFY2(users.at(1) == "ClueBot NG", "Username with space wasn't parsed correctly");
+    QVERIFY2(users.at(2) == "Test", "User before terminator wasn't parsed correctly");
+    QVERIFY2(Huggle::WLQuery::ParseList("<!-- list -->").isEmpty(), "Empty delta of whitelist contains users");
+    QVERIFY2(Huggle::WLQuery::ParseList(" Example \n|").count() == 1, "Whitespace around usernames wasn't removed");
+}
+
+void HuggleTest::testCaseReputationStore()
+{
+    QString path = QDir::tempPath() + "/huggle_test_reputation.db";
+    QFile::remove(path);
+    Huggle::ReputationStore store;
+    QVERIFY2(store.Open(path, 1000), "Unable to open reputation store");
+    Huggle::ReputationStore_Entry entry;
+    entry.Badness = 200;
+    entry.WarningLevel = 3;
+    entry.WarningTime = 1000;
+    entry.TalkPageRevID = 123456;
+    entry.LastUpdate = 1;
+    QVERIFY2(store.Put(hcfg->Project, "Vandal user", entry), "Unable to store user");
+    Huggle::ReputationStore_Entry result;
+    QVERIFY2(store.Get(hcfg->Project, "Vandal_user", &result), "Username with underscores wasn't found");
+    QVERIFY2(result.Badness == 200, "Invalid badness of stored user");
+    QVERIFY2(result.WarningLevel == 3, "Invalid warning level of stored user");
+    QVERIFY2(result.WarningTime == 1000, "Invalid warning time of stored user");
+    QVERIFY2(!store.Get(hcfg->Project, "Someone else", &result), "Unknown user was found in store");
+    store.Close();
+    // data must survive a restart
+    QVERIFY2(store.Open(path, 1000), "Unable to reopen reputation store");
+    QVERIFY2(store.Get(hcfg->Project, "Vandal user", &result), "User wasn't found after reopening the store");
+    QVERIFY2(result.TalkPageRevID == 123456, "Invalid talk page revision after reopening the store");
+    // once the store is full, the users that were updated longest ago are dropped
+    int x = 0;
+    while (x < 1200)
+    {
+        entry.LastUpdate = 10 + x;
+        entry.Badness = x;
+        QVERIFY2(store.Put(hcfg->Project, "User " + QString::number(x), entry), "Unable to store user");
+        x++;
+    }
+    QVERIFY2(store.Count() <= 1000, "Store contains more users than allowed");
+    QVERIFY2(store.Get(hcfg->Project, "User 1199", &result), "Recently updated user was dropped");
+    QVERIFY2(result.Badness == 1199, "Invalid badness of user after resize");
+    QVERIFY2(!store.Get(hcfg->Project, "User 0", &result), "User updated longest ago wasn't dropped");
+    QVERIFY2(!store.Get(hcfg->Project, "Vandal user", &result), "User updated longest ago wasn't dropped");
+    store.Close();
+    // resized file must be valid after restart too
+    QVERIFY2(store.Open(path, 1000), "Unable to reopen resized reputation store");
+    QVERIFY2(store.Get(hcfg->Project, "User 1199", &result), "User wasn't found after reopening resized store");
+    store.Close();
+    QFile::remove(path);
 }
 
 void HuggleTest::testCaseTerminalParser()
@@ -313,6 +804,419 @@ void HuggleTest::testCaseWikiPage()
     delete page1_talk;
 }
 
+void HuggleTest::testCaseStringPool()
+{
+    Huggle::StringPool pool;
+    QString a = pool.Intern(QString("Main") + " Page");
+    QString b = pool.Intern(QString("Main Page"));
+    QVERIFY2(a.constData() == b.constData(), "Interned strings with same value don't share the buffer");
+    QVERIFY2(Huggle::StringPool::Equal(a, b), "Interned strings are not equal");
+    QVERIFY2(!Huggle::StringPool::Equal(a, pool.Intern("Main page")), "Different strings are equal");
+    QVERIFY2(pool.Count() == 2, QString("Invalid number of strings in pool: " + QString::number(pool.Count())).toUtf8().data());
+    QVERIFY2(pool.GetHits() == 1, "Invalid number of pool hits");
+    QVERIFY2(pool.GetBytesSaved() == 9 * static_cast<qint64>(sizeof(QChar)), "Invalid number of saved bytes");
+    Huggle::WikiPage page1("Test page", hcfg->Project);
+    Huggle::WikiPage page2("Test page", hcfg->Project);
+    QVERIFY2(page1.PageName.constData() == page2.PageName.constData(), "Titles of pages on same site are not interned");
+    QVERIFY2(page1.EqualTo(&page2), "Pages with same title are not equal");
+    a.clear();
+    b.clear();
+    QVERIFY2(pool.Trim() == 18 * static_cast<qint64>(sizeof(QChar)), "Unused strings were not released from pool");
+    QVERIFY2(pool.Count() == 0, QString("Invalid number of strings in pool after trim: " + QString::number(pool.Count())).toUtf8().data());
+}
+
+void HuggleTest::testCaseEditCacheByRevID()
+{
+    Huggle::WikiSite *site = new Huggle::WikiSite("de", "de.wikipedia");
+    QList<Huggle::WikiEdit*> edits;
+    int x = 0;
+    while (x < 50000)
+    {
+        Huggle::WikiEdit *edit = new Huggle::WikiEdit();
+        edit->Page = new Huggle::WikiPage("Test page " + QString::number(x), hcfg->Project);
+        edit->SetRevID(x + 1);
+        edits.append(edit);
+        x++;
+    }
+    // same revision id on different wiki
+    Huggle::WikiEdit *other = new Huggle::WikiEdit();
+    other->Page = new Huggle::WikiPage("Test page", site);
+    other->SetRevID(100);
+    QVERIFY2(Huggle::WikiEdit::FromCacheByRevID(100, "prev", site).GetPtr() == other, "Edit from other site wasn't found");
+    QVERIFY2(Huggle::WikiEdit::FromCacheByRevID(100, "prev", hcfg->Project).GetPtr() == edits.at(99), "Edit from project site wasn't found");
+    QVERIFY2(Huggle::WikiEdit::FromCacheByRevID(50001, "prev", hcfg->Project).GetPtr() == nullptr, "Found edit which doesn't exist");
+    QVERIFY2(Huggle::WikiEdit::FromCacheByRevID(100, "100", hcfg->Project).GetPtr() == nullptr, "Found edit with different diff target");
+    // changing the revision id needs to update the index
+    edits.at(0)->SetRevID(60000);
+    QVERIFY2(Huggle::WikiEdit::FromCacheByRevID(1).GetPtr() == nullptr, "Index wasn't updated on revision change");
+    QVERIFY2(Huggle::WikiEdit::FromCacheByRevID(60000).GetPtr() == edits.at(0), "Index wasn't updated on revision change");
+    revid_ht revid = 1;
+    QBENCHMARK
+    {
+        Huggle::Collectable_SmartPtr<Huggle::WikiEdit> edit = Huggle::WikiEdit::FromCacheByRevID(revid, "prev", hcfg->Project);
+        Q_UNUSED(edit);
+        revid = (revid % 50000) + 1;
+    }
+    delete other;
+    foreach (Huggle::WikiEdit *edit, edits)
+        delete edit;
+    QVERIFY2(Huggle::WikiEdit::FromCacheByRevID(100).GetPtr() == nullptr, "Deleted edit is still in index");
+    delete site;
+}
+
+void HuggleTest::testCaseEditQueue()
+{
+    QList<Huggle::WikiEdit*> edits;
+    QList<Huggle::WikiPage*> pages;
+    int x = 0;
+    while (x < 100)
+    {
+        pages.append(new Huggle::WikiPage("Test page " + QString::number(x), hcfg->Project));
+        x++;
+    }
+    unsigned int seed = 12345;
+    x = 0;
+    while (x < 10000)
+    {
+        Huggle::WikiEdit *edit = new Huggle::WikiEdit();
+        edit->Page = pages.at(x % 100);
+        edit->SetRevID(x + 1);
+        // every benchmark iteration inserts the same edits again
+        edit->SetReclaimable();
+        // simple LCG so that the scores are same in every run
+        seed = seed * 1103515245 + 12345;
+        edit->Score = static_cast<long>((seed >> 16) % 2000) - 1000;
+        edits.append(edit);
+        x++;
+    }
+    QBENCHMARK
+    {
+        Huggle::EditQueue queue;
+        foreach (Huggle::WikiEdit *edit, edits)
+            queue.Insert(edit);
+        while (queue.Count() > 0)
+            queue.PopBest();
+    }
+    Huggle::EditQueue queue;
+    Huggle::EditQueueModel model(&queue);
+    foreach (Huggle::WikiEdit *edit, edits)
+        queue.Insert(edit);
+    QVERIFY2(model.rowCount() == 10000, "Invalid number of rows");
+    x = 1;
+    while (x < queue.Count())
+    {
+        QVERIFY2(queue.At(x - 1)->Score >= queue.At(x)->Score, "Queue is not sorted");
+        x++;
+    }
+    QVERIFY2(queue.GetWikiEditByRevID(500, hcfg->Project) == edits.at(499), "Edit wasn't found by revision");
+    QVERIFY2(queue.GetEditsForPage(pages.at(7)).count() == 100, "Invalid number of edits for page");
+    // change of score needs to move the edit
+    Huggle::WikiEdit *first = queue.At(0);
+    Huggle::WikiEdit *last = queue.At(queue.Count() - 1);
+    last->Score = 5000;
+    queue.Resort(last);
+    QVERIFY2(queue.At(0) == last, "Edit wasn't moved after its score changed");
+    QVERIFY2(queue.IndexOf(first) == 1, "Resort changed order of other edits");
+    QVERIFY2(queue.PopBest().GetPtr() == last, "Edit with best score wasn't returned");
+    QVERIFY2(queue.DeleteByRevID(500, hcfg->Project), "Edit wasn't deleted by revision");
+    QVERIFY2(queue.GetWikiEditByRevID(500, hcfg->Project) == nullptr, "Deleted edit is still in revision index");
+    // only newest edit of page 7 stays
+    queue.DeleteOlder(edits.at(9907));
+    QVERIFY2(queue.GetEditsForPage(pages.at(7)).count() == 1, "Older edits of page were not deleted");
+    QVERIFY2(model.rowCount() == queue.Count(), "Model doesn't match the queue");
+    queue.Clear();
+    QVERIFY2(model.rowCount() == 0, "Queue wasn't cleared");
+    foreach (Huggle::WikiEdit *edit, edits)
+    {
+        edit->Page = nullptr;
+        edit->SafeDelete();
+    }
+    qDeleteAll(pages);
+}
+
+void HuggleTest::testCaseEditQueueIndex()
+{
+    // the index only stores the pointers, so fake ones are enough and the result is compared with plain list
+    Huggle::EditQueueIndex index;
+    QList<Huggle::EditQueue_Entry> reference;
+    unsigned int seed = 12345;
+    quintptr id = 1;
+    int x = 0;
+    while (x < 20000)
+    {
+        seed = seed * 1103515245 + 12345;
+        if ((seed >> 16) % 3 != 0 || reference.isEmpty())
+        {
+            Huggle::EditQueue_Entry entry;
+            entry.Score = static_cast<long>((seed >> 8) % 50);
+            entry.Edit = reinterpret_cast<Huggle::WikiEdit*>(id++);
+            bool after_equal = (seed >> 20) % 2 == 0;
+            int position = 0;
+            while (position < reference.count() && (reference.at(position).Score < entry.Score ||
+                                                   (after_equal && reference.at(position).Score == entry.Score)))
+                position++;
+            QVERIFY2(index.FindPosition(entry.Score, after_equal) == position, "Invalid position for new entry");
+            index.Insert(position, entry);
+            reference.insert(position, entry);
+        } else
+        {
+            int position = static_cast<int>((seed >> 8) % reference.count());
+            QVERIFY2(index.IndexOf(reference.at(position).Edit) == position, "Invalid position of entry");
+            QVERIFY2(index.RemoveAt(position).Edit == reference.at(position).Edit, "Wrong entry was removed");
+            reference.removeAt(position);
+        }
+        x++;
+    }
+    QVERIFY2(index.Count() == reference.count(), "Invalid number of entries");
+    QVector<Huggle::EditQueue_Entry> entries = index.ToVector();
+    x = 0;
+    while (x < reference.count())
+    {
+        QVERIFY2(entries.at(x).Edit == reference.at(x).Edit, "Entries are in wrong order");
+        QVERIFY2(index.At(x).Edit == reference.at(x).Edit, "Invalid entry on position");
+        x++;
+    }
+    index.Rebuild(entries);
+    QVERIFY2(index.IndexOf(entries.last().Edit) == entries.count() - 1, "Rebuilt index is broken");
+    index.Clear();
+    QVERIFY2(index.Count() == 0 && index.IndexOf(entries.first().Edit) == -1, "Index wasn't cleared");
+}
+
+void HuggleTest::testCaseQueueFilter()
+{
+    hcfg->SystemConfig_UserName = "Huggler";
+    QList<Huggle::WikiEdit*> edits;
+    int x = 0;
+    while (x < 1000)
+    {
+        Huggle::WikiEdit *edit = new Huggle::WikiEdit();
+        if (x % 10 == 0)
+            edit->Page = new Huggle::WikiPage("User talk:Test " + QString::number(x), hcfg->Project);
+        else
+            edit->Page = new Huggle::WikiPage("Test page " + QString::number(x), hcfg->Project);
+        if (x % 7 == 0)
+            edit->User = new Huggle::WikiUser("192.168.0." + QString::number(x % 256), hcfg->Project);
+        else if (x % 100 == 1)
+            edit->User = new Huggle::WikiUser("huggler", hcfg->Project);
+        else
+            edit->User = new Huggle::WikiUser("User " + QString::number(x), hcfg->Project);
+        edit->Bot = (x % 5 == 0);
+        edit->IsMinor = (x % 3 == 0);
+        edit->NewPage = false;
+        edit->IsRevert = false;
+        edit->TrustworthEdit = (x % 11 == 0);
+        edits.append(edit);
+        x++;
+    }
+    Huggle::HuggleQueueFilter filter;
+    int matches = 0;
+    QBENCHMARK
+    {
+        matches = 0;
+        foreach (Huggle::WikiEdit *edit, edits)
+        {
+            if (filter.Matches(edit))
+                matches++;
+        }
+    }
+    // default filter excludes bots, talk pages, edits made by tools and own edits
+    int expected = 0;
+    x = 0;
+    while (x < 1000)
+    {
+        bool self = (x % 100 == 1 && x % 7 != 0);
+        if (x % 10 != 0 && x % 5 != 0 && x % 11 != 0 && !self)
+            expected++;
+        x++;
+    }
+    QVERIFY2(matches == expected, QString("Default filter matched " + QString::number(matches) + " edits instead of " + QString::number(expected)).toUtf8().data());
+    filter.setIgnoreSelf(Huggle::HuggleQueueFilterMatchRequire);
+    filter.setIgnoreBots(Huggle::HuggleQueueFilterMatchIgnore);
+    filter.setIgnoreTalk(Huggle::HuggleQueueFilterMatchIgnore);
+    filter.setIgnoreFriends(Huggle::HuggleQueueFilterMatchIgnore);
+    QVERIFY2(filter.Matches(edits.at(1)), "Own edit didn't match filter that requires it");
+    QVERIFY2(!filter.Matches(edits.at(2)), "Edit of other user matched filter that requires own edits");
+    filter.setIgnoreSelf(Huggle::HuggleQueueFilterMatchIgnore);
+    filter.setIgnoreIP(Huggle::HuggleQueueFilterMatchRequire);
+    QVERIFY2(filter.Matches(edits.at(7)), "IP edit didn't match filter that requires it");
+    QVERIFY2(!filter.Matches(edits.at(2)), "Registered user matched filter that requires IP");
+    filter.setIgnoreIP(Huggle::HuggleQueueFilterMatchIgnore);
+    filter.SetIgnoredTags_CommaSeparated("mobile edit,visual edit");
+    edits.at(2)->Status = Huggle::StatusPostProcessed;
+    edits.at(2)->Tags << "visual edit";
+    QVERIFY2(!filter.Matches(edits.at(2)), "Edit with ignored tag matched filter");
+    filter.SetIgnoredTags_CommaSeparated("");
+    filter.SetRequiredTags_CommaSeparated("visual edit");
+    QVERIFY2(filter.Matches(edits.at(2)), "Edit with required tag didn't match filter");
+    edits.at(3)->Status = Huggle::StatusPostProcessed;
+    QVERIFY2(!filter.Matches(edits.at(3)), "Edit without required tag matched filter");
+    QVERIFY2(filter.MatchesBeforePostProcessing(edits.at(3)), "Tags were not deferred until post processing");
+    edits.at(3)->Status = Huggle::StatusNone;
+    edits.at(2)->Status = Huggle::StatusNone;
+    qint64 avoided = Huggle::HuggleQueueFilter::RequestsAvoided.load();
+    QVERIFY2(!filter.MatchesBeforePostProcessing(edits.at(5)), "Bot edit matched filter before post processing");
+    QVERIFY2(Huggle::HuggleQueueFilter::RequestsAvoided.load() > avoided, "Early rejection didn't count avoided requests");
+    filter.SetRequiredTags_CommaSeparated("");
+    QStringList patterns = hcfg->ProjectConfig->IgnorePatterns;
+    hcfg->ProjectConfig->IgnorePatterns << "page 3" << "Sandbox";
+    hcfg->ProjectConfig->RebuildIgnores();
+    QVERIFY2(!filter.Matches(edits.at(3)), "Page that contains ignored pattern matched filter");
+    QVERIFY2(!filter.Matches(edits.at(31)), "Page that contains ignored pattern matched filter");
+    QVERIFY2(filter.Matches(edits.at(2)), "Page that doesn't contain ignored pattern didn't match filter");
+    hcfg->ProjectConfig->IgnorePatterns = patterns;
+    hcfg->ProjectConfig->RebuildIgnores();
+    Huggle::HuggleQueueFilter profiled;
+    hcfg->SystemConfig_FilterProfiling = true;
+    foreach (Huggle::WikiEdit *edit, edits)
+        profiled.Matches(edit);
+    hcfg->SystemConfig_FilterProfiling = false;
+    QVERIFY2(profiled.GetCounter(Huggle::HuggleQueueFilterCriterionNamespace).Evaluations == 1000, "Filter profiling didn't count all edits");
+    QVERIFY2(profiled.GetCounter(Huggle::HuggleQueueFilterCriterionProperties).Rejections == 1000 - expected,
+             "Filter profiling didn't count rejections of properties");
+    QVERIFY2(profiled.GetCounter(Huggle::HuggleQueueFilterCriterionBots).Rejections == 200, "Filter profiling didn't count rejected bots");
+    profiled.ResetCounters();
+    QVERIFY2(profiled.GetCounter(Huggle::HuggleQueueFilterCriterionNamespace).Evaluations == 0, "Filter counters were not reset");
+    hcfg->SystemConfig_UserName = "";
+    qDeleteAll(edits);
+}
+
+void HuggleTest::testCaseEditAggregator()
+{
+    hcfg->SystemConfig_EditAggregationWindow = 5;
+    QList<Huggle::WikiEdit*> edits;
+    int x = 0;
+    while (x < 4)
+    {
+        Huggle::WikiEdit *edit = new Huggle::WikiEdit();
+        edit->Page = new Huggle::WikiPage("Test page", hcfg->Project);
+        // last edit was made by someone else
+        edit->User = new Huggle::WikiUser(x < 3 ? "Vandal" : "Someone", hcfg->Project);
+        edit->SetRevID(101 + x);
+        edit->OldID = 100 + x;
+        edit->SetSize(100 * (x + 1));
+        edit->Summary = (x == 0) ? "" : "edit " + QString::number(x);
+        if (x == 1)
+            edit->Tags << "mw-blank";
+        edit->IncRef();
+        edits.append(edit);
+        x++;
+    }
+    Huggle::EditAggregator aggregator;
+    QVERIFY2(!aggregator.Insert(edits.at(0)), "First edit was merged into nothing");
+    QVERIFY2(aggregator.Insert(edits.at(1)), "Second edit of same user wasn't merged");
+    QVERIFY2(aggregator.Insert(edits.at(2)), "Third edit of same user wasn't merged");
+    QVERIFY2(!aggregator.Insert(edits.at(3)), "Edit of other user was merged");
+    QVERIFY2(aggregator.Count() == 2, "Wrong number of held edits");
+    Huggle::WikiEdit *merged = edits.at(0);
+    QVERIFY2(merged->RevID == 103, "Merged edit doesn't point to last revision");
+    QVERIFY2(merged->OldID == 100, "Merged edit doesn't start at parent of first revision");
+    QVERIFY2(merged->GetRevisionCount() == 3, "Merged edit doesn't keep all revisions");
+    QVERIFY2(merged->GetSize() == 600, "Size of merged edit is not a sum of all revisions");
+    QVERIFY2(merged->Revisions.at(0).Summary.isEmpty() && merged->Summary == "edit 2", "Summaries of revisions were not kept");
+    QVERIFY2(merged->Revisions.at(1).Tags.contains("mw-blank") && !merged->Revisions.at(2).Tags.contains("mw-blank"), "Tags of revisions were not kept");
+    QVERIFY2(aggregator.RetrieveEdit() == nullptr, "Edit was released before its window passed");
+    aggregator.Clear();
+    foreach (Huggle::WikiEdit *edit, edits)
+        edit->SafeDelete();
+}
+
+void HuggleTest::testCaseQueueSnapshot()
+{
+    hcfg->Projects << hcfg->Project;
+    QString path = QDir::tempPath() + "/huggle_queue_snapshot_test.dat";
+    QList<Huggle::WikiEdit*> edits;
+    Huggle::EditQueue queue;
+    int x = 0;
+    while (x < 3)
+    {
+        Huggle::WikiEdit *edit = new Huggle::WikiEdit();
+        edit->Page = new Huggle::WikiPage("Snapshot page " + QString::number(x), hcfg->Project);
+        edit->User = new Huggle::WikiUser("Snapshot user " + QString::number(x), hcfg->Project);
+        edit->SetRevID(200 + x);
+        edit->Score = 100 * x;
+        edit->DiffText = "diff of " + QString::number(x);
+        edit->Tags << "tag";
+        edit->Status = Huggle::StatusPostProcessed;
+        queue.Insert(edit);
+        edits.append(edit);
+        x++;
+    }
+    QVERIFY2(queue.SaveSnapshot(path), "Unable to start writing of snapshot");
+    QVERIFY2(queue.WaitForSnapshot(), "Unable to write snapshot");
+    Huggle::EditQueue restored;
+    QVERIFY2(restored.LoadSnapshot(path, 10) == 3, "Wrong number of edits was restored");
+    QVERIFY2(restored.Count() == 3, "Fresh edits were not inserted to queue");
+    QVERIFY2(restored.At(0)->RevID == 202 && restored.At(0)->Score == 200, "Order or score of restored edits is wrong");
+    QVERIFY2(restored.At(2)->GetMemoryTier() == Huggle::MemoryTierCompressed, "Text of restored edit was decompressed before it was needed");
+    QVERIFY2(restored.At(2)->DecompressText() && restored.At(2)->DiffText == "diff of 0", "Diff of edit wasn't restored");
+    QVERIFY2(restored.At(1)->Tags.contains("tag") && restored.At(1)->IsPostProcessed(), "State of edit wasn't restored");
+    QVERIFY2(restored.At(1)->User->Username == "Snapshot user 1", "User wasn't restored");
+    QList<Huggle::WikiEdit*> restored_edits;
+    while (restored.Count() > 0)
+    {
+        restored_edits << restored.At(0);
+        restored.Remove(restored.At(0));
+    }
+    foreach (Huggle::WikiEdit *edit, restored_edits)
+        edit->SafeDelete();
+    queue.Clear();
+    foreach (Huggle::WikiEdit *edit, edits)
+        edit->SafeDelete();
+    QFile::remove(path);
+    hcfg->Projects.removeAll(hcfg->Project);
+}
+
+void HuggleTest::testCaseDiffDocument()
+{
+    QVERIFY2(Huggle::DiffDocument::DecodeEntities("a &amp; b &lt;c&gt; &#160;&#x41;&unknown; & d") == QString("a & b <c> ") + QChar(0xA0) + "A&unknown; & d",
+             "Entities were not decoded properly");
+    Huggle::DiffDocument document;
+    QVERIFY2(!document.Parse(""), "Empty text was parsed as diff");
+    QVERIFY2(!document.Parse("<p>this is not a diff</p>"), "Html without table was parsed as diff");
+    QString diff = "<tr>\n"
+                   "  <td colspan=\"4\" class=\"diff-multi\" lang=\"en\">(2 intermediate revisions by 2 users not shown)</td>\n"
+                   "</tr>\n"
+                   "<tr>\n"
+                   "  <td colspan=\"2\" class=\"diff-lineno\">Line 1:</td>\n"
+                   "  <td colspan=\"2\" class=\"diff-lineno\">Line 1:</td>\n"
+                   "</tr>\n"
+                   "<tr>\n"
+                   "  <td class=\"diff-marker\">\xe2\x88\x92</td>\n"
+                   "  <td class=\"diff-deletedline\"><div>Foo <del class=\"diffchange diffchange-inline\">bar</del> baz</div></td>\n"
+                   "  <td class=\"diff-marker\">+</td>\n"
+                   "  <td class=\"diff-addedline\"><div>Foo <ins class=\"diffchange diffchange-inline\">qux &amp; quux</ins> baz</div></td>\n"
+                   "</tr>\n"
+                   "<tr>\n"
+                   "  <td colspan=\"2\" class=\"diff-empty\">&#160;</td>\n"
+                   "  <td class=\"diff-marker\">+</td>\n"
+                   "  <td class=\"diff-addedline\"><div>New line</div></td>\n"
+                   "</tr>\n"
+                   "<tr>\n"
+                   "  <td class=\"diff-marker\">&#160;</td>\n"
+                   "  <td class=\"diff-context\"><div>Same</div></td>\n"
+                   "  <td class=\"diff-marker\">&#160;</td>\n"
+                   "  <td class=\"diff-context\"><div>Same</div>\n";
+    // last row is not closed on purpose
+    QVERIFY2(document.Parse(diff), "Diff wasn't parsed");
+    QVERIFY2(document.Rows.count() == 5, "Wrong number of rows");
+    QVERIFY2(document.Rows[0].Left.Type == Huggle::DiffDocument_Notice, "Row with intermediate revisions isn't a notice");
+    QVERIFY2(document.Rows[0].Left.GetText() == "(2 intermediate revisions by 2 users not shown)", "Text of notice was lost");
+    QVERIFY2(document.Rows[1].Left.Type == Huggle::DiffDocument_LineNumber, "Line number wasn't recognized");
+    QVERIFY2(document.Rows[1].Right.GetText() == "Line 1:", "Wrong text of line number");
+    QVERIFY2(document.Rows[2].Left.Type == Huggle::DiffDocument_Deleted, "Deleted line wasn't recognized");
+    QVERIFY2(document.Rows[2].Left.Segments.count() == 3, "Wrong number of segments of deleted line");
+    QVERIFY2(document.Rows[2].Left.Segments[1].Text == "bar", "Wrong text of deleted segment");
+    QVERIFY2(document.Rows[2].Left.Segments[1].Changed, "Deleted segment isn't marked as changed");
+    QVERIFY2(!document.Rows[2].Left.Segments[2].Changed, "Unchanged segment is marked as changed");
+    QVERIFY2(document.Rows[2].Right.Type == Huggle::DiffDocument_Added, "Added line wasn't recognized");
+    QVERIFY2(document.Rows[2].Right.GetText() == "Foo qux & quux baz", "Wrong text of added line");
+    QVERIFY2(document.Rows[3].Left.Type == Huggle::DiffDocument_Empty, "Empty side wasn't recognized");
+    QVERIFY2(document.Rows[3].Left.Segments.isEmpty(), "Empty side contains text");
+    QVERIFY2(document.Rows[3].Right.GetText() == "New line", "Wrong text of new line");
+    QVERIFY2(document.Rows[4].Left.Type == Huggle::DiffDocument_Context, "Context line wasn't recognized");
+    QVERIFY2(document.Rows[4].Right.GetText() == "Same", "Row that wasn't closed was lost");
+}
+
 QTEST_APPLESS_MAIN(HuggleTest)
 
 #include "tst_testmain.moc"
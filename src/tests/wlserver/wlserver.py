@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# Minimal stand-in for huggle whitelist server, useful to test whitelist
+# synchronization offline. Point whitelist-server in global config to
+# http://127.0.0.1:<port>/ and start huggle.
+#
+# Supported requests:
+#   GET  ?action=read&wp=<wiki>[&since=<unix time>]
+#   POST ?action=save&user=<user>&wp=<wiki>   with wl=<user1|user2||EOW||>
+#   GET  susp.php?action=insert&...
+
+import argparse
+import json
+import os
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, HTTPServer
+from urllib.parse import urlparse, parse_qs
+
+lock = threading.Lock()
+# wiki -> {username: time when it was added}
+lists = {}
+storage = None
+
+
+def load(path):
+    global lists
+    if path and os.path.exists(path):
+        with open(path) as f:
+            lists = json.load(f)
+
+
+def save():
+    if storage:
+        with open(storage, "w") as f:
+            json.dump(lists, f)
+
+
+class Handler(BaseHTTPRequestHandler):
+    def reply(self, text, code=200):
+        data = text.encode("utf-8")
+        self.send_response(code)
+        self.send_header("Content-Type", "text/plain; charset=utf-8")
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+    def do_GET(self):
+        url = urlparse(self.path)
+        args = parse_qs(url.query)
+        if url.path.endswith("susp.php"):
+            self.reply("ok")
+            return
+        if args.get("action", [""])[0] != "read":
+            self.reply("invalid action", 400)
+            return
+        wiki = args.get("wp", [""])[0]
+        since = int(args.get("since", ["0"])[0] or 0)
+        with lock:
+            users = [u for u, t in lists.get(wiki, {}).items() if t >= since]
+        self.reply("<!-- list -->" + "|".join(sorted(users)))
+
+    def do_POST(self):
+        url = urlparse(self.path)
+        args = parse_qs(url.query)
+        if args.get("action", [""])[0] != "save":
+            self.reply("invalid action", 400)
+            return
+        wiki = args.get("wp", [""])[0]
+        length = int(self.headers.get("Content-Length", 0))
+        form = parse_qs(self.rfile.read(length).decode("utf-8"))
+        wl = form.get("wl", [""])[0]
+        if not wl.endswith("||EOW||"):
+            self.reply("incomplete data", 400)
+            return
+        now = int(time.time())
+        users = [u for u in wl[:-len("||EOW||")].split("|") if u]
+        with lock:
+            target = lists.setdefault(wiki, {})
+            for user in users:
+                target.setdefault(user, now)
+            save()
+        self.reply("written %d users" % len(users))
+
+
+def main():
+    global storage
+    parser = argparse.ArgumentParser(description="Stand-in huggle whitelist server")
+    parser.add_argument("--port", type=int, default=8089)
+    parser.add_argument("--storage", help="json file to keep the lists in between runs")
+    args = parser.parse_args()
+    storage = args.storage
+    load(storage)
+    HTTPServer(("127.0.0.1", args.port), Handler).serve_forever()
+
+
+if __name__ == "__main__":
+    main()